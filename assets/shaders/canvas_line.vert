@@ -0,0 +1,10 @@
+#version 330 core
+// Brush stroke lines, in canvas pixel coordinates (top-left origin)
+layout (location = 0) in vec2 aPos;
+uniform vec2 uResolution;
+void main() {
+    vec2 zeroOne = aPos / uResolution;
+    vec2 zeroTwo = zeroOne * 2.0;
+    vec2 clipSpace = zeroTwo - 1.0;
+    gl_Position = vec4(clipSpace.x, -clipSpace.y, 0.0, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+// Area-filter downsample: each output pixel averages its whole source footprint
+uniform sampler2D uCanvas;
+uniform vec2 uRatio; // Source texels per destination pixel
+out vec4 FragColor;
+void main() {
+    ivec2 srcSize = textureSize(uCanvas, 0);
+    vec2 dst = gl_FragCoord.xy - 0.5;
+    ivec2 lo = clamp(ivec2(floor(dst * uRatio)), ivec2(0), srcSize - 1);
+    ivec2 hi = clamp(ivec2(ceil((dst + 1.0) * uRatio)), lo + 1, srcSize);
+
+    // Bound the cost for extreme ratios by striding (at most 32x32 taps)
+    ivec2 stride = max(ivec2(1), (hi - lo) / 32);
+    vec3 sum = vec3(0.0);
+    float count = 0.0;
+    for (int y = lo.y; y < hi.y; y += stride.y) {
+        for (int x = lo.x; x < hi.x; x += stride.x) {
+            sum += texelFetch(uCanvas, ivec2(x, y), 0).rgb;
+            count += 1.0;
+        }
+    }
+    FragColor = vec4(sum / count, 1.0);
+}
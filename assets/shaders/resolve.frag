@@ -0,0 +1,12 @@
+#version 330 core
+uniform sampler2D uAccum;  // RGB = summed color, A = particle count
+out vec4 FragColor;
+void main() {
+    vec4 acc = texelFetch(uAccum, ivec2(gl_FragCoord.xy), 0);
+    
+    // Empty pixels keep the cleared background
+    if (acc.a < 0.5) discard;
+    
+    // Average of all particles that landed in this pixel
+    FragColor = vec4(acc.rgb / acc.a, 1.0);
+}
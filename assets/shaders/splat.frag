@@ -0,0 +1,7 @@
+#version 330 core
+in vec4 vColor;
+out vec4 FragColor;
+void main() {
+    // Additive accumulation: RGB sums the particle colors, A counts particles
+    FragColor = vec4(vColor.rgb, 1.0);
+}
@@ -0,0 +1,27 @@
+# Writes every shader in SHADER_DIR into OUTPUT as a constexpr string, so the app
+# needs no shader files at runtime. Run as a script:
+#   cmake -DSHADER_DIR=<dir> -DOUTPUT=<header> -P EmbedShaders.cmake
+# particle.vert becomes Shaders::kParticleVert, canvas_line.frag Shaders::kCanvasLineFrag.
+
+file(GLOB shaders "${SHADER_DIR}/*.vert" "${SHADER_DIR}/*.frag")
+list(SORT shaders)
+
+set(content "// Generated by cmake/EmbedShaders.cmake from assets/shaders. Do not edit.\n#pragma once\n\nnamespace Shaders {\n")
+
+foreach(shader IN LISTS shaders)
+    get_filename_component(fileName "${shader}" NAME)
+    string(REGEX REPLACE "[._]" ";" words "${fileName}")
+    set(symbol "k")
+    foreach(word IN LISTS words)
+        string(SUBSTRING "${word}" 0 1 first)
+        string(SUBSTRING "${word}" 1 -1 rest)
+        string(TOUPPER "${first}" first)
+        string(APPEND symbol "${first}${rest}")
+    endforeach()
+
+    file(READ "${shader}" source)
+    string(APPEND content "\n// ${fileName}\ninline constexpr char ${symbol}[] = R\"lumasort_glsl(${source})lumasort_glsl\";\n")
+endforeach()
+
+string(APPEND content "\n} // namespace Shaders\n")
+file(WRITE "${OUTPUT}" "${content}")
@@ -1,9 +1,14 @@
 #include "app.h"
+#include <chrono>
 #include <iostream>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
-#include "core/flow_field.h"
+#include "core/allocation_counter.h"
+#include "core/cpu_profiler.h"
+#include "core/metrics.h"
+#include "core/physics.h"
+#include "graphics/program_cache.h"
 /**
  * @file app.cpp
  * @brief Main application implementation for LumaSort Engine.
@@ -18,6 +23,8 @@
 
 App::App(const std::string& title, int width, int height)
     : m_Title(title), m_Width(width), m_Height(height) {
+    m_StartupBegin = std::chrono::steady_clock::now();
+
     // Determine the environment and initialize core systems immediately.
     init();
 
@@ -27,11 +34,17 @@ App::App(const std::string& title, int width, int height)
     // Initialize Canvas (resize handled later ideally, but fixed for now)
     // For now, let's assume a fixed canvas size or window size.
     m_Canvas = std::make_unique<Canvas>(width, height);
+    m_History = std::make_unique<StrokeHistory>(*m_Canvas);
 
-    // Try opening webcam
-    if (!m_Webcam.open(0)) {
-        std::cerr << "Warning: Could not open webcam." << std::endl;
-    }
+    // Every GL program exists now (renderer and canvas)
+    Graphics::ProgramCacheStats shaders = Graphics::ProgramCache::getStats();
+    m_Startup.shadersMs = shaders.compileMs + shaders.loadMs;
+    m_Startup.programsCompiled = shaders.compiled;
+    m_Startup.programsCached = shaders.loaded;
+    m_Startup.initMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_StartupBegin).count();
+
+    // The webcam is opened by update() once WEBCAM mode is active, in the background,
+    // so the first frame never waits on device probing
 }
 
 App::~App() {
@@ -107,6 +120,7 @@ void App::init() {
     // Make the window's context current on this thread
     glfwMakeContextCurrent(m_Window);
     glfwSwapInterval(1); // Enable vsync to prevent tearing
+    CpuProfiler::setThreadName("Main");
 
     // 6. Initialize GLAD
     // Important: Must be done after making the context current.
@@ -115,10 +129,13 @@ void App::init() {
         std::cerr << "Failed to initialize GLAD" << std::endl;
         exit(1);
     }
+    m_Startup.windowMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_StartupBegin).count();
 
     // 7. Initialize Sub-systems
     // Renderer needs OpenGL context, so it comes after GLAD.
     m_Renderer = std::make_unique<Graphics::Renderer>();
+    m_Profiler = std::make_unique<Graphics::GpuProfiler>();
+    m_Exporter = std::make_unique<Graphics::FrameExporter>();
 
     // 8. Setup Dear ImGui
     IMGUI_CHECKVERSION();
@@ -142,24 +159,154 @@ void App::init() {
     m_Sorter = std::make_unique<Sorter>();
 }
 
+bool App::startMetrics(const MetricsSettings& settings) {
+    return m_MetricsExporter.start(settings);
+}
+
 void App::run() {
+    // Runtime metrics; each update is a relaxed atomic add or store
+    LatencyHistogram& frameTime = Metrics::histogram("lumasort_frame_time_seconds", "Time between frame starts", 1e-6);
+    LatencyHistogram& frameWork = Metrics::histogram("lumasort_frame_work_seconds",
+                                                     "CPU time of update and render, excluding the buffer swap", 1e-6);
+    Counter& frames = Metrics::counter("lumasort_frames_total", "Frames presented");
+    Gauge& particles = Metrics::gauge("lumasort_particles", "Particles in the simulation");
+    Gauge& resolutionScale = Metrics::gauge("lumasort_resolution_scale", "Dynamic resolution scale of the grid");
+    Counter& frameAllocations = Metrics::counter("lumasort_frame_allocations_total",
+                                                 "Heap allocations made by the main thread during update and render");
+    Counter& allocatingFrames = Metrics::counter("lumasort_allocating_frames_total", "Frames that made any heap allocation");
+    std::chrono::steady_clock::time_point lastFrameStart;
+
     // Main Application Loop
     while (!glfwWindowShouldClose(m_Window)) {
+        // Frame boundary for the CPU profiler's per-frame breakdown
+        CpuProfiler::markFrame();
+        auto frameStart = std::chrono::steady_clock::now();
+        AllocationCounts allocationsAtStart = AllocationCounter::thisThread();
+        if (frames.value() > 0) {
+            frameTime.record(std::chrono::duration<double>(frameStart - lastFrameStart).count());
+        }
+        lastFrameStart = frameStart;
+
         // Poll for inputs (keyboard, mouse, window events)
-        glfwPollEvents();
+        {
+            PROFILE_SCOPE("Poll Events");
+            glfwPollEvents();
+        }
+
+        // Harvest GPU timings from earlier frames (never blocks)
+        m_Profiler->beginFrame();
+        auto workStart = std::chrono::steady_clock::now();
 
         // Calculate delta time if needed
         // For now, just update state
-        update();
+        // While exporting, the simulation advances once per exported frame instead
+        m_Profiler->begin(Graphics::GpuProfiler::Stage::Update);
+        if (isExporting()) {
+            PROFILE_SCOPE("Export Frames");
+            exportFrames();
+        } else {
+            PROFILE_SCOPE("Update");
+            update();
+        }
+        m_Profiler->end(Graphics::GpuProfiler::Stage::Update);
 
         // Perform rendering (Game Logic -> Render Commands)
-        render();
+        {
+            PROFILE_SCOPE("Render");
+            render();
+        }
+
+        // Buffers are reused across frames, so anything counted here (swap excluded) is a new allocation
+        AllocationCounts allocations = AllocationCounter::thisThread() - allocationsAtStart;
+        m_AllocationStats.lastFrame = allocations.count;
+        m_AllocationStats.lastFrameBytes = allocations.bytes;
+        m_AllocationStats.peak = std::max(m_AllocationStats.peak, allocations.count);
+        ++m_AllocationStats.frames;
+        if (allocations.count > 0) {
+            ++m_AllocationStats.framesAllocating;
+            allocatingFrames.add();
+            frameAllocations.add(allocations.count);
+        }
+
+        // Let dynamic resolution see this frame's cost before vsync hides it
+        std::chrono::duration<float, std::milli> workElapsed = std::chrono::steady_clock::now() - workStart;
+        updateResolutionScale(workElapsed.count());
+        frameWork.record(workElapsed.count() / 1000.0);
+        frames.add();
+        particles.set((double)m_Particles.size());
+        resolutionScale.set(m_ResolutionScale);
 
         // Swap front and back buffers to display the new frame
+        PROFILE_SCOPE("Swap");
         glfwSwapBuffers(m_Window);
+        if (!m_Startup.reported) reportStartup();
+    }
+}
+
+void App::reportStartup() {
+    m_Startup.firstFrameMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_StartupBegin).count();
+    m_Startup.reported = true;
+
+    Metrics::gauge("lumasort_startup_seconds", "Time from launch to the first presented frame")
+        .set(m_Startup.firstFrameMs / 1000.0);
+    Metrics::gauge("lumasort_startup_shader_seconds", "Time spent building GL programs at launch")
+        .set(m_Startup.shadersMs / 1000.0);
+
+    std::cout << "Startup (" << (m_Startup.isWarm() ? "warm" : "cold") << "): first frame after "
+              << m_Startup.firstFrameMs << " ms (window " << m_Startup.windowMs
+              << " ms, shaders " << m_Startup.shadersMs << " ms: " << m_Startup.programsCached << " cached, "
+              << m_Startup.programsCompiled << " compiled)" << std::endl;
+}
+
+void App::updateResolutionScale(float cpuMs) {
+    // Exports step the simulation in bursts and playlists sort ahead at a fixed grid
+    if (isExporting() || m_PlaylistActive) return;
+    
+    // GPU samples lag a few frames behind, which the controller's averaging absorbs
+    float gpuMs = 0.0f;
+    for (Graphics::GpuProfiler::Stage stage : { Graphics::GpuProfiler::Stage::Canvas,
+                                                Graphics::GpuProfiler::Stage::Particles,
+                                                Graphics::GpuProfiler::Stage::ImGui }) {
+        gpuMs += m_Profiler->getLatestGpuMs(stage);
+    }
+    m_FrameCostMs = std::max(cpuMs, gpuMs);
+    
+    if (m_ResolutionController.addFrame(m_FrameCostMs)) {
+        applyResolutionScale();
     }
 }
 
+void App::applyResolutionScale() {
+    float scale = m_ResolutionController.getScale();
+    if (scale == m_ResolutionScale) return;
+    m_ResolutionScale = scale;
+    
+    // The input mode re-sizes its grid with the scaled cap on the next update();
+    // particles are reallocated (and re-targeted mid-transform) there
+    m_SimulationSizePending = true;
+    std::cout << "Resolution scale: " << scale << "x (frame cost " << m_ResolutionController.getAverageMs()
+              << " ms, budget " << m_ResolutionController.getSettings().budgetMs << " ms)" << std::endl;
+}
+
+int App::scaledSimulationCap(int cap) const {
+    return std::max(16, (int)(cap * m_ResolutionScale + 0.5f));
+}
+
+void App::fitStreamGrid(int frameWidth, int frameHeight) {
+    float aspectRatio = (float)frameWidth / (float)std::max(1, frameHeight);
+    
+    // Below this scale both sides sit on kStreamSimulationMin, so the grid would stop
+    // shrinking while the controller kept stepping down. Stop the controller there instead.
+    m_ResolutionController.setScaleFloor(kStreamSimulationMin * std::min(1.0f, aspectRatio) / kStreamSimulationCap);
+    m_ResolutionScale = m_ResolutionController.getScale();
+    
+    int maxRes = scaledSimulationCap(kStreamSimulationCap);
+    m_SimulationWidth = std::min(frameWidth, maxRes);
+    m_SimulationHeight = (int)(m_SimulationWidth / aspectRatio);
+    m_SimulationWidth = std::max(m_SimulationWidth, kStreamSimulationMin);
+    m_SimulationHeight = std::max(m_SimulationHeight, kStreamSimulationMin);
+}
+
 void App::render() {
     /**
      * @brief Update viewport to match current framebuffer size.
@@ -177,125 +324,303 @@ void App::render() {
 
     // 2. Render Particles with viewport-aware point sizing
     // Pass current window size and simulation dimensions to calculate proper point size
-    m_Renderer->renderParticles(m_Particles, m_Width, m_Height, m_SimulationWidth, m_SimulationHeight);
+    // While exporting, show the last exported frame rather than rendering twice
+    m_Profiler->begin(Graphics::GpuProfiler::Stage::Particles);
+    if (m_CompareRequested && !isExporting()) {
+        compareRasterizers();
+        m_Renderer->clear();
+    }
+    if (isExporting()) {
+        m_Exporter->blitToScreen(m_Width, m_Height);
+    } else if (m_UseSoftwareRasterizer) {
+        renderSoftware();
+    } else {
+        PROFILE_SCOPE("Particles");
+        m_Renderer->renderParticles(m_Particles, m_Width, m_Height, m_SimulationWidth, m_SimulationHeight);
+    }
+    m_Profiler->end(Graphics::GpuProfiler::Stage::Particles);
 
     // 3. Render UI Layer
     // We wrap this significantly to abstract ImGui frame management.
+    m_Profiler->begin(Graphics::GpuProfiler::Stage::ImGui);
+    PROFILE_SCOPE("ImGui");
     m_GuiLayer->begin();
     m_GuiLayer->render(this);
     m_GuiLayer->end();
+    m_Profiler->end(Graphics::GpuProfiler::Stage::ImGui);
+}
+
+void App::renderSoftware() {
+    if (m_Particles.empty()) return;
+    if (!m_SoftwareRasterizer) {
+        m_SoftwareRasterizer = std::make_unique<Graphics::SoftwareRasterizer>();
+        m_SoftwareFrame = std::make_unique<Texture2D>();
+    }
+
+    m_SoftwareRasterizer->renderParticles(m_Particles, m_Width, m_Height, m_SimulationWidth, m_SimulationHeight);
+    {
+        PROFILE_SCOPE("Upload");
+        m_SoftwareFrame->uploadFromOpenCV(m_SoftwareRasterizer->getFramebuffer());
+    }
+    m_Renderer->blitTexture(m_SoftwareFrame->getID(), m_Width, m_Height);
+}
+
+void App::compareRasterizers() {
+    m_CompareRequested = false;
+    if (m_Particles.empty()) return;
+    if (!m_SoftwareRasterizer) {
+        m_SoftwareRasterizer = std::make_unique<Graphics::SoftwareRasterizer>();
+        m_SoftwareFrame = std::make_unique<Texture2D>();
+    }
+
+    // GL path into the back buffer, read back top row first
+    m_Renderer->clear();
+    m_Renderer->renderParticles(m_Particles, m_Width, m_Height, m_SimulationWidth, m_SimulationHeight);
+    cv::Mat glFrame(m_Height, m_Width, CV_8UC4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, m_Width, m_Height, GL_BGRA, GL_UNSIGNED_BYTE, glFrame.data);
+    cv::flip(glFrame, glFrame, 0);
+
+    m_SoftwareRasterizer->renderParticles(m_Particles, m_Width, m_Height, m_SimulationWidth, m_SimulationHeight);
+
+    const cv::Mat& cpuFrame = m_SoftwareRasterizer->getFramebuffer();
+    uint64_t errorSum = 0;
+    int mismatched = 0;
+    for (int y = 0; y < m_Height; ++y) {
+        const uchar* glRow = glFrame.ptr<uchar>(y);
+        const uchar* cpuRow = cpuFrame.ptr<uchar>(y);
+        for (int x = 0; x < m_Width * 4; x += 4) {
+            int worst = 0;
+            for (int c = 0; c < 3; ++c) {
+                int error = std::abs(glRow[x + c] - cpuRow[x + c]);
+                errorSum += error;
+                worst = std::max(worst, error);
+            }
+            if (worst > kRasterTolerance) ++mismatched;
+        }
+    }
+
+    m_RasterComparison.valid = true;
+    m_RasterComparison.lodActive = m_Renderer->isLodActive();
+    m_RasterComparison.meanError = (float)errorSum / (3.0f * m_Width * m_Height);
+    m_RasterComparison.mismatchPercent = 100.0f * mismatched / (float)(m_Width * m_Height);
 }
 
 void App::update() {
+    // Reset per-frame work counters (cumulative totals are preserved)
+    uint64_t framesReused = m_UpdateStats.framesReused;
+    m_UpdateStats = UpdateStats();
+    m_UpdateStats.framesReused = framesReused;
+
+    // Swap in images finished by the background loader
+    LoadedImage loaded;
+    while (m_ImageLoader.poll(loaded)) {
+        PROFILE_SCOPE("Apply Image");
+        applyLoadedImage(loaded);
+    }
+
+    // Switch to the next prefetched playlist transition when it is due
+    updatePlaylist();
+
     // Handle Input Mode updates
     if (m_InputMode == InputMode::WEBCAM) {
+        // Open lazily; a released camera must finish shutting down before it can start again
+        if (m_Webcam.getState() == WebcamState::Stopped) {
+            startWebcam();
+        }
         if (m_Webcam.isOpened()) {
-            m_Webcam >> m_CurrentFrame;
+            // Take the newest frame from the capture thread, if one arrived since last update
+            PROFILE_SCOPE("Webcam Frame");
+            if (m_Webcam.latest(m_CurrentFrame)) {
+                // Every captured frame is new content
+                m_CurrentFrameGeneration = ++m_WebcamGeneration;
+                m_LastWebcamFrameAt = std::chrono::steady_clock::now();
+                m_WebcamStalled = false;
+            }
             
-            // Set resolution based on webcam frame (once)
-            if (!m_CurrentFrame.empty() && m_SimulationWidth == 256) {
-                int maxRes = 600; // Cap for webcam to maintain real-time performance
-                float aspectRatio = (float)m_CurrentFrame.cols / (float)m_CurrentFrame.rows;
-                m_SimulationWidth = std::min(m_CurrentFrame.cols, maxRes);
-                m_SimulationHeight = (int)(m_SimulationWidth / aspectRatio);
-                m_SimulationWidth = std::max(m_SimulationWidth, 256);
-                m_SimulationHeight = std::max(m_SimulationHeight, 256);
+            // A camera that stops delivering leaves the last frame on screen; count it as a stall.
+            // Warm-up before the first frame is reported as time to first frame instead.
+            static Gauge& frameAge = Metrics::gauge("lumasort_webcam_frame_age_seconds", "Time since the last new webcam frame");
+            static Counter& stalls = Metrics::counter("lumasort_webcam_stalls_total",
+                                                      "Times the webcam delivered no frame for over a second");
+            if (!m_CurrentFrame.empty()) {
+                double age = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_LastWebcamFrameAt).count();
+                frameAge.set(age);
+                if (!m_WebcamStalled && age > kWebcamStallSeconds) {
+                    m_WebcamStalled = true;
+                    stalls.add();
+                }
+            }
+            
+            // Set resolution based on webcam frame (once, and after every rescale)
+            if (!m_CurrentFrame.empty() && m_SimulationSizePending) {
+                fitStreamGrid(m_CurrentFrame.cols, m_CurrentFrame.rows);
+                m_SimulationSizePending = false;
                 std::cout << "Webcam resolution: " << m_CurrentFrame.cols << "x" << m_CurrentFrame.rows 
                           << " -> Simulation: " << m_SimulationWidth << "x" << m_SimulationHeight << std::endl;
             }
         }
     } 
     else if (m_InputMode == InputMode::CANVAS) {
+        m_Profiler->begin(Graphics::GpuProfiler::Stage::Canvas);
         processInput(); // Handle drawing interactions
+        m_Profiler->end(Graphics::GpuProfiler::Stage::Canvas);
+        
+        // Simulate at the canvas drawing resolution for full quality, unless capped.
+        // A capped grid is downsampled on the GPU so only simulation-sized pixels are read back.
+        if (m_SimulationSizePending) {
+            int canvasWidth = m_Canvas->getWidth();
+            int canvasHeight = m_Canvas->getHeight();
+            m_SimulationWidth = canvasWidth;
+            m_SimulationHeight = canvasHeight;
+            
+            // Dynamic resolution scales the cap, but never above the drawing itself
+            int largest = std::max(canvasWidth, canvasHeight);
+            int maxRes = scaledSimulationCap(m_CanvasMaxSimRes > 0 ? m_CanvasMaxSimRes : largest);
+            if (largest > maxRes) {
+                float scale = (float)maxRes / (float)largest;
+                m_SimulationWidth = std::max(1, (int)(canvasWidth * scale));
+                m_SimulationHeight = std::max(1, (int)(canvasHeight * scale));
+            }
+            m_Canvas->setReadbackSize(m_SimulationWidth, m_SimulationHeight);
+            m_SimulationSizePending = false;
+            
+            std::cout << "Canvas resolution: " << canvasWidth << "x" << canvasHeight
+                      << " -> Simulation: " << m_SimulationWidth << "x" << m_SimulationHeight << std::endl;
+        }
         
-        // Set canvas resolution to window size for full quality
-        if (m_SimulationWidth == 256) {
-            m_SimulationWidth = m_Width;
-            m_SimulationHeight = m_Height;
-            std::cout << "Canvas resolution: " << m_SimulationWidth << "x" << m_SimulationHeight << std::endl;
+        // Read canvas texture back to CPU for sorting without stalling:
+        // apply last frame's finished readbacks, then queue this frame's dirty region
+        {
+            PROFILE_SCOPE("Canvas Readback");
+            m_Canvas->collectReadbacks();
+            m_Canvas->requestReadback();
+            m_History->update(); // Undo keyframes are read back and encoded asynchronously too
         }
         
-        // Read canvas texture back to CPU for sorting
-        m_CurrentFrame = m_Canvas->getAsMat();
+        // Share the shadow image (no copy) whenever it reflects new strokes.
+        // Generation 0 means a resized shadow still waiting for its full re-read.
+        uint64_t shadowGeneration = m_Canvas->getShadowGeneration();
+        if (shadowGeneration != 0 && shadowGeneration != m_CurrentFrameGeneration) {
+            m_CurrentFrame = m_Canvas->getShadow();
+            m_CurrentFrameGeneration = shadowGeneration;
+            m_UpdateStats.frameCopied = true;
+        }
+    }
+    else if (m_InputMode == InputMode::VIDEO) {
+        if (m_Video.isOpened()) {
+            // Set resolution based on the video frame size (once per file, and after every rescale)
+            if (m_SimulationSizePending) {
+                fitStreamGrid(m_Video.getWidth(), m_Video.getHeight());
+                m_SimulationSizePending = false;
+                std::cout << "Video resolution: " << m_Video.getWidth() << "x" << m_Video.getHeight()
+                          << " -> Simulation: " << m_SimulationWidth << "x" << m_SimulationHeight << std::endl;
+            }
+            
+            // The decoder resizes straight to the simulation grid (no-op if unchanged)
+            m_Video.setOutputSize(m_SimulationWidth, m_SimulationHeight);
+            PROFILE_SCOPE("Video Frame");
+            if (m_Video.poll(m_CurrentFrame, &m_CurrentLuma)) {
+                m_CurrentFrameGeneration = ++m_VideoGeneration;
+            }
+        }
     }
     else if (m_InputMode == InputMode::IMAGE) {
-        if (!m_StaticImage.empty()) {
+        // Adapt simulation resolution based on image size (per loaded image, and after every rescale)
+        // Cap at 800x800 by default to maintain good performance on most systems.
+        if (m_SimulationSizePending && !m_StaticImage.empty() && !m_PlaylistActive) {
+            fitImageGrid(m_StaticImage.cols, m_StaticImage.rows, scaledSimulationCap(kImageSimulationCap),
+                         m_SimulationWidth, m_SimulationHeight);
+            m_SimulationSizePending = false;
+            std::cout << "Image resolution: " << m_StaticImage.cols << "x" << m_StaticImage.rows
+                      << " -> Simulation: " << m_SimulationWidth << "x" << m_SimulationHeight
+                      << " (" << (m_SimulationWidth * m_SimulationHeight) << " particles)" << std::endl;
+        }
+        
+        // Copy only when a new source image has been loaded
+        if (!m_StaticImage.empty() && m_StaticImageGeneration != m_CurrentFrameGeneration) {
+            PROFILE_SCOPE("Image Copy");
             m_StaticImage.copyTo(m_CurrentFrame);
+            m_CurrentFrameGeneration = m_StaticImageGeneration;
+            m_UpdateStats.frameCopied = true;
         }
     }
 
     // --- Particle System Update ---
     
-    int numParticles = m_SimulationWidth * m_SimulationHeight;
-    if (m_Particles.size() != numParticles) {
-        m_Particles.clear();
-        m_Particles.reserve(numParticles);
-        
-        // Use separate divisors for X and Y to preserve aspect ratio
-        float maxDimX = (float)(m_SimulationWidth - 1);
-        float maxDimY = (float)(m_SimulationHeight - 1);
-        
-        for (int y = 0; y < m_SimulationHeight; ++y) {
-            for (int x = 0; x < m_SimulationWidth; ++x) {
-                Particle p;
-                p.pos = glm::vec2(x / maxDimX, y / maxDimY); 
-                p.vel = glm::vec2(0.0f);
-                p.acc = glm::vec2(0.0f);
-                p.target = p.pos;
-                p.color = glm::vec4(1.0f);
-                m_Particles.push_back(p);
-            }
+    // Rebuild when the grid changes shape, not just particle count
+    // (e.g. 256x512 and 512x256 have the same count but different layouts)
+    if (m_ParticleGridWidth != m_SimulationWidth || m_ParticleGridHeight != m_SimulationHeight ||
+        m_Particles.size() != (size_t)m_SimulationWidth * m_SimulationHeight) {
+        PROFILE_SCOPE("Particle Rebuild");
+        if (m_IsTransforming && !m_Particles.empty()) {
+            // Rescaled mid-transform: keep the cloud where it is and re-sort for the new grid,
+            // so particles carry on towards targets next to their old ones instead of popping
+            m_PreviousParticles.swap(m_Particles);
+            resampleParticleGrid(m_PreviousParticles, m_ParticleGridWidth, m_ParticleGridHeight,
+                                 m_Particles, m_SimulationWidth, m_SimulationHeight);
+            recalculateTargets();
+            m_ParticlesAtRest = false;
+        } else {
+            initParticleGrid(m_Particles, m_SimulationWidth, m_SimulationHeight);
+            m_ParticlesAtRest = true;
         }
+        
+        m_ParticleGridWidth = m_SimulationWidth;
+        m_ParticleGridHeight = m_SimulationHeight;
+        m_ParticleColorGeneration = 0; // New buffer has no colors yet
     }
 
     // Update particle colors from current frame (or frozen frame during transform)
+    // Skipped entirely when the source generation hasn't changed since the last writeback.
     cv::Mat& colorSource = m_IsTransforming ? m_FrozenFrame : m_CurrentFrame;
-    if (!colorSource.empty()) {
-        cv::Mat resizedFrame;
-        cv::resize(colorSource, resizedFrame, cv::Size(m_SimulationWidth, m_SimulationHeight));
+    uint64_t colorGeneration = m_IsTransforming ? m_FrozenFrameGeneration : m_CurrentFrameGeneration;
+    if (!colorSource.empty() && colorGeneration != m_ParticleColorGeneration) {
+        PROFILE_SCOPE("Color Update");
+        // Sources already at grid size (e.g. pre-resized video frames) are read directly
+        const cv::Mat* resampled = &colorSource;
+        if (colorSource.cols != m_SimulationWidth || colorSource.rows != m_SimulationHeight) {
+            PROFILE_SCOPE("Resize");
+            cv::resize(colorSource, m_ResampledFrame, cv::Size(m_SimulationWidth, m_SimulationHeight));
+            resampled = &m_ResampledFrame;
+            m_UpdateStats.frameResampled = true;
+        }
         
-        float maxDim = (float)(m_SimulationWidth - 1);
         for (int i = 0; i < m_Particles.size(); ++i) {
             int x = i % m_SimulationWidth;
             int y = i / m_SimulationWidth;
-            cv::Vec3b pixel = resizedFrame.at<cv::Vec3b>(y, x);
+            cv::Vec3b pixel = resampled->at<cv::Vec3b>(y, x);
             m_Particles[i].color = glm::vec4(pixel[2] / 255.0f, pixel[1] / 255.0f, pixel[0] / 255.0f, 1.0f);
         }
+        
+        m_ParticleColorGeneration = colorGeneration;
+        m_UpdateStats.colorsWritten = m_Particles.size();
+    } else if (!colorSource.empty()) {
+        // Same generation as last applied: the colors already match this source
+        m_UpdateStats.colorsSkipped = m_Particles.size();
+        ++m_UpdateStats.framesReused;
     }
 
     // Only apply physics when transforming
     if (m_IsTransforming) {
-        m_Time += 0.01f;
+        PROFILE_SCOPE("Physics");
+        m_Time += kPhysicsTimeStep;
+        m_ParticlesAtRest = false;
 
-        for (auto& p : m_Particles) {
-            glm::vec2 desired = p.target - p.pos;
-            float dist = glm::length(desired);
-            
-            glm::vec2 steer = glm::vec2(0.0f);
-            if (dist > 0.0001f) {
-                 steer = glm::normalize(desired) * m_ParticleSpeed;
-            }
-
-            glm::vec2 flow = FlowField::getForce(p.pos, m_Time, m_NoiseScale) * m_FlowStrength;
-
-            p.acc += steer + flow;
-            p.vel += p.acc;
-            p.pos += p.vel;
-            p.acc = glm::vec2(0.0f);
-            p.vel *= 0.90f;
-        }
+        PhysicsParams params;
+        params.particleSpeed = m_ParticleSpeed;
+        params.flowStrength = m_FlowStrength;
+        params.noiseScale = m_NoiseScale;
+        stepParticles(m_Particles.data(), m_Particles.size(), m_Time, params);
+    } else if (!m_ParticlesAtRest) {
+        // When not transforming, snap particles back to their source grid positions.
+        // This only needs to happen once after a transform stops.
+        PROFILE_SCOPE("Reset Positions");
+        resetParticlePositions(m_Particles, m_SimulationWidth, m_SimulationHeight);
+        m_ParticlesAtRest = true;
+        m_UpdateStats.positionsReset = m_Particles.size();
     } else {
-        // When not transforming, keep particles at their source grid positions
-        // Use separate divisors for X and Y to preserve aspect ratio
-        float maxDimX = (float)(m_SimulationWidth - 1);
-        float maxDimY = (float)(m_SimulationHeight - 1);
-        for (size_t i = 0; i < m_Particles.size(); ++i) {
-            int x = i % m_SimulationWidth;
-            int y = i / m_SimulationWidth;
-            m_Particles[i].pos = glm::vec2(x / maxDimX, y / maxDimY);
-            m_Particles[i].vel = glm::vec2(0.0f);
-            m_Particles[i].acc = glm::vec2(0.0f);
-        }
+        m_UpdateStats.positionsSkipped = m_Particles.size();
     }
 }
 
@@ -307,7 +632,17 @@ void App::processInput() {
         bool mouseDown = glfwGetMouseButton(m_Window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
         
         if (mouseDown && !ImGui::GetIO().WantCaptureMouse) {
-            glm::vec2 currentPos = glm::vec2(xpos, ypos);
+            // The canvas is displayed letterboxed like the particles, so map the
+            // cursor (window coords) into canvas pixels and scale the brush to match
+            int windowWidth, windowHeight;
+            glfwGetWindowSize(m_Window, &windowWidth, &windowHeight);
+            float canvasW = (float)m_Canvas->getWidth();
+            float canvasH = (float)m_Canvas->getHeight();
+            float scale = std::min(windowWidth / canvasW, windowHeight / canvasH);
+            glm::vec2 offset((windowWidth - canvasW * scale) * 0.5f, (windowHeight - canvasH * scale) * 0.5f);
+            
+            glm::vec2 currentPos = (glm::vec2(xpos, ypos) - offset) / scale;
+            float brushSize = m_BrushSize / scale;
             
             if (!m_IsDrawing) {
                 // Just started drawing - draw a point at current position
@@ -315,28 +650,50 @@ void App::processInput() {
                 m_LastMousePos = currentPos;
                 
                 // Draw initial point
-                if (m_DrawTool == DrawTool::PEN) {
-                    m_Canvas->drawLine(currentPos, currentPos, m_DrawColor, m_BrushSize);
+                if (m_DrawTool == DrawTool::FILL) {
+                    // Fill once per click; dragging does nothing further
+                    if (m_Canvas->floodFill(currentPos, m_DrawColor, m_FillTolerance)) {
+                        m_History->recordFill(currentPos, m_DrawColor, m_FillTolerance);
+                    }
+                } else if (m_DrawTool == DrawTool::PEN) {
+                    m_Canvas->drawLine(currentPos, currentPos, m_DrawColor, brushSize);
+                    m_History->beginStroke(m_DrawColor, brushSize);
+                    m_History->extendStroke(currentPos);
                 } else if (m_DrawTool == DrawTool::ERASER) {
-                    m_Canvas->drawLine(currentPos, currentPos, glm::vec3(1.0f), m_BrushSize * 2.0f);
+                    m_Canvas->drawLine(currentPos, currentPos, glm::vec3(1.0f), brushSize * 2.0f);
+                    m_History->beginStroke(glm::vec3(1.0f), brushSize * 2.0f);
+                    m_History->extendStroke(currentPos);
                 }
             } else {
                 // Continue drawing
                 if (m_DrawTool == DrawTool::PEN) {
-                    m_Canvas->drawLine(m_LastMousePos, currentPos, m_DrawColor, m_BrushSize);
+                    m_Canvas->drawLine(m_LastMousePos, currentPos, m_DrawColor, brushSize);
                 } else if (m_DrawTool == DrawTool::ERASER) {
-                    m_Canvas->drawLine(m_LastMousePos, currentPos, glm::vec3(1.0f), m_BrushSize * 2.0f);
+                    m_Canvas->drawLine(m_LastMousePos, currentPos, glm::vec3(1.0f), brushSize * 2.0f);
                 }
+                m_History->extendStroke(currentPos);
                 
                 m_LastMousePos = currentPos;
             }
         } else {
             m_IsDrawing = false;
+            m_History->endStroke(); // Commit the finished stroke to the undo log
         }
     }
 }
 
 void App::shutdown() {
+    m_MetricsExporter.stop();
+    m_Webcam.stop();
+    m_Video.close();
+    m_ImageLoader.stop();
+    m_Prefetcher.stop();
+
+    // Release GL objects while the context is still alive
+    m_Exporter.reset();
+    m_Profiler.reset();
+    m_SoftwareFrame.reset();
+
     // Cleanup ImGui
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -350,57 +707,117 @@ void App::shutdown() {
 }
 
 void App::loadSourceImage(const std::string& path) {
-    cv::Mat img = cv::imread(path);
-    if (!img.empty()) {
-        m_StaticImage = img;
-        
-        // Adapt simulation resolution based on image size
-        // Cap at 800x800 to maintain good performance on most systems
-        int maxRes = 800;
-        int newWidth = std::min(img.cols, maxRes);
-        int newHeight = std::min(img.rows, maxRes);
-        
-        // Maintain aspect ratio if one dimension exceeds max
-        float aspectRatio = (float)img.cols / (float)img.rows;
-        if (aspectRatio > 1.0f) {
-            newHeight = (int)(newWidth / aspectRatio);
-        } else {
-            newWidth = (int)(newHeight * aspectRatio);
-        }
-        
-        // Ensure minimum resolution
-        newWidth = std::max(newWidth, 128);
-        newHeight = std::max(newHeight, 128);
-        
-        m_SimulationWidth = newWidth;
-        m_SimulationHeight = newHeight;
-        
-        std::cout << "Loaded Source Image: " << path << std::endl;
-        std::cout << "  Resolution: " << img.cols << "x" << img.rows << std::endl;
-        std::cout << "  Simulation: " << m_SimulationWidth << "x" << m_SimulationHeight 
-                  << " (" << (m_SimulationWidth * m_SimulationHeight) << " particles)" << std::endl;
-    } else {
-        std::cerr << "Failed to load source image: " << path << std::endl;
-    }
+    // Decoded for the largest grid dynamic resolution may pick
+    m_ImageLoader.request(ImageSlot::SOURCE, path, (int)(kImageSimulationCap * kMaxResolutionScale));
 }
 
 void App::loadTargetImage(const std::string& path) {
-    cv::Mat img = cv::imread(path);
-    if (!img.empty()) {
+    m_TargetRequestedPath = path;
+    m_TargetRequestedCap = getTargetResolutionCap();
+    m_ImageLoader.request(ImageSlot::TARGET, path, m_TargetRequestedCap);
+}
+
+int App::getTargetResolutionCap() const {
+    // Canvas mode can simulate at full canvas resolution; every other mode stays under the image cap
+    // at the largest dynamic resolution scale
+    int cap = (int)(kImageSimulationCap * kMaxResolutionScale);
+    if (m_Canvas) {
+        cap = std::max(cap, std::max(m_Canvas->getWidth(), m_Canvas->getHeight()));
+    }
+    return cap;
+}
+
+void App::applyLoadedImage(LoadedImage& loaded) {
+    const ImageLoadStats& stats = loaded.stats;
+    cv::Mat& img = loaded.image;
+
+    if (loaded.slot == ImageSlot::TARGET) {
         m_TargetImage = img;
+        m_TargetPath = stats.path;
+        m_TargetDecodeCap = m_TargetRequestedCap;
+        m_TargetDownscaled = std::max(img.cols, img.rows) < std::max(stats.originalWidth, stats.originalHeight);
         // Upload to GPU for preview
         if (m_TargetPreview) {
             m_TargetPreview->uploadFromOpenCV(m_TargetImage);
         }
-        std::cout << "Loaded Target Image: " << path << std::endl;
-    } else {
-        std::cerr << "Failed to load target image: " << path << std::endl;
+        std::cout << "Loaded Target Image: " << stats.path << std::endl;
+        std::cout << "  Resolution: " << stats.originalWidth << "x" << stats.originalHeight
+                  << " (kept " << img.cols << "x" << img.rows << ", decoded at 1/" << stats.reduction
+                  << ", " << stats.totalMs << " ms)" << std::endl;
+        return;
     }
+
+    m_StaticImage = img;
+    ++m_StaticImageGeneration;
+
+    // update() sizes the simulation grid for the new image
+    m_SimulationSizePending = true;
+
+    std::cout << "Loaded Source Image: " << stats.path << std::endl;
+    std::cout << "  Resolution: " << stats.originalWidth << "x" << stats.originalHeight
+              << " (kept " << img.cols << "x" << img.rows << ", decoded at 1/" << stats.reduction
+              << ", " << stats.totalMs << " ms)" << std::endl;
+}
+
+void App::setCanvasResolution(int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    if (m_Canvas && m_Canvas->getWidth() == width && m_Canvas->getHeight() == height) return;
+    
+    // Recreating the FBO discards the current drawing (and its history)
+    size_t historyBudget = m_History ? m_History->getBudget() : 64 * 1024 * 1024;
+    m_History.reset();
+    m_Canvas = std::make_unique<Canvas>(width, height);
+    m_History = std::make_unique<StrokeHistory>(*m_Canvas, historyBudget);
+    m_IsDrawing = false;
+    
+    if (m_InputMode == InputMode::CANVAS) {
+        resetCanvasSimulation();
+    }
+    std::cout << "Canvas drawing resolution: " << width << "x" << height << std::endl;
+
+    // A larger canvas can sort into a bigger grid than the target was (or is being) decoded for
+    int targetCap = getTargetResolutionCap();
+    if (m_ImageLoader.isLoading(ImageSlot::TARGET)) {
+        if (targetCap > m_TargetRequestedCap) loadTargetImage(m_TargetRequestedPath);
+    } else if (!m_TargetPath.empty() && m_TargetDownscaled && targetCap > m_TargetDecodeCap) {
+        loadTargetImage(m_TargetPath);
+    }
+}
+
+void App::setCanvasSimulationCap(int maxRes) {
+    m_CanvasMaxSimRes = std::max(0, maxRes);
+    if (m_InputMode == InputMode::CANVAS) {
+        resetCanvasSimulation();
+    }
+}
+
+void App::resetCanvasSimulation() {
+    if (m_IsTransforming) {
+        stopTransform();
+    }
+    // Triggers the canvas sizing logic in update()
+    m_SimulationSizePending = true;
+    m_CurrentFrame.release();
+    m_CurrentFrameGeneration = 0;
 }
 
 void App::clearCanvas() {
     if (m_Canvas) {
+        m_History->endStroke();
         m_Canvas->clear();
+        m_History->recordClear();
+    }
+}
+
+void App::undoCanvas() {
+    if (m_History && !m_IsDrawing) {
+        m_History->undo();
+    }
+}
+
+void App::redoCanvas() {
+    if (m_History && !m_IsDrawing) {
+        m_History->redo();
     }
 }
 
@@ -410,21 +827,25 @@ void App::recalculateTargets() {
         return;
     }
     
-    // Use Sorter to get mapping
-    std::vector<glm::vec2> mapping = m_Sorter->sortImage(m_FrozenFrame, m_TargetImage, m_SimulationWidth, m_SimulationHeight);
+    // Use Sorter to get mapping. YUV-native sources are keyed on their luma plane
+    // directly instead of recomputing luminance from BGR.
+    auto sortStart = std::chrono::steady_clock::now();
+    m_LastSortUsedLuma = !m_FrozenLuma.empty();
+    bool sorted = m_LastSortUsedLuma
+        ? m_Sorter->sortLuma(m_FrozenLuma, m_TargetImage, m_SimulationWidth, m_SimulationHeight, m_Mapping)
+        : m_Sorter->sortImage(m_FrozenFrame, m_TargetImage, m_SimulationWidth, m_SimulationHeight, m_Mapping);
+    std::chrono::duration<float, std::milli> sortElapsed = std::chrono::steady_clock::now() - sortStart;
+    m_LastSortMs = sortElapsed.count();
+    static LatencyHistogram& sortTime = Metrics::histogram("lumasort_sort_seconds", "Duration of particle-to-target sorts", 1e-6);
+    sortTime.record(m_LastSortMs / 1000.0);
     
-    if (mapping.empty()) {
+    if (!sorted) {
         return;
     }
     
     // Update particle targets based on mapping
-    // mapping[i] gives the target position for particle i (in pixel coordinates)
-    float normX = (float)(m_SimulationWidth - 1);
-    float normY = (float)(m_SimulationHeight - 1);
-    for (size_t i = 0; i < m_Particles.size() && i < mapping.size(); ++i) {
-        // Normalize to 0..1 range using proper dimension for each axis
-        m_Particles[i].target = glm::vec2(mapping[i].x / normX, mapping[i].y / normY);
-    }
+    // m_Mapping[i] gives the target position for particle i (in pixel coordinates)
+    applyTargetMapping(m_Particles, m_Mapping, m_SimulationWidth, m_SimulationHeight);
 }
 
 void App::startTransform() {
@@ -439,6 +860,12 @@ void App::startTransform() {
     
     // Freeze the current frame for transformation
     m_CurrentFrame.copyTo(m_FrozenFrame);
+    m_FrozenFrameGeneration = m_CurrentFrameGeneration;
+    if (m_InputMode == InputMode::VIDEO && m_CurrentLuma.size() == m_CurrentFrame.size()) {
+        m_CurrentLuma.copyTo(m_FrozenLuma);
+    } else {
+        m_FrozenLuma.release();
+    }
     
     // Calculate targets once based on frozen frame
     recalculateTargets();
@@ -453,10 +880,222 @@ void App::stopTransform() {
     std::cout << "Transform stopped" << std::endl;
 }
 
+void App::startPlaylist() {
+    if (m_Playlist.empty()) {
+        std::cerr << "Cannot start playlist: No entries!" << std::endl;
+        return;
+    }
+    if (m_Playlist[0].source.empty() && m_CurrentFrame.empty()) {
+        std::cerr << "Cannot start playlist: First entry has no source and no frame is available!" << std::endl;
+        return;
+    }
+    if (m_PlaylistActive) {
+        stopPlaylist();
+    }
+    
+    // The first entry may chain from whatever is on screen now; take it before leaving the mode
+    m_Prefetcher.start(m_Playlist, m_CurrentFrame, m_SimulationWidth, m_SimulationHeight,
+                       scaledSimulationCap(kImageSimulationCap), m_PlaylistLoop);
+    setInputMode(InputMode::IMAGE);
+    if (m_IsTransforming) {
+        stopTransform();
+    }
+    
+    m_PlaylistActive = true;
+    m_PlaylistStarted = false;
+    m_PlaylistEntry = 0;
+    m_PlaylistStats = PlaylistStats();
+    std::cout << "Playlist started (" << m_Playlist.size() << " entries"
+              << (m_PlaylistLoop ? ", looping)" : ")") << std::endl;
+}
+
+void App::stopPlaylist() {
+    m_Prefetcher.stop();
+    m_PlaylistActive = false;
+    m_PlaylistStats.waiting = false;
+    if (m_IsTransforming) {
+        stopTransform();
+    }
+    std::cout << "Playlist stopped" << std::endl;
+}
+
+void App::updatePlaylist() {
+    if (!m_PlaylistActive) return;
+    
+    auto now = std::chrono::steady_clock::now();
+    if (m_PlaylistStarted && now < m_PlaylistDueAt) return;
+    
+    PreparedTransition transition;
+    if (!m_Prefetcher.take(transition)) {
+        if (m_Prefetcher.isFinished()) {
+            // End of a non-looping playlist (or a load error): keep the last transform on screen
+            std::string error = m_Prefetcher.getError();
+            m_Prefetcher.stop();
+            m_PlaylistActive = false;
+            m_PlaylistStats.waiting = false;
+            std::cout << "Playlist finished" << (error.empty() ? "" : ": " + error) << std::endl;
+        } else {
+            m_PlaylistStats.waiting = m_PlaylistStarted;
+        }
+        return;
+    }
+    
+    // The first transition can't have been prefetched, so only later ones are scored
+    if (m_PlaylistStarted) {
+        std::chrono::duration<float, std::milli> lead = m_PlaylistDueAt - transition.readyAt;
+        m_PlaylistStats.lastLeadMs = lead.count();
+        if (m_PlaylistStats.lastLeadMs >= 0.0f) {
+            ++m_PlaylistStats.onTime;
+        } else {
+            ++m_PlaylistStats.late;
+        }
+    }
+    
+    applyTransition(transition);
+    m_PlaylistStarted = true;
+    m_PlaylistStats.waiting = false;
+    
+    float dwell = m_PlaylistEntry < m_Playlist.size() ? m_Playlist[m_PlaylistEntry].dwellSeconds : 10.0f;
+    m_PlaylistDueAt = std::chrono::steady_clock::now() +
+                      std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(dwell));
+}
+
+void App::applyTransition(PreparedTransition& transition) {
+    PROFILE_SCOPE("Apply Transition");
+    auto applyStart = std::chrono::steady_clock::now();
+    
+    // Every transition starts from the grid, carrying the colors of the previous settled state
+    m_SimulationWidth = transition.gridWidth;
+    m_SimulationHeight = transition.gridHeight;
+    if (m_ParticleGridWidth != m_SimulationWidth || m_ParticleGridHeight != m_SimulationHeight ||
+        m_Particles.size() != (size_t)m_SimulationWidth * m_SimulationHeight) {
+        initParticleGrid(m_Particles, m_SimulationWidth, m_SimulationHeight);
+        m_ParticleGridWidth = m_SimulationWidth;
+        m_ParticleGridHeight = m_SimulationHeight;
+    } else {
+        resetParticlePositions(m_Particles, m_SimulationWidth, m_SimulationHeight);
+    }
+    
+    m_FrozenFrame = transition.source;
+    m_FrozenLuma.release();
+    m_FrozenFrameGeneration = ++m_PlaylistGeneration;
+    
+    for (size_t i = 0; i < m_Particles.size(); ++i) {
+        int x = (int)(i % m_SimulationWidth);
+        int y = (int)(i / m_SimulationWidth);
+        cv::Vec3b pixel = m_FrozenFrame.at<cv::Vec3b>(y, x);
+        m_Particles[i].color = glm::vec4(pixel[2] / 255.0f, pixel[1] / 255.0f, pixel[0] / 255.0f, 1.0f);
+    }
+    applyTargetMapping(m_Particles, transition.mapping, m_SimulationWidth, m_SimulationHeight);
+    m_ParticleColorGeneration = m_FrozenFrameGeneration;
+    
+    m_TargetImage = transition.target;
+    m_TargetPath.clear(); // Sized for the playlist grid; not reloaded on canvas changes
+    if (m_TargetPreview) {
+        m_TargetPreview->uploadFromOpenCV(m_TargetImage);
+    }
+    
+    m_Time = 0.0f;
+    m_IsTransforming = true;
+    m_ParticlesAtRest = false;
+    m_PlaylistEntry = transition.entry;
+    
+    std::chrono::duration<float, std::milli> applyElapsed = std::chrono::steady_clock::now() - applyStart;
+    ++m_PlaylistStats.transitions;
+    m_PlaylistStats.lastDecodeMs = transition.decodeMs;
+    m_PlaylistStats.lastSortMs = transition.sortMs;
+    m_PlaylistStats.lastApplyMs = applyElapsed.count();
+    m_LastSortMs = 0.0f; // Nothing was sorted on this frame
+    m_LastSortUsedLuma = false;
+    
+    std::cout << "Playlist entry " << (transition.entry + 1) << "/" << m_Playlist.size() << ": "
+              << transition.gridWidth << "x" << transition.gridHeight << ", prepared in "
+              << transition.totalMs << " ms (sort " << transition.sortMs << " ms), applied in "
+              << m_PlaylistStats.lastApplyMs << " ms" << std::endl;
+}
+
+void App::startExport(const std::string& path) {
+    if (isExporting()) return;
+    if (m_PlaylistActive) {
+        stopPlaylist();
+    }
+    
+    // Export always covers the transform from its start
+    if (m_IsTransforming) {
+        stopTransform();
+        update(); // Snap particles back to their source positions
+    }
+    startTransform();
+    if (!m_IsTransforming) return; // Missing source or target (already reported)
+    
+    Graphics::ExportSettings settings = m_ExportSettings;
+    settings.path = path;
+    if (!m_Exporter->start(settings)) {
+        std::cerr << "Failed to start export: " << path << std::endl;
+    }
+}
+
+void App::cancelExport() {
+    m_Exporter->cancel();
+}
+
+void App::exportFrames() {
+    const auto budget = std::chrono::milliseconds(30);
+    auto start = std::chrono::steady_clock::now();
+    
+    // Each iteration: simulate one step, render it offscreen and queue its readback.
+    // Stops when the PBO ring or encoder queue is full, never waiting on either.
+    const Graphics::ExportSettings& settings = m_Exporter->getSettings();
+    m_Exporter->poll();
+    while (m_Exporter->canRenderFrame() && std::chrono::steady_clock::now() - start < budget) {
+        update();
+        
+        m_Exporter->beginFrame();
+        m_Renderer->clear();
+        m_Renderer->renderParticles(m_Particles, settings.width, settings.height,
+                                    m_SimulationWidth, m_SimulationHeight);
+        m_Exporter->endFrame();
+        
+        m_Exporter->poll();
+    }
+    glViewport(0, 0, m_Width, m_Height);
+}
+
+void App::loadVideo(const std::string& path) {
+    if (!m_Video.open(path)) {
+        std::cerr << "Failed to open video: " << path << std::endl;
+        return;
+    }
+    std::cout << "Opened video: " << path << " (" << m_Video.getWidth() << "x" << m_Video.getHeight()
+              << ", " << m_Video.getFrameCount() << " frames @ " << m_Video.getFps() << " fps)" << std::endl;
+    
+    if (m_InputMode == InputMode::VIDEO) {
+        if (m_IsTransforming) {
+            stopTransform();
+        }
+        // Triggers the video sizing logic in update()
+        m_SimulationSizePending = true;
+        m_CurrentFrame.release();
+        m_CurrentLuma.release();
+        m_CurrentFrameGeneration = 0;
+    }
+}
+
+void App::startWebcam() {
+    m_Webcam.start(kWebcamDevice);
+    m_LastWebcamFrameAt = std::chrono::steady_clock::now();
+    m_WebcamStalled = false;
+}
+
 void App::setInputMode(InputMode mode) {
     // Don't do anything if mode hasn't changed
     if (mode == m_InputMode) return;
     
+    // A playlist drives the simulation in image mode only
+    if (m_PlaylistActive) {
+        stopPlaylist();
+    }
+    
     // Stop any active transformation first
     if (m_IsTransforming) {
         stopTransform();
@@ -467,11 +1106,27 @@ void App::setInputMode(InputMode mode) {
     m_Particles.clear();
     
     // Reset simulation dimensions - will be recalculated based on new input
-    m_SimulationWidth = 256;  // Default value, will be updated by new input
+    m_SimulationWidth = 256;  // Placeholder until the new input is sized
     m_SimulationHeight = 256;
+    m_SimulationSizePending = true;
+    m_ResolutionController.reset();
+    m_ResolutionController.setScaleFloor(0.0f); // Webcam/video set their own when sized
     
     // Clear frozen frame (no longer relevant to new mode)
     m_FrozenFrame.release();
+    m_FrozenLuma.release();
+    m_FrozenFrameGeneration = 0;
+    
+    // Drop the previous mode's frame so the new source is always picked up,
+    // even if its generation happens to match the old one
+    m_CurrentFrame.release();
+    m_CurrentLuma.release();
+    m_CurrentFrameGeneration = 0;
+    
+    // Free the camera for other programs; a pending open finishes in the background
+    if (m_InputMode == InputMode::WEBCAM) {
+        m_Webcam.release();
+    }
     
     // Switch to new mode
     m_InputMode = mode;
@@ -2,15 +2,27 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 
 #include "graphics/renderer.h"
+#include "graphics/gpu_profiler.h"
+#include "graphics/frame_exporter.h"
+#include "graphics/software_rasterizer.h"
 #include "graphics/canvas.h"
+#include "graphics/stroke_history.h"
 #include "graphics/texture.h"
 #include "ui/gui_layer.h"
 #include "core/particle.h"
 #include "core/sorter.h"
+#include "core/resolution_controller.h"
+#include "io/webcam_capture.h"
+#include "io/video_source.h"
+#include "io/image_loader.h"
+#include "io/playlist.h"
+#include "io/metrics_exporter.h"
 #include <vector>
 
 #include <opencv2/opencv.hpp>
@@ -18,7 +30,73 @@
 enum class InputMode {
     WEBCAM,
     IMAGE,
-    CANVAS
+    CANVAS,
+    VIDEO
+};
+
+/**
+ * @struct UpdateStats
+ * @brief Per-frame counters describing how much source work update() performed or skipped.
+ * 
+ * Reset at the start of every update() and displayed in the GUI.
+ */
+struct UpdateStats {
+    bool frameCopied = false;          ///< Source pixels were copied into m_CurrentFrame
+    bool frameResampled = false;       ///< Color source was resized to the simulation grid
+    size_t colorsWritten = 0;          ///< Particle colors rewritten this frame
+    size_t colorsSkipped = 0;          ///< Particle colors left untouched (source unchanged)
+    size_t positionsReset = 0;         ///< Particle positions snapped back to the grid
+    size_t positionsSkipped = 0;       ///< Particle positions already at rest
+    uint64_t framesReused = 0;         ///< Total frames that reused the previous resample
+};
+
+/**
+ * @struct AllocationStats
+ * @brief Heap allocations made by the main thread per frame (see AllocationCounter).
+ * 
+ * Steady state should read zero: every per-frame buffer is a reused member.
+ * Allocations are expected only on events (grid resize, new image, transform start).
+ */
+struct AllocationStats {
+    uint64_t lastFrame = 0;            ///< Allocations during the last frame's update and render
+    uint64_t lastFrameBytes = 0;       ///< Bytes they requested
+    uint64_t peak = 0;                 ///< Most allocations in one frame since the last reset
+    uint64_t frames = 0;               ///< Frames measured since the last reset
+    uint64_t framesAllocating = 0;     ///< Frames that allocated at all since the last reset
+};
+
+/**
+ * @struct StartupStats
+ * @brief Where launch time went, from App construction to the first presented frame.
+ *
+ * A warm start loads every GL program from the binary cache (see Graphics::ProgramCache);
+ * a cold one compiles at least one from source.
+ */
+struct StartupStats {
+    float windowMs = 0.0f;      ///< GLFW, window, icon, GL context and function loading
+    float shadersMs = 0.0f;     ///< Building every GL program (compile or cache load)
+    float initMs = 0.0f;        ///< Whole constructor, including the two above
+    float firstFrameMs = 0.0f;  ///< Constructor start to the first buffer swap
+    int programsCompiled = 0;   ///< Compiled from source
+    int programsCached = 0;     ///< Loaded from the program binary cache
+    bool reported = false;      ///< Set once the first frame was presented
+
+    bool isWarm() const { return programsCompiled == 0 && programsCached > 0; }
+};
+
+/**
+ * @struct PlaylistStats
+ * @brief Whether playlist transitions were prefetched in time.
+ */
+struct PlaylistStats {
+    size_t transitions = 0;     ///< Transitions applied since the playlist started
+    size_t onTime = 0;          ///< Prepared before their dwell time was up
+    size_t late = 0;            ///< Playback waited for the worker
+    float lastLeadMs = 0.0f;    ///< Last transition: ready this long before it was due (negative = late by)
+    float lastDecodeMs = 0.0f;  ///< Worker time of the last transition
+    float lastSortMs = 0.0f;
+    float lastApplyMs = 0.0f;   ///< Main-thread cost of switching to it
+    bool waiting = false;       ///< The next transition is due but not prepared yet
 };
 
 /**
@@ -54,6 +132,13 @@ public:
      */
     void run();
 
+    /**
+     * @brief Publishes runtime metrics to a rotating file and/or a localhost endpoint.
+     * 
+     * @return false If nothing is configured or the HTTP port could not be bound.
+     */
+    bool startMetrics(const MetricsSettings& settings);
+
 private:
     // --- UI & Interaction Hooks ---
     // Allow GuiLayer to access private members for tuning
@@ -61,13 +146,29 @@ private:
 
 public:
     /**
-     * @brief Loads a source image from disk.
+     * @brief Loads a source image from disk in the background.
+     * 
+     * The image is decoded at no more than the simulation cap and swapped in by
+     * update() once ready.
      * @param path File path to image.
      */
     void loadSourceImage(const std::string& path);
 
     /**
-     * @brief Loads a target image from disk.
+     * @brief Opens a video file as the source for VIDEO mode.
+     * 
+     * Frames are decoded ahead on a background thread and already resized to
+     * the simulation grid.
+     * 
+     * @param path File path to video.
+     */
+    void loadVideo(const std::string& path);
+
+    /**
+     * @brief Loads a target image from disk in the background.
+     * 
+     * Decoded at no more than the largest simulation grid any mode can use
+     * (see getTargetResolutionCap()) and swapped in by update() once ready.
      * @param path File path to image.
      */
     void loadTargetImage(const std::string& path);
@@ -82,6 +183,7 @@ public:
      * - Stops any active transformation
      * - Clears particle system (forces rebuild on next update)
      * - Resets simulation dimensions
+     * - Releases the webcam when leaving WEBCAM mode (update() reopens it on return)
      * 
      * @param mode The new input mode to switch to.
      */
@@ -92,6 +194,36 @@ public:
      */
     void clearCanvas();
 
+    /**
+     * @brief Reverts the last canvas edit (stroke, fill or clear).
+     */
+    void undoCanvas();
+
+    /**
+     * @brief Re-applies the last undone canvas edit.
+     */
+    void redoCanvas();
+
+    /**
+     * @brief Sets the canvas drawing resolution, independent of window and simulation size.
+     * 
+     * Recreates the canvas (discarding the drawing) and, in canvas mode,
+     * recomputes the simulation grid.
+     * 
+     * @param width Drawing width in pixels.
+     * @param height Drawing height in pixels.
+     */
+    void setCanvasResolution(int width, int height);
+
+    /**
+     * @brief Caps the simulation grid in canvas mode.
+     * 
+     * The canvas is downsampled on the GPU to the capped grid before readback.
+     * 
+     * @param maxRes Largest simulation dimension in pixels (0 = match canvas resolution).
+     */
+    void setCanvasSimulationCap(int maxRes);
+
 private:
     /** 
      * @brief Internal initialization routine to setup GLFW, Glad, and ImGui.
@@ -121,6 +253,91 @@ private:
      */
     void processInput();
 
+    /**
+     * @brief Steps the simulation and renders offscreen frames for an active export.
+     * 
+     * Runs as many steps as the readback/encoder pipeline accepts within a
+     * frame-time budget, so exports run faster than real time while the UI stays live.
+     */
+    void exportFrames();
+
+    /**
+     * @brief Forces the canvas simulation grid to be recomputed on the next update.
+     */
+    void resetCanvasSimulation();
+
+    /**
+     * @brief Starts opening the webcam in the background and resets stall tracking.
+     */
+    void startWebcam();
+
+    /**
+     * @brief Completes m_Startup after the first swap and prints the breakdown once.
+     */
+    void reportStartup();
+
+    /**
+     * @brief Swaps in a finished background image load (source or target).
+     */
+    void applyLoadedImage(LoadedImage& loaded);
+
+    /**
+     * @brief Longest side a target image is decoded at: the biggest grid any input mode can sort into.
+     */
+    int getTargetResolutionCap() const;
+
+    static constexpr int kImageSimulationCap = 800; ///< Image-mode simulation cap (longest side) at scale 1
+    static constexpr int kStreamSimulationCap = 600; ///< Webcam/video grid width cap at scale 1, for real time
+    static constexpr int kStreamSimulationMin = 256; ///< Smallest webcam/video grid side
+    static constexpr float kMaxResolutionScale = 2.0f; ///< Upper bound of the dynamic resolution scale
+
+    /**
+     * @brief Feeds the frame's cost to the resolution controller and applies a new scale if it picks one.
+     * 
+     * @param cpuMs Wall time of update() and render(), excluding the buffer swap.
+     */
+    void updateResolutionScale(float cpuMs);
+
+    /**
+     * @brief Takes the controller's current scale and has the input mode re-size its grid.
+     */
+    void applyResolutionScale();
+
+    /**
+     * @brief An input mode's default grid cap, scaled by dynamic resolution.
+     */
+    int scaledSimulationCap(int cap) const;
+
+    /**
+     * @brief Sizes the grid for a webcam or video frame and limits the controller to scales that change it.
+     */
+    void fitStreamGrid(int frameWidth, int frameHeight);
+
+    /**
+     * @brief Applies the next prefetched playlist transition once the current one has dwelled long enough.
+     */
+    void updatePlaylist();
+
+    /**
+     * @brief Switches particles, colors and targets to a prepared transition and restarts the animation.
+     * 
+     * No sorting happens here; the mapping was computed by the prefetcher.
+     */
+    void applyTransition(PreparedTransition& transition);
+
+    /**
+     * @brief Draws the particles with the CPU rasterizer and presents the result.
+     */
+    void renderSoftware();
+
+    /**
+     * @brief Renders the current particles on both paths and records how far apart they are.
+     * 
+     * The GL frame is read back from the window framebuffer, so this is a debugging
+     * aid, not something to run every frame.
+     */
+    void compareRasterizers();
+
     // Window State
     GLFWwindow* m_Window = nullptr;
     std::string m_Title;
@@ -131,16 +348,85 @@ private:
     std::unique_ptr<Graphics::Renderer> m_Renderer;
     std::unique_ptr<UI::GuiLayer> m_GuiLayer;
     std::unique_ptr<Canvas> m_Canvas;
+    std::unique_ptr<StrokeHistory> m_History; // Undo/redo log for m_Canvas
+    std::unique_ptr<Graphics::GpuProfiler> m_Profiler;
+    std::unique_ptr<Graphics::FrameExporter> m_Exporter;
+    Graphics::ExportSettings m_ExportSettings; // Edited in the GUI, applied on startExport()
+    std::unique_ptr<Graphics::SoftwareRasterizer> m_SoftwareRasterizer; // Created on first use
+    std::unique_ptr<Texture2D> m_SoftwareFrame; // Upload of the CPU-rasterized frame
+    bool m_UseSoftwareRasterizer = false;
+    bool m_CompareRequested = false;
+
+    /**
+     * @struct RasterComparison
+     * @brief Difference between the GL and CPU rasterizers on the same frame.
+     */
+    struct RasterComparison {
+        bool valid = false;
+        bool lodActive = false;       ///< GL used the density splat, which the CPU path doesn't model
+        float meanError = 0.0f;       ///< Mean absolute difference per channel (0-255)
+        float mismatchPercent = 0.0f; ///< Pixels with any channel off by more than kRasterTolerance
+    } m_RasterComparison;
+    static constexpr int kRasterTolerance = 2;
 
     // Input State
     InputMode m_InputMode = InputMode::WEBCAM;
-    cv::VideoCapture m_Webcam;
+    WebcamCapture m_Webcam; // Opens and captures on its own thread; update() never blocks on the camera
+    static constexpr int kWebcamDevice = 0;
+    std::chrono::steady_clock::time_point m_LastWebcamFrameAt; // Last new webcam frame (stall detection)
+    bool m_WebcamStalled = false;
+    static constexpr double kWebcamStallSeconds = 1.0;
+    VideoSource m_Video;    // Decode-ahead video playback for VIDEO mode
     cv::Mat m_CurrentFrame;
     cv::Mat m_StaticImage; // Loaded source image
+    ImageLoader m_ImageLoader; // Background decode of source/target images
     cv::Mat m_FrozenFrame; // Captured frame when transform starts
+    cv::Mat m_CurrentLuma; // Grid-size Y plane of m_CurrentFrame (YUV-native sources only)
+    cv::Mat m_FrozenLuma;  // Y plane captured with m_FrozenFrame; sorted on directly
+    float m_LastSortMs = 0.0f;       // Duration of the last recalculateTargets() sort
+    bool m_LastSortUsedLuma = false; // Whether that sort was keyed on the luma plane
+
+    // Source Versioning
+    // Every input source carries a generation counter that is bumped whenever its
+    // pixels change. update() only copies, resamples and rewrites particle colors
+    // when the generation (or the simulation grid) differs from what was last applied.
+    uint64_t m_WebcamGeneration = 0;        ///< Bumped per captured webcam frame
+    uint64_t m_StaticImageGeneration = 0;   ///< Bumped per loaded source image
+    uint64_t m_VideoGeneration = 0;         ///< Bumped per presented video frame
+    uint64_t m_CurrentFrameGeneration = 0;  ///< Generation of m_CurrentFrame contents (0 = none)
+    uint64_t m_FrozenFrameGeneration = 0;   ///< Generation of m_FrozenFrame contents
+    uint64_t m_ParticleColorGeneration = 0; ///< Generation last written into particle colors
+    int m_ParticleGridWidth = 0;            ///< Grid the particle buffer was built for
+    int m_ParticleGridHeight = 0;
+    bool m_ParticlesAtRest = true;          ///< True while particles sit on their source grid
+    cv::Mat m_ResampledFrame;               ///< Color source resized to the simulation grid
+    std::vector<Particle> m_PreviousParticles; ///< Old buffer during a mid-transform rescale, kept for its capacity
+    std::vector<glm::vec2> m_Mapping;       ///< Last sort's particle -> target table, reused between sorts
+    UpdateStats m_UpdateStats;
+    AllocationStats m_AllocationStats;
+    StartupStats m_Startup;
+    std::chrono::steady_clock::time_point m_StartupBegin;
+    
+    // Playlist State
+    std::vector<PlaylistEntry> m_Playlist; // Edited in the GUI
+    bool m_PlaylistLoop = true;
+    bool m_PlaylistActive = false;
+    bool m_PlaylistStarted = false;        // First transition applied
+    size_t m_PlaylistEntry = 0;            // Entry currently animating
+    std::chrono::steady_clock::time_point m_PlaylistDueAt; // When the next transition should start
+    TransitionPrefetcher m_Prefetcher;     // Decodes and sorts the next transition in the background
+    PlaylistStats m_PlaylistStats;
+    // Playlist frames get generations far above any source counter so they never match one
+    static constexpr uint64_t kPlaylistGenerationBase = 1ull << 62;
+    uint64_t m_PlaylistGeneration = kPlaylistGenerationBase;
     
     // Target State
     cv::Mat m_TargetImage; // Loaded target image
+    std::string m_TargetPath;       ///< File m_TargetImage was decoded from (empty for playlist targets)
+    int m_TargetDecodeCap = 0;      ///< Resolution cap m_TargetImage was decoded at
+    std::string m_TargetRequestedPath; ///< File of the latest target load request
+    int m_TargetRequestedCap = 0;   ///< Cap of the latest target load request
+    bool m_TargetDownscaled = false; ///< m_TargetImage is smaller than its file
     std::unique_ptr<Texture2D> m_TargetPreview; // GPU texture for GUI preview
 
     // Physics Parameters (Tunable via GUI)
@@ -157,14 +443,25 @@ private:
     DrawTool m_DrawTool = DrawTool::PEN;
     glm::vec3 m_DrawColor = glm::vec3(1.0f, 0.0f, 0.0f); // Default red
     float m_BrushSize = 4.0f;
+    int m_FillTolerance = 32; // Per-channel tolerance (0-255) for the fill tool
     bool m_IsDrawing = false;
-    glm::vec2 m_LastMousePos = glm::vec2(0.0f);
+    glm::vec2 m_LastMousePos = glm::vec2(0.0f); // In canvas pixels
+    int m_CanvasMaxSimRes = 0; // Canvas-mode simulation cap (0 = canvas resolution)
     
     // Core Logic
     std::unique_ptr<Sorter> m_Sorter;
     bool m_IsTransforming = false;
     int m_SimulationWidth = 256;
     int m_SimulationHeight = 256;
+    bool m_SimulationSizePending = true; // The input mode must (re)compute the grid on the next update()
+    
+    // Dynamic Resolution
+    ResolutionController m_ResolutionController; // Scales the grid to keep the frame cost in budget
+    float m_ResolutionScale = 1.0f;              // Scale the current grid was sized with
+    float m_FrameCostMs = 0.0f;                  // Last frame's work time (CPU or GPU, whichever is longer)
+    
+    // Runtime Metrics
+    MetricsExporter m_MetricsExporter; // Periodic snapshots of the Metrics registry (off unless started)
     
     /**
      * @brief Recalculates particle targets based on current source and target images.
@@ -186,4 +483,39 @@ public:
      * @brief Returns whether transform is currently active.
      */
     bool isTransforming() const { return m_IsTransforming; }
+
+    /**
+     * @brief Plays m_Playlist: a chain of transforms, each starting from the previous settled state.
+     * 
+     * Switches to image mode. An entry without its own source continues from the
+     * previous one; if the first entry has none, the current frame is used.
+     */
+    void startPlaylist();
+
+    /**
+     * @brief Stops the playlist and its transform.
+     */
+    void stopPlaylist();
+
+    /**
+     * @brief Returns whether a playlist is playing.
+     */
+    bool isPlaylistActive() const { return m_PlaylistActive; }
+
+    /**
+     * @brief Restarts the transform and exports it offscreen with m_ExportSettings.
+     * 
+     * @param path Video file, or directory for a PNG sequence.
+     */
+    void startExport(const std::string& path);
+
+    /**
+     * @brief Aborts the running export.
+     */
+    void cancelExport();
+
+    /**
+     * @brief Returns whether an export is in progress.
+     */
+    bool isExporting() const { return m_Exporter && m_Exporter->isActive(); }
 };
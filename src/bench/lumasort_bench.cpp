@@ -0,0 +1,433 @@
+/**
+ * LumaSort Benchmarks
+ *
+ * Times the engine's CPU hot paths on synthetic images, without a window or GL:
+ * - sort_image / sort_luma: Sorter::sortImage() and Sorter::sortLuma() at every
+ *   grid size and luminance distribution;
+ * - flow_field: FlowField::getForce() for every particle of a grid;
+ * - physics_step: one stepParticles() pass over a grid of moving particles.
+ *
+ * Each case reports per-iteration latency percentiles, throughput in particles
+ * per second and C++ heap allocations per iteration. Results can be written as
+ * JSON and compared against a baseline JSON from another commit.
+ *
+ * Usage: lumasort_bench [--sizes 128,256,...] [--distributions uniform,...]
+ *                       [--filter TEXT] [--min-time S] [--min-iterations N]
+ *                       [--json OUT] [--compare BASELINE] [--threshold PERCENT]
+ */
+
+#include "../core/allocation_counter.h"
+#include "../core/flow_field.h"
+#include "../core/physics.h"
+#include "../core/sorter.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Luminance layouts that stress the sort differently.
+     */
+    enum class Distribution {
+        Uniform,   ///< Independent random pixels: many distinct keys, no order
+        Gradient,  ///< Horizontal ramp: keys already grouped, few distinct values per column
+        Constant,  ///< One gray: every key ties
+        Bimodal,   ///< Dark and bright halves with noise: two dense clusters
+        Smooth     ///< Low-frequency noise, closest to a photo or webcam frame
+    };
+
+    const std::vector<std::pair<Distribution, const char*>> kDistributions = {
+        { Distribution::Uniform, "uniform" },
+        { Distribution::Gradient, "gradient" },
+        { Distribution::Constant, "constant" },
+        { Distribution::Bimodal, "bimodal" },
+        { Distribution::Smooth, "smooth" },
+    };
+
+    struct Options {
+        std::vector<int> sizes = { 128, 256, 512, 1024, 2048 };
+        std::vector<std::string> distributions;  ///< Empty = all
+        std::string filter;                      ///< Only cases whose name contains this
+        double minSeconds = 0.5;                 ///< Keep iterating until this much time was measured...
+        int minIterations = 5;                   ///< ...and at least this many iterations ran
+        int maxIterations = 1000;
+        std::string jsonPath;
+        std::string comparePath;
+        double thresholdPercent = 10.0;          ///< Slowdown of p50 reported as a regression
+    };
+
+    struct BenchResult {
+        std::string name;
+        std::string distribution;  ///< "-" for cases that don't depend on the image
+        int size = 0;              ///< Grid side; particles = size * size
+        int iterations = 0;
+        double meanMs = 0.0;
+        double minMs = 0.0;
+        double p50Ms = 0.0;
+        double p90Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        double particlesPerSec = 0.0;
+        double allocationsPerIteration = 0.0;
+        double bytesPerIteration = 0.0;
+
+        std::string key() const { return name + "/" + distribution + "/" + std::to_string(size); }
+    };
+
+    cv::Mat makeImage(Distribution distribution, int size, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::normal_distribution<float> noise(0.0f, 12.0f);
+        cv::Mat image(size, size, CV_8UC3);
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                cv::Vec3b& pixel = image.at<cv::Vec3b>(y, x);
+                switch (distribution) {
+                    case Distribution::Uniform:
+                        pixel = cv::Vec3b((uchar)byte(rng), (uchar)byte(rng), (uchar)byte(rng));
+                        break;
+                    case Distribution::Gradient: {
+                        uchar value = (uchar)(x * 255 / std::max(1, size - 1));
+                        pixel = cv::Vec3b(value, value, value);
+                        break;
+                    }
+                    case Distribution::Constant:
+                        pixel = cv::Vec3b(128, 128, 128);
+                        break;
+                    case Distribution::Bimodal: {
+                        float base = (byte(rng) & 1) ? 220.0f : 35.0f;
+                        for (int c = 0; c < 3; ++c) {
+                            pixel[c] = (uchar)std::clamp(base + noise(rng), 0.0f, 255.0f);
+                        }
+                        break;
+                    }
+                    case Distribution::Smooth:
+                        break;
+                }
+            }
+        }
+        if (distribution == Distribution::Smooth) {
+            // Random coarse grid, upsampled smoothly
+            cv::Mat coarse = makeImage(Distribution::Uniform, std::max(2, size / 32), seed);
+            cv::resize(coarse, image, image.size(), 0, 0, cv::INTER_CUBIC);
+        }
+        return image;
+    }
+
+    double percentile(const std::vector<double>& sorted, double q) {
+        size_t rank = (size_t)std::ceil(q * (double)sorted.size());
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+
+    /**
+     * @brief Runs @p body once to warm up, then times it until the options' time and iteration minimums are met.
+     */
+    template <typename Body>
+    BenchResult measure(const Options& options, const std::string& name, const std::string& distribution,
+                        int size, Body&& body) {
+        body();
+
+        std::vector<double> samples;
+        samples.reserve(options.maxIterations); // Keep our own bookkeeping out of the allocation count
+        double totalMs = 0.0;
+        AllocationCounts allocationsBefore = AllocationCounter::total();
+        while ((int)samples.size() < options.maxIterations &&
+               ((int)samples.size() < options.minIterations || totalMs < options.minSeconds * 1000.0)) {
+            Clock::time_point start = Clock::now();
+            body();
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            samples.push_back(ms);
+            totalMs += ms;
+        }
+        AllocationCounts allocations = AllocationCounter::total() - allocationsBefore;
+
+        BenchResult result;
+        result.name = name;
+        result.distribution = distribution;
+        result.size = size;
+        result.iterations = (int)samples.size();
+        result.allocationsPerIteration = (double)allocations.count / result.iterations;
+        result.bytesPerIteration = (double)allocations.bytes / result.iterations;
+
+        std::sort(samples.begin(), samples.end());
+        result.meanMs = totalMs / result.iterations;
+        result.minMs = samples.front();
+        result.maxMs = samples.back();
+        result.p50Ms = percentile(samples, 0.50);
+        result.p90Ms = percentile(samples, 0.90);
+        result.p99Ms = percentile(samples, 0.99);
+        result.particlesPerSec = (double)size * size / (result.p50Ms / 1000.0);
+        return result;
+    }
+
+    bool wanted(const Options& options, const std::string& name) {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    void printResult(const BenchResult& result) {
+        std::printf("%-13s %-9s %5d  %5d it  p50 %9.3f  p90 %9.3f  p99 %9.3f ms  %8.2f Mp/s  %9.1f allocs/it\n",
+                    result.name.c_str(), result.distribution.c_str(), result.size, result.iterations,
+                    result.p50Ms, result.p90Ms, result.p99Ms, result.particlesPerSec / 1.0e6,
+                    result.allocationsPerIteration);
+        std::fflush(stdout);
+    }
+
+    std::vector<BenchResult> runAll(const Options& options) {
+        std::vector<BenchResult> results;
+        Sorter sorter;
+
+        for (int size : options.sizes) {
+            // --- Sorting: the only stage whose cost depends on the image content ---
+            for (const auto& [distribution, distributionName] : kDistributions) {
+                if (!options.distributions.empty() &&
+                    std::find(options.distributions.begin(), options.distributions.end(), distributionName) ==
+                        options.distributions.end()) {
+                    continue;
+                }
+                cv::Mat source = makeImage(distribution, size, 1u);
+                cv::Mat target = makeImage(distribution, size, 2u);
+
+                // The app's steady state: one sorter and one mapping, reused for every sort
+                std::vector<glm::vec2> mapping;
+                if (wanted(options, "sort_image")) {
+                    results.push_back(measure(options, "sort_image", distributionName, size, [&]() {
+                        if (!sorter.sortImage(source, target, size, size, mapping)) std::abort();
+                    }));
+                    printResult(results.back());
+                }
+                if (wanted(options, "sort_luma")) {
+                    cv::Mat luma;
+                    cv::cvtColor(source, luma, cv::COLOR_BGR2GRAY);
+                    results.push_back(measure(options, "sort_luma", distributionName, size, [&]() {
+                        if (!sorter.sortLuma(luma, target, size, size, mapping)) std::abort();
+                    }));
+                    printResult(results.back());
+                }
+            }
+
+            // --- Flow field: one force sample per particle ---
+            std::vector<Particle> particles;
+            initParticleGrid(particles, size, size);
+            if (wanted(options, "flow_field")) {
+                float time = 0.0f;
+                volatile float sink = 0.0f;
+                results.push_back(measure(options, "flow_field", "-", size, [&]() {
+                    glm::vec2 sum(0.0f);
+                    for (const Particle& particle : particles) {
+                        sum += FlowField::getForce(particle.pos, time, 5.0f);
+                    }
+                    time += kPhysicsTimeStep;
+                    sink = sink + sum.x + sum.y; // Keep the loop from being optimized away
+                }));
+                printResult(results.back());
+            }
+
+            // --- Physics: targets are a shuffled grid so every particle is in flight ---
+            if (wanted(options, "physics_step")) {
+                std::vector<size_t> order(particles.size());
+                std::iota(order.begin(), order.end(), 0);
+                std::shuffle(order.begin(), order.end(), std::mt19937(3u));
+                for (size_t i = 0; i < particles.size(); ++i) {
+                    particles[i].target = particles[order[i]].pos;
+                }
+                PhysicsParams params;
+                float time = 0.0f;
+                results.push_back(measure(options, "physics_step", "-", size, [&]() {
+                    time += kPhysicsTimeStep;
+                    stepParticles(particles.data(), particles.size(), time, params);
+                }));
+                printResult(results.back());
+            }
+        }
+        return results;
+    }
+
+    bool writeJson(const std::string& path, const std::vector<BenchResult>& results) {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Bench: Cannot write " << path << std::endl;
+            return false;
+        }
+        out.precision(6);
+        out << std::fixed;
+        out << "{\n  \"version\": 1,\n"
+            << "  \"timestamp\": " << (long long)std::time(nullptr) << ",\n"
+            << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+            << "  \"opencv\": \"" << CV_VERSION << "\",\n"
+#ifdef NDEBUG
+            << "  \"optimized\": true,\n"
+#else
+            << "  \"optimized\": false,\n"
+#endif
+            << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"distribution\": \"" << r.distribution
+                << "\", \"size\": " << r.size << ", \"particles\": " << (long long)r.size * r.size
+                << ", \"iterations\": " << r.iterations << ", \"mean_ms\": " << r.meanMs
+                << ", \"min_ms\": " << r.minMs << ", \"p50_ms\": " << r.p50Ms << ", \"p90_ms\": " << r.p90Ms
+                << ", \"p99_ms\": " << r.p99Ms << ", \"max_ms\": " << r.maxMs
+                << ", \"particles_per_sec\": " << r.particlesPerSec
+                << ", \"allocations_per_iteration\": " << r.allocationsPerIteration
+                << ", \"bytes_per_iteration\": " << r.bytesPerIteration << "}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return (bool)out;
+    }
+
+    /**
+     * @brief Reads a field of a result line written by writeJson() (one result object per line).
+     */
+    std::string jsonField(const std::string& line, const std::string& key) {
+        size_t pos = line.find("\"" + key + "\": ");
+        if (pos == std::string::npos) return std::string();
+        pos += key.size() + 4;
+        if (line[pos] == '"') {
+            size_t end = line.find('"', pos + 1);
+            return end == std::string::npos ? std::string() : line.substr(pos + 1, end - pos - 1);
+        }
+        return line.substr(pos, line.find_first_of(",}", pos) - pos);
+    }
+
+    /**
+     * @brief Prints the p50 change of every case also present in @p path.
+     * @return Number of cases slower than the threshold, or -1 if the baseline can't be read.
+     */
+    int compareWithBaseline(const std::string& path, const std::vector<BenchResult>& results, double thresholdPercent) {
+        std::ifstream baseline(path);
+        if (!baseline.is_open()) {
+            std::cerr << "Bench: Cannot open baseline " << path << std::endl;
+            return -1;
+        }
+
+        std::map<std::string, double> baselineP50;
+        for (std::string line; std::getline(baseline, line);) {
+            std::string name = jsonField(line, "name");
+            if (name.empty()) continue;
+            baselineP50[name + "/" + jsonField(line, "distribution") + "/" + jsonField(line, "size")] =
+                std::atof(jsonField(line, "p50_ms").c_str());
+        }
+        if (baselineP50.empty()) {
+            std::cerr << "Bench: No results in baseline " << path << std::endl;
+            return -1;
+        }
+
+        int regressions = 0;
+        std::printf("\nCompared with %s (p50, regression above +%.0f%%):\n", path.c_str(), thresholdPercent);
+        for (const BenchResult& result : results) {
+            auto it = baselineP50.find(result.key());
+            if (it == baselineP50.end() || it->second <= 0.0) continue;
+            double change = (result.p50Ms / it->second - 1.0) * 100.0;
+            bool regressed = change > thresholdPercent;
+            regressions += regressed ? 1 : 0;
+            std::printf("%-36s %9.3f -> %9.3f ms  %+7.1f%%%s\n", result.key().c_str(), it->second, result.p50Ms,
+                        change, regressed ? "  REGRESSION" : "");
+        }
+        return regressions;
+    }
+
+    std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> items;
+        std::stringstream stream(text);
+        for (std::string item; std::getline(stream, item, ',');) {
+            if (!item.empty()) items.push_back(item);
+        }
+        return items;
+    }
+
+    void printUsage() {
+        std::cout << "Usage: lumasort_bench [options]\n\n"
+                  << "  --sizes LIST          Grid sides (default 128,256,512,1024,2048)\n"
+                  << "  --distributions LIST  uniform, gradient, constant, bimodal, smooth (default all)\n"
+                  << "  --filter TEXT         Only cases containing TEXT (sort_image, sort_luma, flow_field, physics_step)\n"
+                  << "  --min-time S          Measured seconds per case, at least (default 0.5)\n"
+                  << "  --min-iterations N    Iterations per case, at least (default 5)\n"
+                  << "  --json OUT            Write results as JSON\n"
+                  << "  --compare BASELINE    Compare p50 against an earlier --json file; exit code 1 on regressions\n"
+                  << "  --threshold PERCENT   Slowdown counted as a regression (default 10)\n";
+    }
+
+    bool parseArgs(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string flag = argv[i];
+            if (flag == "--help") return false;
+            if (i + 1 >= argc) {
+                std::cerr << "Bench: Missing value for " << flag << std::endl;
+                return false;
+            }
+            std::string value = argv[++i];
+            if (flag == "--sizes") {
+                options.sizes.clear();
+                for (const std::string& item : splitList(value)) {
+                    int size = std::atoi(item.c_str());
+                    if (size < 2) return false;
+                    options.sizes.push_back(size);
+                }
+            } else if (flag == "--distributions") {
+                options.distributions = splitList(value);
+            } else if (flag == "--filter") {
+                options.filter = value;
+            } else if (flag == "--min-time") {
+                options.minSeconds = std::atof(value.c_str());
+            } else if (flag == "--min-iterations") {
+                options.minIterations = std::max(1, std::atoi(value.c_str()));
+            } else if (flag == "--json") {
+                options.jsonPath = value;
+            } else if (flag == "--compare") {
+                options.comparePath = value;
+            } else if (flag == "--threshold") {
+                options.thresholdPercent = std::atof(value.c_str());
+            } else {
+                std::cerr << "Bench: Unknown option " << flag << std::endl;
+                return false;
+            }
+        }
+        return !options.sizes.empty();
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+#ifndef NDEBUG
+    std::cerr << "Bench: Warning: built without optimizations; numbers are not representative." << std::endl;
+#endif
+
+    std::vector<BenchResult> results = runAll(options);
+    if (results.empty()) {
+        std::cerr << "Bench: No case matched" << std::endl;
+        return 2;
+    }
+
+    if (!options.jsonPath.empty()) {
+        if (!writeJson(options.jsonPath, results)) return 2;
+        std::cout << "Wrote " << results.size() << " results to " << options.jsonPath << std::endl;
+    }
+    if (!options.comparePath.empty()) {
+        int regressions = compareWithBaseline(options.comparePath, results, options.thresholdPercent);
+        if (regressions < 0) return 2;
+        if (regressions > 0) return 1;
+    }
+    return 0;
+}
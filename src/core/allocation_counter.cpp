@@ -0,0 +1,41 @@
+#include "allocation_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Plain integers: thread_local needs no constructor, so operator new is safe to call
+// from any thread at any time, including before main() and during thread exit
+thread_local uint64_t t_allocations = 0;
+thread_local uint64_t t_allocatedBytes = 0;
+
+std::atomic<uint64_t> g_allocations{ 0 };
+std::atomic<uint64_t> g_allocatedBytes{ 0 };
+
+} // namespace
+
+void* operator new(size_t size) {
+    ++t_allocations;
+    t_allocatedBytes += size;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+AllocationCounts AllocationCounter::thisThread() {
+    return { t_allocations, t_allocatedBytes };
+}
+
+AllocationCounts AllocationCounter::total() {
+    return { g_allocations.load(std::memory_order_relaxed), g_allocatedBytes.load(std::memory_order_relaxed) };
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @struct AllocationCounts
+ * @brief Heap allocations made through operator new, and the bytes they asked for.
+ */
+struct AllocationCounts {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+
+    AllocationCounts operator-(const AllocationCounts& earlier) const {
+        return { count - earlier.count, bytes - earlier.bytes };
+    }
+};
+
+/**
+ * @class AllocationCounter
+ * @brief Counts heap allocations by replacing the global operator new.
+ *
+ * The replacement lives in allocation_counter.cpp and is linked into any program
+ * that calls AllocationCounter, for the whole process. Counting is a thread-local
+ * and a relaxed atomic add, so it stays on in release builds.
+ *
+ * Take a snapshot before and after a region and subtract:
+ * @code
+ * AllocationCounts before = AllocationCounter::thisThread();
+ * update();
+ * uint64_t allocations = (AllocationCounter::thisThread() - before).count;
+ * @endcode
+ *
+ * @note Memory that bypasses operator new is not seen: malloc() from C libraries
+ *       (GLFW, ImGui's default allocator, drivers) and OpenCV's pixel buffers.
+ *       A new cv::Mat buffer still shows up as one allocation, for the header
+ *       OpenCV creates with new, but its pixel bytes are not included.
+ */
+class AllocationCounter {
+public:
+    /**
+     * @brief Allocations made so far by the calling thread.
+     */
+    static AllocationCounts thisThread();
+
+    /**
+     * @brief Allocations made so far by all threads.
+     */
+    static AllocationCounts total();
+};
@@ -0,0 +1,274 @@
+#include "cpu_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+std::atomic<bool> CpuProfiler::s_enabled{ false };
+
+namespace {
+
+/**
+ * @brief Event slot. Fields are relaxed atomics so a concurrent reader never races the owner.
+ */
+struct Slot {
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<int64_t> startNs{ 0 };
+    std::atomic<int64_t> endNs{ 0 };
+    std::atomic<uint32_t> depth{ 0 };
+};
+
+struct ThreadRing {
+    uint32_t id = 0;                 ///< Guarded by g_registryMutex; new for every owner thread
+    std::string name;
+    std::unique_ptr<Slot[]> slots{ new Slot[CpuProfiler::kRingSize] };
+    std::atomic<uint64_t> head{ 0 }; ///< Events ever written; only the owner stores it
+    std::atomic<uint64_t> base{ 0 }; ///< First event of the current owner; older ones belonged to an exited thread
+    uint32_t depth = 0;              ///< Owner-only nesting level
+    bool inUse = true;               ///< Guarded by g_registryMutex
+};
+
+// Rings live for the whole process so events of exited threads stay readable.
+// A ring whose thread exited is handed to the next new thread, so short-lived
+// workers don't grow the registry; the handoff clears it and gives it a new id.
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<ThreadRing>> g_rings;
+uint32_t g_nextThreadId = 0; ///< Guarded by g_registryMutex
+
+/**
+ * @brief A ring as seen by collect(), copied out of the registry under its lock.
+ */
+struct RingSnapshot {
+    ThreadRing* ring;
+    uint32_t id;
+};
+
+// collect() scratch, reused between calls so the open profiler panel doesn't allocate
+std::mutex g_collectMutex;
+std::vector<RingSnapshot> g_collectRings;
+std::vector<uint64_t> g_collectIndices;
+
+/**
+ * @brief The calling thread's ring and name; releases the ring when the thread exits.
+ */
+struct ThreadState {
+    ThreadRing* ring = nullptr;
+    std::string name; ///< Applied when the ring is acquired
+
+    ~ThreadState() {
+        if (!ring) return;
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        ring->inUse = false;
+        ring->depth = 0;
+    }
+};
+thread_local ThreadState t_state;
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+// Frame boundaries (main thread only)
+int64_t g_frameStarts[CpuProfiler::kFrameHistory];
+size_t g_frameCount = 0; ///< Frames ever marked
+
+ThreadRing& threadRing() {
+    if (!t_state.ring) {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (auto& ring : g_rings) {
+            if (!ring->inUse) {
+                // The previous owner's events must not show up under this thread
+                ring->inUse = true;
+                ring->base.store(ring->head.load(std::memory_order_relaxed), std::memory_order_release);
+                t_state.ring = ring.get();
+                break;
+            }
+        }
+        if (!t_state.ring) {
+            g_rings.push_back(std::make_unique<ThreadRing>());
+            t_state.ring = g_rings.back().get();
+        }
+        t_state.ring->id = ++g_nextThreadId;
+        t_state.ring->name = t_state.name.empty() ? "Thread " + std::to_string(t_state.ring->id) : t_state.name;
+    }
+    return *t_state.ring;
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+void CpuProfiler::setEnabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void CpuProfiler::setThreadName(const char* name) {
+    // Rings are only allocated once a thread records, so idle threads cost nothing
+    t_state.name = name;
+    if (t_state.ring) {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        t_state.ring->name = name;
+    }
+}
+
+int64_t CpuProfiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+void CpuProfiler::markFrame() {
+    g_frameStarts[g_frameCount % kFrameHistory] = now();
+    ++g_frameCount;
+}
+
+size_t CpuProfiler::getFrameCount() {
+    // The newest boundary opens a frame that hasn't finished yet
+    return g_frameCount > 1 ? std::min(g_frameCount - 1, kFrameHistory - 1) : 0;
+}
+
+bool CpuProfiler::getFrame(size_t framesAgo, int64_t& startNs, int64_t& endNs) {
+    if (framesAgo >= getFrameCount()) return false;
+    size_t end = g_frameCount - 1 - framesAgo;
+    startNs = g_frameStarts[(end - 1) % kFrameHistory];
+    endNs = g_frameStarts[end % kFrameHistory];
+    return true;
+}
+
+uint32_t CpuProfiler::enterScope() {
+    return threadRing().depth++;
+}
+
+void CpuProfiler::leaveScope() {
+    ThreadRing& ring = threadRing();
+    if (ring.depth > 0) --ring.depth;
+}
+
+void CpuProfiler::record(const char* name, int64_t startNs, int64_t endNs, uint32_t depth) {
+    ThreadRing& ring = threadRing();
+    uint64_t index = ring.head.load(std::memory_order_relaxed);
+    Slot& slot = ring.slots[index % kRingSize];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.endNs.store(endNs, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::collect(int64_t fromNs, std::vector<CpuProfileEvent>& events) {
+    std::lock_guard<std::mutex> collectLock(g_collectMutex);
+
+    // Threads take the registry lock when they first record, so hold it only to list
+    // the rings (they are never freed), not while copying their events
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        g_collectRings.clear();
+        for (auto& ring : g_rings) {
+            g_collectRings.push_back({ ring.get(), ring->id });
+        }
+    }
+
+    std::vector<uint64_t>& indices = g_collectIndices;
+    for (const RingSnapshot& snapshot : g_collectRings) {
+        ThreadRing* ring = snapshot.ring;
+        uint64_t base = ring->base.load(std::memory_order_acquire);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        // record() overwrites slot head % kRingSize (index head - kRingSize) before
+        // publishing head + 1, so that index is never safe to read
+        uint64_t first = std::max(base, head >= kRingSize ? head - kRingSize + 1 : 0);
+        size_t start = events.size();
+        indices.clear();
+        for (uint64_t i = first; i < head; ++i) {
+            const Slot& slot = ring->slots[i % kRingSize];
+            CpuProfileEvent event;
+            event.endNs = slot.endNs.load(std::memory_order_relaxed);
+            if (event.endNs < fromNs) continue;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.startNs = slot.startNs.load(std::memory_order_relaxed);
+            event.depth = slot.depth.load(std::memory_order_relaxed);
+            event.thread = snapshot.id;
+            events.push_back(event);
+            indices.push_back(i);
+        }
+
+        // Slots the owner lapped while we copied may be torn: drop them
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t headAfter = ring->head.load(std::memory_order_relaxed);
+        uint64_t firstValid = headAfter >= kRingSize ? headAfter - kRingSize + 1 : 0;
+        size_t torn = 0;
+        while (torn < indices.size() && indices[torn] < firstValid) ++torn;
+
+        // The ring changed hands while we copied: events from the new owner carry another id
+        uint64_t baseAfter = ring->base.load(std::memory_order_acquire);
+        size_t kept = indices.size();
+        if (baseAfter != base) {
+            while (kept > torn && indices[kept - 1] >= baseAfter) --kept;
+        }
+        events.erase(events.begin() + start + kept, events.begin() + start + indices.size());
+        events.erase(events.begin() + start, events.begin() + start + torn);
+    }
+}
+
+void CpuProfiler::getThreads(std::vector<CpuProfileThread>& threads) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    threads.resize(g_rings.size());
+    for (size_t i = 0; i < g_rings.size(); ++i) {
+        threads[i].id = g_rings[i]->id;
+        threads[i].name = g_rings[i]->name;
+    }
+}
+
+bool CpuProfiler::exportChromeTrace(const std::string& path, float seconds) {
+    std::vector<CpuProfileEvent> events;
+    collect(now() - (int64_t)(seconds * 1.0e9), events);
+    std::sort(events.begin(), events.end(), [](const CpuProfileEvent& a, const CpuProfileEvent& b) {
+        return a.startNs < b.startNs;
+    });
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "CpuProfiler: Cannot write " << path << std::endl;
+        return false;
+    }
+
+    // Complete ("X") events in microseconds, plus thread-name metadata
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    std::vector<CpuProfileThread> threads;
+    getThreads(threads);
+    for (const CpuProfileThread& thread : threads) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id
+            << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        writeJsonString(out, thread.name);
+        out << "}}";
+        first = false;
+    }
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (const CpuProfileEvent& event : events) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"cat\":\"lumasort\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << (event.endNs - event.startNs) / 1000.0
+            << ",\"name\":";
+        writeJsonString(out, event.name ? event.name : "?");
+        out << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        std::cerr << "CpuProfiler: Failed writing " << path << std::endl;
+        return false;
+    }
+    std::cout << "Wrote " << events.size() << " events (" << seconds << " s) to " << path << std::endl;
+    return true;
+}
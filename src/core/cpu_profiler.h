@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct CpuProfileEvent
+ * @brief One timed scope, as read back from a thread's ring.
+ */
+struct CpuProfileEvent {
+    const char* name = nullptr; ///< String literal passed to the scope
+    int64_t startNs = 0;        ///< Relative to the profiler's epoch
+    int64_t endNs = 0;
+    uint32_t depth = 0;         ///< Nesting level within its thread (0 = outermost)
+    uint32_t thread = 0;        ///< CpuProfileThread::id
+};
+
+/**
+ * @struct CpuProfileThread
+ * @brief A thread that has recorded events.
+ */
+struct CpuProfileThread {
+    uint32_t id = 0;
+    std::string name;
+};
+
+/**
+ * @class CpuProfiler
+ * @brief Process-wide scoped CPU timers, recorded per thread without locks.
+ *
+ * Each thread writes its finished scopes into its own ring of kRingSize events
+ * (single producer, registered on first use). Readers copy a ring and then
+ * re-check its head to drop any slot the owner overwrote during the copy, so
+ * recording never waits on a reader. When disabled, a scope costs one relaxed
+ * atomic load.
+ *
+ * The main thread marks frame boundaries with markFrame(), which the GUI uses
+ * to slice events into per-frame breakdowns. exportChromeTrace() writes the
+ * last few seconds in the Chrome trace-event format (chrome://tracing, Perfetto).
+ */
+class CpuProfiler {
+public:
+    static constexpr size_t kRingSize = 1 << 15;    ///< Events kept per thread
+    static constexpr size_t kFrameHistory = 600;    ///< Frame boundaries kept
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Names the calling thread in the panel and in traces.
+     */
+    static void setThreadName(const char* name);
+
+    /**
+     * @brief Nanoseconds since the profiler's epoch.
+     */
+    static int64_t now();
+
+    /**
+     * @brief Marks the start of a frame. Main thread only.
+     */
+    static void markFrame();
+
+    /**
+     * @brief Bounds of a completed frame. Main thread only.
+     *
+     * @param framesAgo 0 = the last completed frame.
+     * @return false If that frame is not in the history.
+     */
+    static bool getFrame(size_t framesAgo, int64_t& startNs, int64_t& endNs);
+
+    /**
+     * @brief Number of completed frames in the history. Main thread only.
+     */
+    static size_t getFrameCount();
+
+    /**
+     * @brief Copies all recorded events that end at or after @p fromNs, from every thread.
+     */
+    static void collect(int64_t fromNs, std::vector<CpuProfileEvent>& events);
+
+    /**
+     * @brief Replaces @p threads with the threads that have recorded events, in registration order.
+     *
+     * Reusing the same vector keeps its entries' string capacity, so repeated calls don't allocate.
+     */
+    static void getThreads(std::vector<CpuProfileThread>& threads);
+
+    /**
+     * @brief Writes the events of the last @p seconds as Chrome trace-event JSON.
+     * @return true On success.
+     */
+    static bool exportChromeTrace(const std::string& path, float seconds);
+
+    /**
+     * @brief Appends a finished scope to the calling thread's ring. Used by CpuProfileScope.
+     */
+    static void record(const char* name, int64_t startNs, int64_t endNs, uint32_t depth);
+
+    /**
+     * @brief Nesting level bookkeeping of the calling thread. Used by CpuProfileScope.
+     */
+    static uint32_t enterScope();
+    static void leaveScope();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+/**
+ * @class CpuProfileScope
+ * @brief Times the enclosing scope into the calling thread's ring (see PROFILE_SCOPE).
+ */
+class CpuProfileScope {
+public:
+    explicit CpuProfileScope(const char* name) {
+        if (!CpuProfiler::isEnabled()) return;
+        m_name = name;
+        m_depth = CpuProfiler::enterScope();
+        m_start = CpuProfiler::now();
+    }
+
+    ~CpuProfileScope() {
+        if (!m_name) return;
+        CpuProfiler::record(m_name, m_start, CpuProfiler::now(), m_depth);
+        CpuProfiler::leaveScope();
+    }
+
+    CpuProfileScope(const CpuProfileScope&) = delete;
+    CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+    const char* m_name = nullptr; ///< Null when profiling was off at construction
+    int64_t m_start = 0;
+    uint32_t m_depth = 0;
+};
+
+#define LUMASORT_PROFILE_CONCAT_INNER(a, b) a##b
+#define LUMASORT_PROFILE_CONCAT(a, b) LUMASORT_PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Times the rest of the enclosing block under @p name (a string literal).
+ */
+#define PROFILE_SCOPE(name) CpuProfileScope LUMASORT_PROFILE_CONCAT(profileScope_, __LINE__)(name)
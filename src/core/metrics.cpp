@@ -0,0 +1,164 @@
+#include "metrics.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+/**
+ * @brief One registry entry; owns its metric so addresses stay stable.
+ */
+struct Entry {
+    MetricInfo info;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<LatencyHistogram> histogram;
+};
+
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<Entry>> g_entries;
+
+/**
+ * @brief Finds or creates the entry for @p name. Caller holds g_registryMutex.
+ */
+Entry& findOrAdd(const std::string& name, const std::string& help, MetricType type) {
+    for (auto& entry : g_entries) {
+        if (entry->info.name == name) {
+            if (entry->info.type != type) {
+                std::cerr << "Metrics: " << name << " registered again with another type" << std::endl;
+            }
+            return *entry;
+        }
+    }
+    g_entries.push_back(std::make_unique<Entry>());
+    Entry& entry = *g_entries.back();
+    entry.info.name = name;
+    entry.info.help = help;
+    entry.info.type = type;
+    return entry;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram(double resolution)
+    : m_resolution(resolution > 0.0 ? resolution : 1.0), m_counts(new std::atomic<uint64_t>[kBuckets]) {
+    for (size_t i = 0; i < kBuckets; ++i) {
+        m_counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t units) {
+    if (units < kSubBuckets) return (size_t)units;
+    // Keep the top kSubBucketBits bits: the leading one selects the power of two, the rest the linear slot
+    int shift = (int)std::bit_width(units) - kSubBucketBits;
+    uint64_t sub = units >> shift; // [kSubBuckets / 2, kSubBuckets)
+    return (size_t)(kSubBuckets + (shift - 1) * (kSubBuckets / 2) + (sub - kSubBuckets / 2));
+}
+
+uint64_t LatencyHistogram::bucketLowest(size_t index) {
+    if (index < kSubBuckets) return index;
+    size_t offset = index - kSubBuckets;
+    int shift = (int)(offset / (kSubBuckets / 2)) + 1;
+    uint64_t sub = offset % (kSubBuckets / 2) + kSubBuckets / 2;
+    return sub << shift;
+}
+
+uint64_t LatencyHistogram::bucketWidth(size_t index) {
+    if (index < kSubBuckets) return 1;
+    return 1ull << ((index - kSubBuckets) / (kSubBuckets / 2) + 1);
+}
+
+void LatencyHistogram::record(double value) {
+    double scaled = value / m_resolution + 0.5;
+    uint64_t units = scaled <= 0.0 ? 0 : (uint64_t)std::min(scaled, (double)((1ull << kMaxBits) - 1));
+    m_counts[bucketIndex(units)].fetch_add(1, std::memory_order_relaxed);
+    m_sumUnits.fetch_add(units, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.resolution = m_resolution;
+    snapshot.counts.resize(kBuckets);
+    // Count is taken from the buckets so quantiles stay consistent under concurrent records
+    for (size_t i = 0; i < kBuckets; ++i) {
+        snapshot.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[i];
+    }
+    snapshot.sum = (double)m_sumUnits.load(std::memory_order_relaxed) * m_resolution;
+    return snapshot;
+}
+
+double LatencyHistogram::Snapshot::quantile(double q) const {
+    if (count == 0) return 0.0;
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(std::clamp(q, 0.0, 1.0) * (double)count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            // Middle of the bucket
+            return ((double)bucketLowest(i) + (double)(bucketWidth(i) - 1) * 0.5) * resolution;
+        }
+    }
+    return max();
+}
+
+double LatencyHistogram::Snapshot::max() const {
+    for (size_t i = counts.size(); i-- > 0;) {
+        if (counts[i] > 0) return (double)(bucketLowest(i) + bucketWidth(i) - 1) * resolution;
+    }
+    return 0.0;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::since(const Snapshot& earlier) const {
+    Snapshot delta;
+    delta.resolution = resolution;
+    delta.counts = counts;
+    for (size_t i = 0; i < delta.counts.size() && i < earlier.counts.size(); ++i) {
+        delta.counts[i] -= std::min(delta.counts[i], earlier.counts[i]);
+    }
+    for (uint64_t bucket : delta.counts) delta.count += bucket;
+    delta.sum = std::max(0.0, sum - earlier.sum);
+    return delta;
+}
+
+Counter& Metrics::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    Entry& entry = findOrAdd(name, help, MetricType::Counter);
+    if (!entry.counter) {
+        entry.counter = std::make_unique<Counter>();
+        entry.info.counter = entry.counter.get();
+    }
+    return *entry.counter;
+}
+
+Gauge& Metrics::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    Entry& entry = findOrAdd(name, help, MetricType::Gauge);
+    if (!entry.gauge) {
+        entry.gauge = std::make_unique<Gauge>();
+        entry.info.gauge = entry.gauge.get();
+    }
+    return *entry.gauge;
+}
+
+LatencyHistogram& Metrics::histogram(const std::string& name, const std::string& help, double resolution) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    Entry& entry = findOrAdd(name, help, MetricType::Histogram);
+    if (!entry.histogram) {
+        entry.histogram = std::make_unique<LatencyHistogram>(resolution);
+        entry.info.histogram = entry.histogram.get();
+    }
+    return *entry.histogram;
+}
+
+std::vector<MetricInfo> Metrics::list() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    std::vector<MetricInfo> metrics;
+    metrics.reserve(g_entries.size());
+    for (auto& entry : g_entries) {
+        metrics.push_back(entry->info);
+    }
+    return metrics;
+}
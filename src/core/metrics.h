@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class Counter
+ * @brief Monotonic count of events (Prometheus counter).
+ */
+class Counter {
+public:
+    void add(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{ 0 };
+};
+
+/**
+ * @class Gauge
+ * @brief Last observed value of something that goes up and down (Prometheus gauge).
+ */
+class Gauge {
+public:
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+    double value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value{ 0.0 };
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief HDR-style histogram: constant relative precision over a wide range, fixed memory.
+ *
+ * Values are counted in integer units of @c resolution. Below kSubBuckets units
+ * every unit has its own bucket; above, each power of two is split into
+ * kSubBuckets / 2 linear buckets, so a bucket is never wider than ~3% of its
+ * value. Recording is a few relaxed atomic adds and never allocates, so any
+ * thread may record into the same histogram.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 6;
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBucketBits;
+    static constexpr int kMaxBits = 44;  ///< Values above 2^44 units are clamped
+    static constexpr size_t kBuckets = kSubBuckets + (kMaxBits - kSubBucketBits) * (kSubBuckets / 2);
+
+    /**
+     * @brief Counts copied from a histogram; differences of two give the values recorded in between.
+     */
+    struct Snapshot {
+        std::vector<uint64_t> counts;
+        uint64_t count = 0;
+        double sum = 0.0;        ///< In the histogram's unit
+        double resolution = 1.0;
+
+        /**
+         * @brief Value at quantile @p q (0-1), accurate to the bucket width. 0 if empty.
+         */
+        double quantile(double q) const;
+
+        /**
+         * @brief Upper edge of the highest non-empty bucket. 0 if empty.
+         */
+        double max() const;
+
+        /**
+         * @brief Values recorded after @p earlier was taken.
+         */
+        Snapshot since(const Snapshot& earlier) const;
+    };
+
+    /**
+     * @param resolution Smallest distinguished value, in the metric's unit (e.g. 0.001 for ms with µs precision).
+     */
+    explicit LatencyHistogram(double resolution);
+
+    void record(double value);
+    Snapshot snapshot() const;
+
+private:
+    static size_t bucketIndex(uint64_t units);
+    static uint64_t bucketLowest(size_t index);
+    static uint64_t bucketWidth(size_t index);
+
+    double m_resolution;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_counts;
+    std::atomic<uint64_t> m_sumUnits{ 0 };
+};
+
+enum class MetricType {
+    Counter,
+    Gauge,
+    Histogram
+};
+
+/**
+ * @struct MetricInfo
+ * @brief A registered metric, as listed for exporters.
+ */
+struct MetricInfo {
+    std::string name;
+    std::string help;
+    MetricType type = MetricType::Counter;
+    Counter* counter = nullptr;
+    Gauge* gauge = nullptr;
+    LatencyHistogram* histogram = nullptr;
+};
+
+/**
+ * @class Metrics
+ * @brief Process-wide registry of named runtime metrics.
+ *
+ * Lookups take a lock, so callers fetch a metric once (typically into a
+ * function-local static) and then update it lock-free. Metrics live for the
+ * whole process. Looking up an existing name returns the same metric.
+ */
+class Metrics {
+public:
+    static Counter& counter(const std::string& name, const std::string& help);
+    static Gauge& gauge(const std::string& name, const std::string& help);
+
+    /**
+     * @param resolution See LatencyHistogram::LatencyHistogram. Only used when the histogram is created.
+     */
+    static LatencyHistogram& histogram(const std::string& name, const std::string& help, double resolution);
+
+    /**
+     * @brief All registered metrics, in registration order.
+     */
+    static std::vector<MetricInfo> list();
+};
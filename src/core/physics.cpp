@@ -0,0 +1,105 @@
+#include "physics.h"
+#include "flow_field.h"
+#include <algorithm>
+
+void fitImageGrid(int imageWidth, int imageHeight, int maxRes, int& simWidth, int& simHeight) {
+    simWidth = std::min(imageWidth, maxRes);
+    simHeight = std::min(imageHeight, maxRes);
+
+    // Maintain aspect ratio if one dimension exceeds max
+    float aspectRatio = (float)imageWidth / (float)std::max(1, imageHeight);
+    if (aspectRatio > 1.0f) {
+        simHeight = (int)(simWidth / aspectRatio);
+    } else {
+        simWidth = (int)(simHeight * aspectRatio);
+    }
+
+    // Ensure minimum resolution
+    simWidth = std::max(simWidth, 128);
+    simHeight = std::max(simHeight, 128);
+}
+
+void initParticleGrid(std::vector<Particle>& particles, int simWidth, int simHeight) {
+    particles.clear();
+    particles.reserve((size_t)simWidth * simHeight);
+
+    // Use separate divisors for X and Y to preserve aspect ratio
+    float maxDimX = (float)(simWidth - 1);
+    float maxDimY = (float)(simHeight - 1);
+
+    for (int y = 0; y < simHeight; ++y) {
+        for (int x = 0; x < simWidth; ++x) {
+            Particle p;
+            p.pos = glm::vec2(x / maxDimX, y / maxDimY);
+            p.vel = glm::vec2(0.0f);
+            p.acc = glm::vec2(0.0f);
+            p.target = p.pos;
+            p.color = glm::vec4(1.0f);
+            particles.push_back(p);
+        }
+    }
+}
+
+void resampleParticleGrid(const std::vector<Particle>& from, int fromWidth, int fromHeight,
+                          std::vector<Particle>& to, int toWidth, int toHeight) {
+    initParticleGrid(to, toWidth, toHeight);
+    if (from.size() != (size_t)fromWidth * fromHeight || from.empty()) return;
+
+    float scaleX = toWidth > 1 ? (float)(fromWidth - 1) / (float)(toWidth - 1) : 0.0f;
+    float scaleY = toHeight > 1 ? (float)(fromHeight - 1) / (float)(toHeight - 1) : 0.0f;
+    for (int y = 0; y < toHeight; ++y) {
+        int fromY = std::min(fromHeight - 1, (int)(y * scaleY + 0.5f));
+        for (int x = 0; x < toWidth; ++x) {
+            int fromX = std::min(fromWidth - 1, (int)(x * scaleX + 0.5f));
+            const Particle& source = from[(size_t)fromY * fromWidth + fromX];
+            Particle& p = to[(size_t)y * toWidth + x];
+            p.pos = source.pos;
+            p.vel = source.vel;
+            p.acc = source.acc;
+        }
+    }
+}
+
+void applyTargetMapping(std::vector<Particle>& particles, const std::vector<glm::vec2>& mapping,
+                        int simWidth, int simHeight) {
+    // Normalize to 0..1 using the proper dimension for each axis
+    float normX = (float)(simWidth - 1);
+    float normY = (float)(simHeight - 1);
+    size_t count = std::min(particles.size(), mapping.size());
+    for (size_t i = 0; i < count; ++i) {
+        particles[i].target = glm::vec2(mapping[i].x / normX, mapping[i].y / normY);
+    }
+}
+
+void resetParticlePositions(std::vector<Particle>& particles, int simWidth, int simHeight) {
+    float maxDimX = (float)(simWidth - 1);
+    float maxDimY = (float)(simHeight - 1);
+    for (size_t i = 0; i < particles.size(); ++i) {
+        int x = i % simWidth;
+        int y = i / simWidth;
+        particles[i].pos = glm::vec2(x / maxDimX, y / maxDimY);
+        particles[i].vel = glm::vec2(0.0f);
+        particles[i].acc = glm::vec2(0.0f);
+    }
+}
+
+void stepParticles(Particle* particles, size_t count, float time, const PhysicsParams& params) {
+    for (size_t i = 0; i < count; ++i) {
+        Particle& p = particles[i];
+        glm::vec2 desired = p.target - p.pos;
+        float dist = glm::length(desired);
+
+        glm::vec2 steer = glm::vec2(0.0f);
+        if (dist > 0.0001f) {
+            steer = glm::normalize(desired) * params.particleSpeed;
+        }
+
+        glm::vec2 flow = FlowField::getForce(p.pos, time, params.noiseScale) * params.flowStrength;
+
+        p.acc += steer + flow;
+        p.vel += p.acc;
+        p.pos += p.vel;
+        p.acc = glm::vec2(0.0f);
+        p.vel *= 0.90f;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "particle.h"
+
+/**
+ * @struct PhysicsParams
+ * @brief Tunable forces of the transform simulation.
+ */
+struct PhysicsParams {
+    float particleSpeed = 0.005f;  ///< Steering strength towards the target
+    float flowStrength = 0.0002f;  ///< Flow field force multiplier
+    float noiseScale = 5.0f;       ///< Spatial frequency of the flow field
+};
+
+/**
+ * @brief Simulation time added per physics step.
+ */
+constexpr float kPhysicsTimeStep = 0.01f;
+
+/**
+ * @brief Simulation grid for a still image: image aspect, longest side capped at maxRes, each side at least 128.
+ *
+ * Shared by image mode, playlists and the headless runner so they simulate the same grid.
+ */
+void fitImageGrid(int imageWidth, int imageHeight, int maxRes, int& simWidth, int& simHeight);
+
+/**
+ * @brief Lays particles out on a simWidth x simHeight grid in normalized (0..1) coordinates.
+ *
+ * Velocity and acceleration are zeroed, the target is the grid position and the
+ * color is white.
+ */
+void initParticleGrid(std::vector<Particle>& particles, int simWidth, int simHeight);
+
+/**
+ * @brief Rebuilds a particle grid at a new size, carrying over the motion state of the old one.
+ *
+ * Each new particle takes position, velocity and acceleration from the old
+ * particle nearest to its grid cell, so a moving cloud keeps its shape across
+ * the resize. Targets are reset to the grid and colors to white; the caller
+ * recomputes both.
+ */
+void resampleParticleGrid(const std::vector<Particle>& from, int fromWidth, int fromHeight,
+                          std::vector<Particle>& to, int toWidth, int toHeight);
+
+/**
+ * @brief Sets particle targets from a sort mapping.
+ *
+ * @param mapping Target pixel of each particle on the simWidth x simHeight grid (Sorter output).
+ */
+void applyTargetMapping(std::vector<Particle>& particles, const std::vector<glm::vec2>& mapping,
+                        int simWidth, int simHeight);
+
+/**
+ * @brief Moves particles back to their grid positions and stops them.
+ */
+void resetParticlePositions(std::vector<Particle>& particles, int simWidth, int simHeight);
+
+/**
+ * @brief Advances particles by one physics step: steer towards target, add flow, integrate, damp.
+ *
+ * @param particles First particle to step.
+ * @param count Number of particles.
+ * @param time Simulation time of this step (drives the flow field).
+ * @param params Force parameters.
+ */
+void stepParticles(Particle* particles, size_t count, float time, const PhysicsParams& params);
@@ -0,0 +1,80 @@
+#include "resolution_controller.h"
+#include <algorithm>
+#include <cmath>
+
+void ResolutionController::setSettings(const ResolutionSettings& settings) {
+    m_settings = settings;
+    m_settings.budgetMs = std::max(1.0f, m_settings.budgetMs);
+    m_settings.minScale = std::max(0.05f, m_settings.minScale);
+    m_settings.maxScale = std::max(m_settings.minScale, m_settings.maxScale);
+    m_level = std::clamp(m_level, minLevel(), maxLevel());
+}
+
+void ResolutionController::setScaleFloor(float scale) {
+    m_scaleFloor = std::max(0.0f, scale);
+    m_level = std::clamp(m_level, minLevel(), maxLevel());
+}
+
+float ResolutionController::getScale() const {
+    return m_settings.enabled ? levelScale(m_level) : 1.0f;
+}
+
+void ResolutionController::reset() {
+    m_averageMs = 0.0f;
+    m_samples = 0;
+    m_overFrames = 0;
+    m_underFrames = 0;
+    m_settleFrames = kSettleFrames;
+}
+
+bool ResolutionController::addFrame(float frameMs) {
+    if (!m_settings.enabled) return false;
+    if (m_settleFrames > 0) {
+        --m_settleFrames;
+        return false;
+    }
+
+    // Exponential moving average, seeded by the first samples so it settles quickly
+    ++m_samples;
+    float alpha = std::max(0.1f, 1.0f / (float)m_samples);
+    m_averageMs += (frameMs - m_averageMs) * alpha;
+    if (m_samples < 10) return false;
+
+    const float budget = m_settings.budgetMs;
+    const float stepRatio = std::pow(2.0f, 2.0f / kStepsPerOctave); // Particle count ratio per step
+
+    m_overFrames = m_averageMs > budget ? m_overFrames + 1 : 0;
+    m_underFrames = m_averageMs * stepRatio < budget * kUpHeadroom ? m_underFrames + 1 : 0;
+
+    int level = m_level;
+    if (m_overFrames >= kDownFrames) {
+        int steps = (int)std::ceil(std::log(m_averageMs / budget) / std::log(stepRatio));
+        level = m_level - std::max(1, steps);
+    } else if (m_underFrames >= kUpFrames) {
+        level = m_level + 1;
+    }
+    level = std::clamp(level, minLevel(), maxLevel());
+    if (level == m_level) {
+        // Pinned at a bound: keep measuring without piling up counts
+        m_overFrames = std::min(m_overFrames, kDownFrames);
+        m_underFrames = std::min(m_underFrames, kUpFrames);
+        return false;
+    }
+
+    m_level = level;
+    reset();
+    return true;
+}
+
+int ResolutionController::minLevel() const {
+    float minScale = std::max(m_settings.minScale, m_scaleFloor);
+    return (int)std::ceil(std::log2(minScale) * kStepsPerOctave - 1e-3f);
+}
+
+int ResolutionController::maxLevel() const {
+    return std::max(minLevel(), (int)std::floor(std::log2(m_settings.maxScale) * kStepsPerOctave + 1e-3f));
+}
+
+float ResolutionController::levelScale(int level) {
+    return std::pow(2.0f, (float)level / kStepsPerOctave);
+}
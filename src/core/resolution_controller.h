@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * @struct ResolutionSettings
+ * @brief Tuning of the dynamic resolution controller.
+ */
+struct ResolutionSettings {
+    bool enabled = false;
+    float budgetMs = 16.7f;  ///< Frame cost to stay under
+    float minScale = 0.5f;   ///< Smallest scale of the input mode's default grid
+    float maxScale = 2.0f;   ///< Largest scale of the input mode's default grid
+};
+
+/**
+ * @class ResolutionController
+ * @brief Picks the simulation grid scale that keeps the frame cost within a budget.
+ *
+ * The scale moves in discrete steps of 2^(1/4) on each axis, i.e. about 1.41x
+ * the particle count per step, so a step changes the cost by a predictable
+ * amount. The measured cost is smoothed and compared against the budget with
+ * hysteresis:
+ * - Over budget for kDownFrames frames: step down, several steps at once if the
+ *   overshoot is large (cost is assumed proportional to the particle count).
+ * - Below the budget even after a predicted step up (with kUpHeadroom to spare)
+ *   for kUpFrames frames: step up by one.
+ * After every change the controller waits kSettleFrames frames and restarts its
+ * average, so the one-off reallocation cost never triggers another change.
+ */
+class ResolutionController {
+public:
+    ResolutionController() = default;
+
+    void setSettings(const ResolutionSettings& settings);
+    const ResolutionSettings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief Records the cost of one frame.
+     *
+     * @param frameMs Time the frame spent working (CPU or GPU, whichever is longer), excluding vsync waits.
+     * @return true If the scale changed.
+     */
+    bool addFrame(float frameMs);
+
+    /**
+     * @brief Lowest scale the current input mode can still honor (0 = no limit).
+     *
+     * Raises the effective minimum above ResolutionSettings::minScale when the mode's
+     * grid stops shrinking sooner, so the controller never steps to scales that change nothing.
+     */
+    void setScaleFloor(float scale);
+    float getScaleFloor() const { return m_scaleFloor; }
+
+    /**
+     * @brief Current grid scale (1 = the input mode's default cap). Always 1 while disabled.
+     */
+    float getScale() const;
+
+    /**
+     * @brief Smoothed frame cost in milliseconds.
+     */
+    float getAverageMs() const { return m_averageMs; }
+
+    /**
+     * @brief Clears the measurement history (e.g. after the input changed).
+     */
+    void reset();
+
+    static constexpr int kStepsPerOctave = 4;   ///< Scale steps per doubling of the grid side
+    static constexpr int kDownFrames = 20;      ///< Frames over budget before stepping down
+    static constexpr int kUpFrames = 90;        ///< Frames with headroom before stepping up
+    static constexpr int kSettleFrames = 30;    ///< Frames ignored after a change
+    static constexpr float kUpHeadroom = 0.85f; ///< Predicted cost after a step up must stay below this share of the budget
+
+private:
+    int minLevel() const;
+    int maxLevel() const;
+    static float levelScale(int level);
+
+    ResolutionSettings m_settings;
+    float m_scaleFloor = 0.0f;
+    int m_level = 0;          ///< Scale = 2^(level / kStepsPerOctave)
+    float m_averageMs = 0.0f;
+    int m_samples = 0;        ///< Frames in the current average
+    int m_overFrames = 0;
+    int m_underFrames = 0;
+    int m_settleFrames = 0;
+};
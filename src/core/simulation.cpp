@@ -0,0 +1,54 @@
+#include "simulation.h"
+#include <chrono>
+
+void Simulation::reset(int width, int height) {
+    m_width = width;
+    m_height = height;
+    m_time = 0.0f;
+    initParticleGrid(m_particles, width, height);
+}
+
+void Simulation::resize(int width, int height) {
+    resampleParticleGrid(m_particles, m_width, m_height, m_resampled, width, height);
+    m_particles.swap(m_resampled);
+    m_width = width;
+    m_height = height;
+}
+
+void Simulation::setColors(const cv::Mat& image) {
+    if (image.empty() || m_particles.empty()) return;
+
+    const cv::Mat* grid = &image;
+    if (image.cols != m_width || image.rows != m_height) {
+        cv::resize(image, m_resizedColors, cv::Size(m_width, m_height));
+        grid = &m_resizedColors;
+    }
+    for (size_t i = 0; i < m_particles.size(); ++i) {
+        cv::Vec3b pixel = grid->at<cv::Vec3b>((int)(i / m_width), (int)(i % m_width));
+        m_particles[i].color = glm::vec4(pixel[2] / 255.0f, pixel[1] / 255.0f, pixel[0] / 255.0f, 1.0f);
+    }
+}
+
+bool Simulation::sortTo(const cv::Mat& source, const cv::Mat& target) {
+    auto start = std::chrono::steady_clock::now();
+    bool sorted = m_sorter.sortImage(source, target, m_width, m_height, m_mapping);
+    m_lastSortMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!sorted) return false;
+
+    setTargets(m_mapping);
+    return true;
+}
+
+void Simulation::setTargets(const std::vector<glm::vec2>& mapping) {
+    applyTargetMapping(m_particles, mapping, m_width, m_height);
+}
+
+void Simulation::step() {
+    m_time += kPhysicsTimeStep;
+    stepParticles(m_particles.data(), m_particles.size(), m_time, m_params);
+}
+
+void Simulation::returnToGrid() {
+    resetParticlePositions(m_particles, m_width, m_height);
+    m_time = 0.0f;
+}
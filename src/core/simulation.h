@@ -0,0 +1,94 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "particle.h"
+#include "physics.h"
+#include "sorter.h"
+
+/**
+ * @class Simulation
+ * @brief One particle transform (grid, sort and physics), with no window or GL.
+ *
+ * The entry point of lumasort_core for programs that don't render through the
+ * app, such as the headless runner: lay out a grid, color it from a source,
+ * sort it onto a target, then step it. Rendering reads getParticles().
+ * Buffers are reused, so repeated sorts and steps at one grid size don't allocate.
+ *
+ * @code
+ * Simulation simulation;
+ * simulation.reset(width, height);
+ * simulation.setColors(source);
+ * if (simulation.sortTo(source, target)) {
+ *     for (int i = 0; i < frames; ++i) simulation.step();
+ * }
+ * @endcode
+ */
+class Simulation {
+public:
+    Simulation() = default;
+
+    /**
+     * @brief Lays out width x height particles at rest on their grid, white, targeting their own cell.
+     */
+    void reset(int width, int height);
+
+    /**
+     * @brief Changes the grid size, keeping the cloud's positions and motion (see resampleParticleGrid()).
+     *
+     * Colors and targets are reset; call setColors() and sortTo() again.
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Colors particles from a BGR image, resized to the grid if needed.
+     */
+    void setColors(const cv::Mat& image);
+
+    /**
+     * @brief Sorts @p source onto @p target and sets every particle's target.
+     *
+     * @return false If the sort produced no mapping (e.g. an empty image).
+     */
+    bool sortTo(const cv::Mat& source, const cv::Mat& target);
+
+    /**
+     * @brief Sets targets from a mapping computed elsewhere (e.g. on a worker thread).
+     */
+    void setTargets(const std::vector<glm::vec2>& mapping);
+
+    /**
+     * @brief Advances the simulation by one physics step of kPhysicsTimeStep.
+     */
+    void step();
+
+    /**
+     * @brief Puts every particle back on its grid cell, at rest. Time is reset.
+     */
+    void returnToGrid();
+
+    void setParams(const PhysicsParams& params) { m_params = params; }
+    const PhysicsParams& getParams() const { return m_params; }
+
+    const std::vector<Particle>& getParticles() const { return m_particles; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    float getTime() const { return m_time; }
+
+    /**
+     * @brief Duration of the last sortTo(), in milliseconds.
+     */
+    float getLastSortMs() const { return m_lastSortMs; }
+
+private:
+    Sorter m_sorter;
+    std::vector<Particle> m_particles;
+    std::vector<Particle> m_resampled;   ///< Previous buffer from resize(), kept for its capacity
+    std::vector<glm::vec2> m_mapping;    ///< Last sortTo() result
+    cv::Mat m_resizedColors;             ///< setColors() source resized to the grid
+    PhysicsParams m_params;
+    int m_width = 0;
+    int m_height = 0;
+    float m_time = 0.0f;
+    float m_lastSortMs = 0.0f;
+};
@@ -1,4 +1,5 @@
 #include "sorter.h"
+#include "cpu_profiler.h"
 #include <algorithm>
 #include <iostream>
 
@@ -14,54 +15,105 @@ float Sorter::getLuminance(const cv::Vec3b& color) {
 
 std::vector<glm::vec2> Sorter::sortImage(const cv::Mat& input, const cv::Mat& target, int simulationWidth, int simulationHeight) {
     std::vector<glm::vec2> mapping;
-    
+    sortImage(input, target, simulationWidth, simulationHeight, mapping);
+    return mapping;
+}
+
+bool Sorter::sortImage(const cv::Mat& input, const cv::Mat& target, int simulationWidth, int simulationHeight, std::vector<glm::vec2>& mapping) {
+    PROFILE_SCOPE("Sort");
     if (input.empty() || target.empty()) {
         std::cerr << "Sorter::sortImage: Empty input or target!" << std::endl;
-        return mapping;
+        mapping.clear();
+        return false;
     }
 
-    // 1. Resize images to simulation grid
-    cv::Mat resInput, resTarget;
-    cv::resize(input, resInput, cv::Size(simulationWidth, simulationHeight));
-    cv::resize(target, resTarget, cv::Size(simulationWidth, simulationHeight));
+    // 1. Resize input to simulation grid
+    cv::resize(input, m_resizedInput, cv::Size(simulationWidth, simulationHeight));
 
-    // 2. Flatten and store PixelInfo
-    int numPixels = simulationWidth * simulationHeight;
-    std::vector<PixelInfo> inputPixels;
-    std::vector<PixelInfo> targetPixels;
-    inputPixels.reserve(numPixels);
-    targetPixels.reserve(numPixels);
+    // 2. Flatten and store PixelInfo (capacity is kept from the last sort)
+    m_inputPixels.clear();
+    m_inputPixels.reserve(simulationWidth * simulationHeight);
+
+    for (int y = 0; y < simulationHeight; ++y) {
+        for (int x = 0; x < simulationWidth; ++x) {
+            cv::Vec3b inColor = m_resizedInput.at<cv::Vec3b>(y, x);
+            m_inputPixels.push_back({ getLuminance(inColor), x, y });
+        }
+    }
+
+    mapToTarget(target, simulationWidth, simulationHeight, mapping);
+    return true;
+}
+
+std::vector<glm::vec2> Sorter::sortLuma(const cv::Mat& luma, const cv::Mat& target, int simulationWidth, int simulationHeight) {
+    std::vector<glm::vec2> mapping;
+    sortLuma(luma, target, simulationWidth, simulationHeight, mapping);
+    return mapping;
+}
+
+bool Sorter::sortLuma(const cv::Mat& luma, const cv::Mat& target, int simulationWidth, int simulationHeight, std::vector<glm::vec2>& mapping) {
+    PROFILE_SCOPE("Sort (Luma)");
+    if (luma.empty() || target.empty() || luma.type() != CV_8UC1) {
+        std::cerr << "Sorter::sortLuma: Empty or non-luma input, or empty target!" << std::endl;
+        mapping.clear();
+        return false;
+    }
+
+    // 1. Resize the luma plane to simulation grid (single channel; skipped if already there)
+    const cv::Mat* resLuma = &luma;
+    if (luma.cols != simulationWidth || luma.rows != simulationHeight) {
+        cv::resize(luma, m_resizedInput, cv::Size(simulationWidth, simulationHeight), 0, 0, cv::INTER_AREA);
+        resLuma = &m_resizedInput;
+    }
+
+    // 2. The Y sample is the key
+    m_inputPixels.clear();
+    m_inputPixels.reserve(simulationWidth * simulationHeight);
 
     for (int y = 0; y < simulationHeight; ++y) {
+        const uchar* row = resLuma->ptr<uchar>(y);
         for (int x = 0; x < simulationWidth; ++x) {
-            // Input
-            cv::Vec3b inColor = resInput.at<cv::Vec3b>(y, x);
-            inputPixels.push_back({ getLuminance(inColor), x, y });
+            m_inputPixels.push_back({ (float)row[x], x, y });
+        }
+    }
+
+    mapToTarget(target, simulationWidth, simulationHeight, mapping);
+    return true;
+}
+
+void Sorter::mapToTarget(const cv::Mat& target, int simulationWidth, int simulationHeight, std::vector<glm::vec2>& mapping) {
+    // 1. Resize target to simulation grid and flatten
+    cv::resize(target, m_resizedTarget, cv::Size(simulationWidth, simulationHeight));
+
+    int numPixels = simulationWidth * simulationHeight;
+    m_targetPixels.clear();
+    m_targetPixels.reserve(numPixels);
 
-            // Target
-            cv::Vec3b tgtColor = resTarget.at<cv::Vec3b>(y, x);
-            targetPixels.push_back({ getLuminance(tgtColor), x, y });
+    for (int y = 0; y < simulationHeight; ++y) {
+        for (int x = 0; x < simulationWidth; ++x) {
+            cv::Vec3b tgtColor = m_resizedTarget.at<cv::Vec3b>(y, x);
+            m_targetPixels.push_back({ getLuminance(tgtColor), x, y });
         }
     }
 
-    // 3. Sort both arrays based on luminance
+    // 2. Sort both arrays based on luminance
     auto comparator = [](const PixelInfo& a, const PixelInfo& b) {
         return a.luminance < b.luminance;
     };
 
-    std::sort(inputPixels.begin(), inputPixels.end(), comparator);
-    std::sort(targetPixels.begin(), targetPixels.end(), comparator);
+    std::sort(m_inputPixels.begin(), m_inputPixels.end(), comparator);
+    std::sort(m_targetPixels.begin(), m_targetPixels.end(), comparator);
 
-    // 4. Create Mapping
+    // 3. Create Mapping
     // inputPixels[k] corresponds to targetPixels[k]
     // mapping[original_input_index] = target_pos
     
-    // Resize mapping to size needed
+    // Resize mapping to size needed (no allocation if the caller's vector is already big enough)
     mapping.resize(numPixels);
 
     for (int k = 0; k < numPixels; ++k) {
-        const PixelInfo& inPix = inputPixels[k];
-        const PixelInfo& tgtPix = targetPixels[k];
+        const PixelInfo& inPix = m_inputPixels[k];
+        const PixelInfo& tgtPix = m_targetPixels[k];
 
         // Original index in the flattened array
         int originalIndex = inPix.original_y * simulationWidth + inPix.original_x;
@@ -69,6 +121,4 @@ std::vector<glm::vec2> Sorter::sortImage(const cv::Mat& input, const cv::Mat& ta
         // Assign the target position
         mapping[originalIndex] = glm::vec2(tgtPix.original_x, tgtPix.original_y);
     }
-
-    return mapping;
 }
@@ -19,6 +19,9 @@ struct PixelInfo {
  * @brief Core logic for the Pixel Sorting algorithm.
  * 
  * Analyzes input and target images to create a mapping based on luminance.
+ * 
+ * The resized images and pixel lists are kept between sorts, so sorting again at
+ * the same grid size allocates nothing when the caller also reuses its mapping.
  */
 class Sorter {
 public:
@@ -36,9 +39,51 @@ public:
      */
     std::vector<glm::vec2> sortImage(const cv::Mat& input, const cv::Mat& target, int simulationWidth = 256, int simulationHeight = 256);
 
+    /**
+     * @brief Same as sortImage(), writing into a caller-owned mapping whose capacity is reused.
+     * 
+     * @param mapping Resized to simulationWidth * simulationHeight and overwritten.
+     * @return false If the input or target is empty (the mapping is then empty).
+     */
+    bool sortImage(const cv::Mat& input, const cv::Mat& target, int simulationWidth, int simulationHeight, std::vector<glm::vec2>& mapping);
+
+    /**
+     * @brief Same as sortImage(), but keyed on an already extracted luma plane.
+     * 
+     * Used by YUV-native sources: the Y plane is the sort key as-is, so the input
+     * needs neither a BGR conversion nor a per-pixel luminance pass. The ordering
+     * only approximates sortImage() on the converted frame: Y uses the encoder's
+     * matrix (often BT.709) rather than getLuminance()'s coefficients, and the BGR
+     * round trip clamps and rounds, so strongly chromatic pixels can swap places.
+     * The limited range (16-235) itself doesn't matter; only the key order does.
+     * 
+     * @param luma Input luma plane (CV_8UC1), any size.
+     * @param target The destination image (BGR).
+     * @param simulationWidth Width of the simulation grid.
+     * @param simulationHeight Height of the simulation grid.
+     * @return std::vector<glm::vec2> Mapping table, as for sortImage().
+     */
+    std::vector<glm::vec2> sortLuma(const cv::Mat& luma, const cv::Mat& target, int simulationWidth = 256, int simulationHeight = 256);
+
+    /**
+     * @brief Same as sortLuma(), writing into a caller-owned mapping whose capacity is reused.
+     */
+    bool sortLuma(const cv::Mat& luma, const cv::Mat& target, int simulationWidth, int simulationHeight, std::vector<glm::vec2>& mapping);
+
 private:
+    /**
+     * @brief Sorts the target by luminance and pairs it with the keyed input pixels in m_inputPixels.
+     */
+    void mapToTarget(const cv::Mat& target, int simulationWidth, int simulationHeight, std::vector<glm::vec2>& mapping);
+
     /**
      * @brief Helper to calculate luminance of a pixel.
      */
     float getLuminance(const cv::Vec3b& color);
+
+    // Scratch reused across sorts
+    cv::Mat m_resizedInput;
+    cv::Mat m_resizedTarget;
+    std::vector<PixelInfo> m_inputPixels;
+    std::vector<PixelInfo> m_targetPixels;
 };
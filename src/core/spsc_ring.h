@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class SpscRing
+ * @brief Fixed-capacity lock-free single-producer/single-consumer ring.
+ *
+ * Slots are allocated once and reused, so elements that own buffers (e.g. cv::Mat)
+ * keep their allocations across laps. The producer fills a slot in place between
+ * beginWrite() and commitWrite(); the consumer reads one in place between
+ * beginRead() and endRead(). Exactly one thread may produce and one may consume.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : m_slots(capacity + 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Producer: returns the next free slot, or nullptr if the ring is full.
+     */
+    T* beginWrite() {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (next(head) == m_tail.load(std::memory_order_acquire)) return nullptr;
+        return &m_slots[head];
+    }
+
+    /**
+     * @brief Producer: publishes the slot returned by beginWrite().
+     */
+    void commitWrite() {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        m_head.store(next(head), std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer: returns the oldest published slot, or nullptr if empty.
+     */
+    T* beginRead() {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) return nullptr;
+        return &m_slots[tail];
+    }
+
+    /**
+     * @brief Consumer: releases the slot returned by beginRead() back to the producer.
+     */
+    void endRead() {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        m_tail.store(next(tail), std::memory_order_release);
+    }
+
+    /**
+     * @brief Number of published, unread slots (approximate while the other side runs).
+     */
+    size_t size() const {
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        return head >= tail ? head - tail : head + m_slots.size() - tail;
+    }
+
+    size_t capacity() const { return m_slots.size() - 1; }
+
+    /**
+     * @brief Producer: calls @p visit on every slot (e.g. to preallocate it) if the ring is empty.
+     *
+     * An empty ring means the consumer has released every slot and can't get one
+     * before the next commitWrite(), so this is safe while the consumer runs.
+     * @return false, visiting nothing, if published slots are still unread.
+     */
+    template <typename Visit>
+    bool forEachSlot(Visit&& visit) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_tail.load(std::memory_order_acquire) != head) return false;
+        for (T& slot : m_slots) {
+            visit(slot);
+        }
+        return true;
+    }
+
+private:
+    size_t next(size_t index) const { return index + 1 == m_slots.size() ? 0 : index + 1; }
+
+    std::vector<T> m_slots; ///< One slot is always kept empty to tell full from empty
+    alignas(64) std::atomic<size_t> m_head{ 0 }; ///< Written by the producer
+    alignas(64) std::atomic<size_t> m_tail{ 0 }; ///< Written by the consumer
+};
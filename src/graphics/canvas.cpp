@@ -1,21 +1,37 @@
 #include "canvas.h"
+#include "program_cache.h"
+#include "shader_sources.h"
+#include "../core/cpu_profiler.h"
 #include <iostream>
 #include <vector>
+#include <array>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
 
 Canvas::Canvas(int width, int height)
     : m_width(width), m_height(height), m_fbo(0), m_lineVAO(0), m_lineVBO(0), m_shaderProgram(0)
 {
     initGL();
     initShader();
-    clear(); // Start black
+    clear(); // Start white (also initializes the CPU shadow copy)
 }
 
 Canvas::~Canvas() {
+    discardReadbacks();
+    for (auto& readback : m_readbacks) {
+        if (readback.pbo) glDeleteBuffers(1, &readback.pbo);
+    }
+    if (m_snapshot.fence) glDeleteSync(m_snapshot.fence);
+    if (m_snapshot.pbo) glDeleteBuffers(1, &m_snapshot.pbo);
     if (m_fbo) glDeleteFramebuffers(1, &m_fbo);
     if (m_lineVAO) glDeleteVertexArrays(1, &m_lineVAO);
     if (m_lineVBO) glDeleteBuffers(1, &m_lineVBO);
     if (m_shaderProgram) glDeleteProgram(m_shaderProgram);
+    if (m_downsampleProgram) glDeleteProgram(m_downsampleProgram);
+    if (m_downFbo) glDeleteFramebuffers(1, &m_downFbo);
+    if (m_emptyVAO) glDeleteVertexArrays(1, &m_emptyVAO);
 }
 
 void Canvas::initGL() {
@@ -39,77 +55,40 @@ void Canvas::initGL() {
 
     glBindVertexArray(m_lineVAO);
     glBindBuffer(GL_ARRAY_BUFFER, m_lineVBO);
-    glBufferData(GL_ARRAY_BUFFER, 2 * sizeof(glm::vec2), nullptr, GL_DYNAMIC_DRAW);
+    m_lineVBOCapacity = 2 * sizeof(glm::vec2);
+    glBufferData(GL_ARRAY_BUFFER, m_lineVBOCapacity, nullptr, GL_DYNAMIC_DRAW);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+
+    // 4. Attribute-less VAO for the downsample pass (core profile requires one bound)
+    glGenVertexArrays(1, &m_emptyVAO);
+
+    // Readback defaults to the full canvas resolution
+    m_readWidth = m_width;
+    m_readHeight = m_height;
 }
 
 void Canvas::initShader() {
-    const char* vertexSrc = R"(
-        #version 330 core
-        layout (location = 0) in vec2 aPos;
-        uniform vec2 uResolution;
-        void main() {
-            vec2 zeroOne = aPos / uResolution;
-            vec2 zeroTwo = zeroOne * 2.0;
-            vec2 clipSpace = zeroTwo - 1.0;
-            gl_Position = vec4(clipSpace.x, -clipSpace.y, 0.0, 1.0);
-        }
-    )";
-
-    const char* fragmentSrc = R"(
-        #version 330 core
-        uniform vec3 uColor;
-        out vec4 FragColor;
-        void main() {
-            FragColor = vec4(uColor, 1.0);
-        }
-    )";
-
-    auto compile = [](GLenum type, const char* src) {
-        unsigned int id = glCreateShader(type);
-        glShaderSource(id, 1, &src, nullptr);
-        glCompileShader(id);
-        int success;
-        glGetShaderiv(id, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetShaderInfoLog(id, 512, nullptr, infoLog);
-            std::cerr << "Shader Compile Error: " << infoLog << std::endl;
-        }
-        return id;
-    };
+    m_shaderProgram = Graphics::ProgramCache::getProgram("canvas_line", Shaders::kCanvasLineVert, Shaders::kCanvasLineFrag);
 
-    unsigned int vs = compile(GL_VERTEX_SHADER, vertexSrc);
-    unsigned int fs = compile(GL_FRAGMENT_SHADER, fragmentSrc);
+    // Cache uniform locations once instead of per stroke
+    m_resolutionLoc = glGetUniformLocation(m_shaderProgram, "uResolution");
+    m_colorLoc = glGetUniformLocation(m_shaderProgram, "uColor");
 
-    m_shaderProgram = glCreateProgram();
-    glAttachShader(m_shaderProgram, vs);
-    glAttachShader(m_shaderProgram, fs);
-    glLinkProgram(m_shaderProgram);
-    
-    int success;
-    glGetProgramiv(m_shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(m_shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "Program Link Error: " << infoLog << std::endl;
-    }
-
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    // Area-filter downsample, drawn as the same fullscreen triangle as the particle resolve
+    m_downsampleProgram = Graphics::ProgramCache::getProgram("downsample", Shaders::kResolveVert, Shaders::kDownsampleFrag);
+    m_downsampleRatioLoc = glGetUniformLocation(m_downsampleProgram, "uRatio");
+    glUseProgram(m_downsampleProgram);
+    glUniform1i(glGetUniformLocation(m_downsampleProgram, "uCanvas"), 0);
+    glUseProgram(0);
 }
 
 void Canvas::clear() {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-    glViewport(0, 0, m_width, m_height);
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    fill(glm::vec3(1.0f));
 }
 
 void Canvas::fill(glm::vec3 color) {
@@ -118,48 +97,147 @@ void Canvas::fill(glm::vec3 color) {
     glClearColor(color.r, color.g, color.b, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    ++m_generation;
+
+    // A solid fill is known on the CPU without reading anything back.
+    // In-flight readbacks predate the fill and must not overwrite it.
+    discardReadbacks();
+    m_shadow.create(m_readHeight, m_readWidth, CV_8UC3);
+    m_shadow.setTo(cv::Scalar(color.b * 255.0f, color.g * 255.0f, color.r * 255.0f));
+    m_shadowGeneration = m_generation;
+    m_dirtyRect = cv::Rect();
 }
 
+/**
+ * @brief Draws a brush stroke segment as a single batched draw call.
+ * 
+ * The stroke is built from dabs spaced at 30% of the brush size. Each dab is a
+ * star of 4 diameters (8 half-turn lines, matching the original look), and every
+ * dab of the segment is tessellated into one GL_LINES vertex batch that is
+ * uploaded and drawn once, instead of one upload + draw per line.
+ */
 void Canvas::drawLine(glm::vec2 start, glm::vec2 end, glm::vec3 color, float brushSize) {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
-    glViewport(0, 0, m_width, m_height);
-    
-    glUseProgram(m_shaderProgram);
-    
-    int resLoc = glGetUniformLocation(m_shaderProgram, "uResolution");
-    glUniform2f(resLoc, (float)m_width, (float)m_height);
-    
-    int colorLoc = glGetUniformLocation(m_shaderProgram, "uColor");
-    glUniform3f(colorLoc, color.r, color.g, color.b);
+    m_strokeVertices.clear();
+    int dabs = appendSegment(start, end, brushSize);
+    submitStroke(color, dabs);
+}
+
+/**
+ * @brief Draws a whole polyline in one draw call.
+ * 
+ * Produces exactly the pixels of drawLine(p0, p0) followed by drawLine(p[i-1], p[i])
+ * for every point (how strokes are drawn live), but as a single batch. Used to
+ * replay recorded strokes.
+ */
+void Canvas::drawPolyline(const std::vector<glm::vec2>& points, glm::vec3 color, float brushSize) {
+    if (points.empty()) return;
+
+    m_strokeVertices.clear();
+    int dabs = appendSegment(points[0], points[0], brushSize);
+    for (size_t i = 1; i < points.size(); ++i) {
+        dabs += appendSegment(points[i - 1], points[i], brushSize);
+    }
+    submitStroke(color, dabs);
+}
+
+int Canvas::appendSegment(glm::vec2 start, glm::vec2 end, float brushSize) {
+    // Unit offsets for the 8 lines of a dab (angle k * 45 degrees and its opposite)
+    static const std::array<glm::vec2, 8> kDabDirections = [] {
+        std::array<glm::vec2, 8> dirs;
+        for (int angle = 0; angle < 8; ++angle) {
+            float rad = (float)angle * 3.14159f / 4.0f;
+            dirs[angle] = glm::vec2(cos(rad), sin(rad));
+        }
+        return dirs;
+    }();
 
     // Draw smooth line by interpolating points along the path
     float dist = glm::length(end - start);
     int steps = std::max(1, (int)(dist / (brushSize * 0.3f)));
+    float halfSize = brushSize * 0.5f;
+
+    m_strokeVertices.reserve(m_strokeVertices.size() + (size_t)(steps + 1) * kDabDirections.size() * 2);
     
     for (int i = 0; i <= steps; ++i) {
         float t = (steps > 0) ? (float)i / (float)steps : 0.0f;
         glm::vec2 pos = start + t * (end - start);
         
         // Draw a point by drawing multiple lines in a circle pattern
-        for (int angle = 0; angle < 8; ++angle) {
-            float rad = (float)angle * 3.14159f / 4.0f;
-            float halfSize = brushSize * 0.5f;
-            glm::vec2 offset1(cos(rad) * halfSize, sin(rad) * halfSize);
-            glm::vec2 offset2(cos(rad + 3.14159f) * halfSize, sin(rad + 3.14159f) * halfSize);
-            
-            glm::vec2 verts[2] = { pos + offset1, pos + offset2 };
-            
-            glBindVertexArray(m_lineVAO);
-            glBindBuffer(GL_ARRAY_BUFFER, m_lineVBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
-            
-            glLineWidth(2.0f);
-            glDrawArrays(GL_LINES, 0, 2);
+        for (const glm::vec2& dir : kDabDirections) {
+            glm::vec2 offset = dir * halfSize;
+            m_strokeVertices.push_back(pos + offset);
+            m_strokeVertices.push_back(pos - offset);
         }
     }
+
+    // Expand the dirty region by the segment bounds (dab radius + line width margin)
+    float margin = halfSize + 2.0f;
+    int x0 = (int)std::floor(std::min(start.x, end.x) - margin);
+    int y0 = (int)std::floor(std::min(start.y, end.y) - margin);
+    int x1 = (int)std::ceil(std::max(start.x, end.x) + margin);
+    int y1 = (int)std::ceil(std::max(start.y, end.y) + margin);
+    cv::Rect strokeRect = cv::Rect(x0, y0, x1 - x0, y1 - y0) & cv::Rect(0, 0, m_width, m_height);
+    m_dirtyRect = m_dirtyRect.empty() ? strokeRect : (m_dirtyRect | strokeRect);
+
+    return steps + 1;
+}
+
+void Canvas::submitStroke(glm::vec3 color, int dabs) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_width, m_height);
+    
+    glUseProgram(m_shaderProgram);
+    glUniform2f(m_resolutionLoc, (float)m_width, (float)m_height);
+    glUniform3f(m_colorLoc, color.r, color.g, color.b);
+
+    glBindVertexArray(m_lineVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_lineVBO);
+
+    // Grow the VBO only when the batch outgrows it; otherwise update in place
+    size_t bytes = m_strokeVertices.size() * sizeof(glm::vec2);
+    if (bytes > m_lineVBOCapacity) {
+        glBufferData(GL_ARRAY_BUFFER, bytes, m_strokeVertices.data(), GL_DYNAMIC_DRAW);
+        m_lineVBOCapacity = bytes;
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, m_strokeVertices.data());
+    }
+
+    glLineWidth(2.0f);
+    glDrawArrays(GL_LINES, 0, (GLsizei)m_strokeVertices.size());
+
+    m_lastStrokeStats.dabs = dabs;
+    m_lastStrokeStats.vertices = (int)m_strokeVertices.size();
+    m_lastStrokeStats.drawCalls = 1;
     
     glBindVertexArray(0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    ++m_generation;
+}
+
+/**
+ * @brief Replaces the canvas contents with an image.
+ * 
+ * @param image BGR image of exactly the canvas size (top-left origin).
+ */
+void Canvas::loadFromMat(const cv::Mat& image) {
+    if (image.empty() || image.cols != m_width || image.rows != m_height || image.type() != CV_8UC3) {
+        std::cerr << "Canvas::loadFromMat: Image does not match the canvas size/format!" << std::endl;
+        return;
+    }
+
+    // Texture rows are bottom-up
+    cv::flip(image, m_uploadScratch, 0);
+
+    glBindTexture(GL_TEXTURE_2D, m_texture.getID());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, GL_BGR, GL_UNSIGNED_BYTE, m_uploadScratch.data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    ++m_generation;
+    m_dirtyRect = cv::Rect(0, 0, m_width, m_height);
 }
 
 /**
@@ -168,14 +246,14 @@ void Canvas::drawLine(glm::vec2 start, glm::vec2 end, glm::vec3 color, float bru
  * Captures the current FBO contents and returns them as a BGR OpenCV matrix.
  * Handles pixel alignment to prevent stride artifacts on certain GPUs.
  * 
- * @return cv::Mat BGR image of the canvas contents.
+ * @param result Receives the BGR image of the canvas contents (its buffer is reused when it fits).
  * 
  * @note The image is flipped vertically to match OpenCV's top-left origin
  *       convention (OpenGL uses bottom-left origin).
  * @note GL_PACK_ALIGNMENT is set to 1 to match OpenCV's tight packing.
  */
-cv::Mat Canvas::getAsMat() const {
-    cv::Mat result(m_height, m_width, CV_8UC3);
+void Canvas::getAsMat(cv::Mat& result) const {
+    result.create(m_height, m_width, CV_8UC3);
 
     // Set pack alignment to 1 byte to match OpenCV's tightly-packed layout.
     // Prevents stride artifacts when reading pixels back to CPU.
@@ -190,6 +268,393 @@ cv::Mat Canvas::getAsMat() const {
 
     // Flip vertically because OpenGL origin is bottom-left
     cv::flip(result, result, 0);
+}
+
+/**
+ * @brief Span-based scanline flood fill with tolerance.
+ * 
+ * Works on a full-resolution CPU copy of the canvas kept in GL row order
+ * (bottom-up). The copy is only refreshed when something other than a fill has
+ * changed the canvas since the last fill: from the readback shadow when it is
+ * full resolution and current, otherwise with a blocking whole-canvas glReadPixels. Spans are filled with an
+ * explicit stack (no recursion), testing each pixel a small constant number of
+ * times. Only the filled bounding box is uploaded back with glTexSubImage2D.
+ * 
+ * @param seed Start position in canvas pixels (top-left origin).
+ * @param color Fill color (0-1 range).
+ * @param tolerance Max per-channel difference (0-255) from the seed color.
+ * @return bool true if any pixel was filled.
+ */
+bool Canvas::floodFill(glm::vec2 seed, glm::vec3 color, int tolerance) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    int sx = (int)seed.x;
+    int sy = m_height - 1 - (int)seed.y; // GL row order
+    if (sx < 0 || sx >= m_width || sy < 0 || sy >= m_height) return false;
+
+    // Refresh the CPU copy only if strokes/fills happened outside of floodFill
+    bool stale = m_fillImageGeneration != m_generation || m_fillImage.empty();
+    bool fromShadow = stale && !isDownsampling() && m_shadowGeneration == m_generation;
+    bool reread = stale && !fromShadow;
+    if (fromShadow) {
+        // The async readback already holds these pixels (top-down): no GPU round trip
+        PROFILE_SCOPE("Fill Copy From Shadow");
+        cv::flip(m_shadow, m_fillImage, 0);
+    } else if (reread) {
+        // Stalls until the GPU has drawn every queued stroke
+        PROFILE_SCOPE("Fill Readback (Sync)");
+        m_fillImage.create(m_height, m_width, CV_8UC3);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+        glReadPixels(0, 0, m_width, m_height, GL_BGR, GL_UNSIGNED_BYTE, m_fillImage.data);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    }
+
+    const cv::Vec3b seedColor = m_fillImage.at<cv::Vec3b>(sy, sx);
+    const cv::Vec3b fillColor((uchar)(color.b * 255.0f), (uchar)(color.g * 255.0f), (uchar)(color.r * 255.0f));
+
+    // Per-channel range test as a single unsigned compare: |p - seed| <= tolerance
+    const int lo0 = seedColor[0] - tolerance;
+    const int lo1 = seedColor[1] - tolerance;
+    const int lo2 = seedColor[2] - tolerance;
+    const unsigned range = (unsigned)(2 * tolerance);
+    auto inRange = [=](const uchar* p) {
+        return (unsigned)(p[0] - lo0) <= range && (unsigned)(p[1] - lo1) <= range && (unsigned)(p[2] - lo2) <= range;
+    };
+
+    // Painted pixels normally stop matching on their own. Only when the fill color is
+    // itself within tolerance do we need a visited mask to guarantee termination.
+    const bool useMask = inRange(fillColor.val);
+    if (useMask) {
+        m_fillMask.create(m_height, m_width, CV_8UC1);
+        m_fillMask.setTo(cv::Scalar(0));
+    }
+
+    uchar* pixels = m_fillImage.data;
+    uchar* visited = useMask ? m_fillMask.data : nullptr;
+    const size_t rowStep = m_fillImage.step;
+    const int width = m_width;
+
+    auto inside = [=](int x, int y) {
+        if (visited && visited[(size_t)y * width + x]) return false;
+        return inRange(pixels + y * rowStep + x * 3);
+    };
+    auto paint = [=](int x, int y) {
+        uchar* p = pixels + y * rowStep + x * 3;
+        p[0] = fillColor[0];
+        p[1] = fillColor[1];
+        p[2] = fillColor[2];
+        if (visited) visited[(size_t)y * width + x] = 1;
+    };
+
+    int minX = sx, maxX = sx, minY = sy, maxY = sy;
+    int filled = 0;
+
+    // Heckbert's span seed fill: each stack entry is a span [left, right] on row y
+    // whose neighbours on row y + dy still need scanning. Spans that leak past the
+    // parent's ends are pushed back in the opposite direction.
+    m_fillStack.clear();
+    auto push = [&](int y, int left, int right, int dy) {
+        if (y + dy >= 0 && y + dy < m_height) m_fillStack.push_back({ y, left, right, dy });
+    };
+    push(sy, sx, sx, 1);
+    push(sy + 1, sx, sx, -1);
+
+    while (!m_fillStack.empty()) {
+        FillSpan span = m_fillStack.back();
+        m_fillStack.pop_back();
 
-    return result;
+        int y = span.y + span.dy;
+        int x = span.left;
+        int left;
+
+        // Extend left from the parent's left end
+        for (; x >= 0 && inside(x, y); --x) paint(x, y);
+        bool skip = x >= span.left;
+        if (!skip) {
+            left = x + 1;
+            if (left < span.left) push(y, left, span.left - 1, -span.dy); // Leak on the left
+            x = span.left + 1;
+        }
+
+        do {
+            if (!skip) {
+                // Extend right, emit the run as a new span
+                for (; x < m_width && inside(x, y); ++x) paint(x, y);
+                push(y, left, x - 1, span.dy);
+                if (x > span.right + 1) push(y, span.right + 1, x - 1, -span.dy); // Leak on the right
+
+                filled += x - left;
+                minX = std::min(minX, left);
+                maxX = std::max(maxX, x - 1);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
+            skip = false;
+
+            // Skip non-matching pixels up to the next run within the parent span
+            for (++x; x <= span.right && !inside(x, y); ++x) {}
+            left = x;
+        } while (x <= span.right);
+    }
+
+    if (filled == 0) return false;
+
+    // Upload only the filled bounding box (image rows are already in GL order)
+    int boxWidth = maxX - minX + 1;
+    int boxHeight = maxY - minY + 1;
+    glBindTexture(GL_TEXTURE_2D, m_texture.getID());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_width);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, minX, minY, boxWidth, boxHeight, GL_BGR, GL_UNSIGNED_BYTE,
+                    m_fillImage.ptr<cv::Vec3b>(minY) + minX);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    ++m_generation;
+    m_fillImageGeneration = m_generation;
+
+    // Let the async readback refresh the shadow over the filled region (top-left coords)
+    cv::Rect fillRect(minX, m_height - 1 - maxY, boxWidth, boxHeight);
+    m_dirtyRect = m_dirtyRect.empty() ? fillRect : (m_dirtyRect | fillRect);
+
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    m_lastFillStats.milliseconds = elapsed.count();
+    m_lastFillStats.pixels = filled;
+    m_lastFillStats.uploadedPixels = boxWidth * boxHeight;
+    m_lastFillStats.reread = reread;
+    m_lastFillStats.fromShadow = fromShadow;
+    return true;
+}
+
+/**
+ * @brief Queues an asynchronous readback of the dirty region.
+ * 
+ * Reads the dirty rectangle into the next free pixel buffer object and drops a
+ * fence behind it. glReadPixels into a bound GL_PIXEL_PACK_BUFFER returns
+ * immediately; the copy completes on the GPU timeline. If both PBOs are still
+ * in flight the request is deferred and the dirty region keeps accumulating.
+ */
+void Canvas::requestReadback() {
+    if (m_dirtyRect.empty()) return;
+
+    PendingReadback& readback = m_readbacks[m_nextReadback];
+    if (readback.fence) return; // Both buffers busy; try again next frame
+
+    // Map the dirty region from canvas to readback resolution (grow to whole pixels)
+    bool downsampling = isDownsampling();
+    cv::Rect rect = m_dirtyRect;
+    if (downsampling) {
+        float sx = (float)m_readWidth / (float)m_width;
+        float sy = (float)m_readHeight / (float)m_height;
+        int x0 = (int)std::floor(m_dirtyRect.x * sx);
+        int y0 = (int)std::floor(m_dirtyRect.y * sy);
+        int x1 = (int)std::ceil((m_dirtyRect.x + m_dirtyRect.width) * sx);
+        int y1 = (int)std::ceil((m_dirtyRect.y + m_dirtyRect.height) * sy);
+        rect = cv::Rect(x0, y0, x1 - x0, y1 - y0) & cv::Rect(0, 0, m_readWidth, m_readHeight);
+        if (rect.empty()) {
+            m_dirtyRect = cv::Rect();
+            return;
+        }
+        downsample(rect);
+    }
+
+    size_t rowBytes = (size_t)rect.width * 3;
+    size_t bytes = rowBytes * rect.height;
+
+    if (!readback.pbo) glGenBuffers(1, &readback.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    if (bytes > readback.capacity) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        readback.capacity = bytes;
+    }
+
+    // Set pack alignment to 1 byte to match OpenCV's tightly-packed layout.
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    // Dirty rect is in top-left image coordinates; GL origin is bottom-left
+    glBindFramebuffer(GL_FRAMEBUFFER, downsampling ? m_downFbo : m_fbo);
+    glReadPixels(rect.x, m_readHeight - (rect.y + rect.height), rect.width, rect.height,
+                 GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.rect = rect;
+    readback.generation = m_generation;
+
+    m_dirtyRect = cv::Rect();
+    m_nextReadback = (m_nextReadback + 1) % (int)m_readbacks.size();
+    m_lastReadbackBytes = bytes;
+}
+
+/**
+ * @brief Sets the resolution the canvas is read back at.
+ * 
+ * When smaller than the drawing resolution, readbacks first run an area-filter
+ * downsample pass on the GPU into a small FBO, so only the simulation-sized image
+ * crosses the bus (traffic shrinks by the square of the downscale ratio).
+ * 
+ * @param width Readback width in pixels (clamped to the canvas width).
+ * @param height Readback height in pixels (clamped to the canvas height).
+ */
+void Canvas::setReadbackSize(int width, int height) {
+    width = std::clamp(width, 1, m_width);
+    height = std::clamp(height, 1, m_height);
+    if (width == m_readWidth && height == m_readHeight) return;
+
+    m_readWidth = width;
+    m_readHeight = height;
+
+    discardReadbacks();
+    m_shadow.create(m_readHeight, m_readWidth, CV_8UC3);
+    m_dirtyRect = cv::Rect(0, 0, m_width, m_height); // Whole canvas must be re-read
+
+    // The new shadow holds no pixels yet: mark it invalid until the full re-read lands,
+    // under a new generation so consumers of the old size pick that re-read up
+    m_shadowGeneration = 0;
+    ++m_generation;
+
+    if (!isDownsampling()) return;
+
+    // (Re)allocate the small target at the new readback size
+    m_downTexture.allocate(m_readWidth, m_readHeight, GL_RGB8, GL_RGB);
+    if (!m_downFbo) glGenFramebuffers(1, &m_downFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_downFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_downTexture.getID(), 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Canvas::setReadbackSize: Framebuffer is not complete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Canvas::downsample(const cv::Rect& rect) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_downFbo);
+    glViewport(0, 0, m_readWidth, m_readHeight);
+
+    // Only the region about to be read needs refreshing
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(rect.x, m_readHeight - (rect.y + rect.height), rect.width, rect.height);
+
+    glUseProgram(m_downsampleProgram);
+    glUniform2f(m_downsampleRatioLoc, (float)m_width / (float)m_readWidth, (float)m_height / (float)m_readHeight);
+    m_texture.bind(0);
+    glBindVertexArray(m_emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glDisable(GL_SCISSOR_TEST);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+ * @brief Copies finished readbacks into the CPU shadow image without blocking.
+ * 
+ * Readbacks are consumed in the order they were issued. Each one is polled with a
+ * zero-timeout fence wait; the first unfinished one stops collection until the
+ * next call. The vertical flip is folded into the row copy from the mapped buffer.
+ * 
+ * @return true if the shadow image changed.
+ */
+bool Canvas::collectReadbacks() {
+    bool updated = false;
+    for (size_t n = 0; n < m_readbacks.size(); ++n) {
+        // Oldest in-flight readback sits right after the most recently issued one
+        PendingReadback& readback = m_readbacks[(m_nextReadback + n) % m_readbacks.size()];
+        if (!readback.fence) continue;
+
+        GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+
+        const cv::Rect& rect = readback.rect;
+        size_t rowBytes = (size_t)rect.width * 3;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        const uchar* mapped = (const uchar*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowBytes * rect.height, GL_MAP_READ_BIT);
+        if (mapped) {
+            // GL rows are bottom-up: buffer row r lands on image row (bottom - r)
+            for (int r = 0; r < rect.height; ++r) {
+                uchar* dst = m_shadow.ptr<uchar>(rect.y + rect.height - 1 - r) + rect.x * 3;
+                std::memcpy(dst, mapped + r * rowBytes, rowBytes);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            m_shadowGeneration = readback.generation;
+            updated = true;
+        } else {
+            std::cerr << "Canvas::collectReadbacks: Failed to map pixel buffer!" << std::endl;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    return updated;
+}
+
+void Canvas::requestSnapshot() {
+    if (m_snapshot.fence) return;
+
+    size_t bytes = (size_t)m_width * m_height * 3;
+    if (!m_snapshot.pbo) glGenBuffers(1, &m_snapshot.pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_snapshot.pbo);
+    if (bytes > m_snapshot.capacity) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        m_snapshot.capacity = bytes;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glReadPixels(0, 0, m_width, m_height, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_snapshot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_snapshot.rect = cv::Rect(0, 0, m_width, m_height);
+    m_snapshot.generation = m_generation;
+}
+
+bool Canvas::collectSnapshot(cv::Mat& image) {
+    if (!m_snapshot.fence) return false;
+
+    GLenum status = glClientWaitSync(m_snapshot.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+
+    glDeleteSync(m_snapshot.fence);
+    m_snapshot.fence = nullptr;
+
+    const cv::Rect& rect = m_snapshot.rect;
+    size_t rowBytes = (size_t)rect.width * 3;
+    bool copied = false;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_snapshot.pbo);
+    const uchar* mapped = (const uchar*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowBytes * rect.height, GL_MAP_READ_BIT);
+    if (mapped) {
+        // GL rows are bottom-up
+        image.create(rect.height, rect.width, CV_8UC3);
+        for (int r = 0; r < rect.height; ++r) {
+            std::memcpy(image.ptr<uchar>(rect.height - 1 - r), mapped + r * rowBytes, rowBytes);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        copied = true;
+    } else {
+        std::cerr << "Canvas::collectSnapshot: Failed to map pixel buffer!" << std::endl;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return copied;
+}
+
+void Canvas::discardReadbacks() {
+    for (auto& readback : m_readbacks) {
+        if (readback.fence) {
+            glDeleteSync(readback.fence);
+            readback.fence = nullptr;
+        }
+    }
 }
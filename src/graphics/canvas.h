@@ -2,10 +2,35 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include <opencv2/opencv.hpp>
 #include "texture.h"
 
+/**
+ * @struct StrokeStats
+ * @brief Batching statistics of the most recent drawLine() call.
+ */
+struct StrokeStats {
+    int dabs = 0;       ///< Interpolated brush positions along the segment
+    int vertices = 0;   ///< Vertices submitted in the batch
+    int drawCalls = 0;  ///< GL draw calls issued (1 when batched)
+};
+
+/**
+ * @struct FillStats
+ * @brief Timing and size of the most recent floodFill() call.
+ */
+struct FillStats {
+    float milliseconds = 0.0f; ///< Total time including readback and upload
+    int pixels = 0;            ///< Pixels filled
+    int uploadedPixels = 0;    ///< Pixels in the uploaded bounding box
+    bool reread = false;       ///< CPU copy had to be read back from the GPU first (a sync stall)
+    bool fromShadow = false;   ///< CPU copy was refreshed from the readback shadow instead
+};
+
 /**
  * @class Canvas
  * @brief Represents a drawing pad backed by a Framebuffer Object (FBO).
@@ -31,6 +56,9 @@ public:
     /**
      * @brief Draws a line segment on the canvas.
      * 
+     * The whole segment is tessellated into one vertex batch and drawn with a
+     * single draw call.
+     * 
      * @param start Start position (x, y).
      * @param end End position (x, y).
      * @param color RGB color (0-1 range).
@@ -38,6 +66,37 @@ public:
      */
     void drawLine(glm::vec2 start, glm::vec2 end, glm::vec3 color = glm::vec3(1.0f), float brushSize = 2.0f);
 
+    /**
+     * @brief Draws a polyline stroke with a single draw call.
+     * 
+     * Equivalent to drawing the first point and then every segment with drawLine.
+     * 
+     * @param points Stroke points in canvas pixels.
+     * @param color RGB color (0-1 range).
+     * @param brushSize Thickness of the line.
+     */
+    void drawPolyline(const std::vector<glm::vec2>& points, glm::vec3 color, float brushSize);
+
+    /**
+     * @brief Replaces the canvas contents with a BGR image of the same size.
+     */
+    void loadFromMat(const cv::Mat& image);
+
+    /**
+     * @brief Flood fills the region connected to a seed pixel.
+     * 
+     * Needs a current full-resolution CPU copy of the canvas. It is taken from the
+     * readback shadow when that is full resolution and up to date; otherwise (the
+     * shadow is downsampled or still lags a stroke) the first fill after other edits
+     * blocks on a synchronous glReadPixels of the whole canvas (FillStats::reread).
+     * 
+     * @param seed Start position in canvas pixels (top-left origin).
+     * @param color RGB color (0-1 range).
+     * @param tolerance Max per-channel difference (0-255) from the seed color.
+     * @return bool true if any pixel was filled.
+     */
+    bool floodFill(glm::vec2 seed, glm::vec3 color, int tolerance);
+
     /**
      * @brief Fills the entire canvas with a color.
      * 
@@ -53,9 +112,76 @@ public:
     /**
      * @brief Gets the canvas content as OpenCV Mat.
      * 
-     * @return cv::Mat The canvas pixels in BGR format.
+     * Synchronous full-canvas readback. Prefer the asynchronous
+     * requestReadback()/collectReadbacks() pair in per-frame code.
+     * 
+     * @param result Receives the canvas pixels in BGR format; reallocated only if its size or type differs.
+     */
+    void getAsMat(cv::Mat& result) const;
+
+    /**
+     * @brief Starts a non-blocking readback of the region changed since the last request.
+     * 
+     * Uses double-buffered pixel buffer objects with fences. Does nothing if
+     * nothing was drawn or both buffers are still in flight.
+     */
+    void requestReadback();
+
+    /**
+     * @brief Applies completed readbacks to the CPU shadow image (never blocks).
+     * 
+     * @return true if the shadow image changed.
+     */
+    bool collectReadbacks();
+
+    /**
+     * @brief Queues a non-blocking full-resolution read of the canvas as it is now.
+     * 
+     * Later drawing does not affect the result: the read is ordered on the GPU
+     * right after the commands issued so far. Does nothing if one is in flight.
+     */
+    void requestSnapshot();
+
+    /**
+     * @brief Takes the snapshot queued by requestSnapshot() once the GPU has written it (never blocks).
+     * 
+     * @param image Receives the canvas pixels in BGR format, top-left origin.
+     * @return true If @p image was filled.
+     */
+    bool collectSnapshot(cv::Mat& image);
+
+    bool isSnapshotPending() const { return m_snapshot.fence != nullptr; }
+
+    /**
+     * @brief Sets the resolution readbacks (and the CPU shadow) are produced at.
+     * 
+     * Smaller sizes are downsampled on the GPU with an area filter before readback.
+     * Invalidates the shadow and schedules a full re-read.
+     */
+    void setReadbackSize(int width, int height);
+
+    int getReadbackWidth() const { return m_readWidth; }
+    int getReadbackHeight() const { return m_readHeight; }
+
+    /**
+     * @brief Gets the CPU copy of the canvas (BGR, top-left origin, readback resolution).
+     * 
+     * Lags the GPU canvas by the readback latency (typically one frame).
      */
-    cv::Mat getAsMat() const;
+    const cv::Mat& getShadow() const { return m_shadow; }
+
+    /**
+     * @brief Gets the canvas generation reflected by getShadow().
+     * 
+     * 0 while the shadow holds no valid pixels (after setReadbackSize(), until
+     * the full re-read completes); the shadow must not be read then.
+     */
+    uint64_t getShadowGeneration() const { return m_shadowGeneration; }
+
+    /**
+     * @brief Gets the size in bytes of the last issued readback.
+     */
+    size_t getLastReadbackBytes() const { return m_lastReadbackBytes; }
 
     /**
      * @brief Gets the texture containing the drawing.
@@ -67,10 +193,68 @@ public:
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
 
+    /**
+     * @brief Gets the content generation of the canvas.
+     * 
+     * Incremented by every operation that changes the canvas pixels
+     * (drawLine, fill, clear) and by setReadbackSize(), which changes the
+     * pixels read back. Callers compare it against the generation
+     * they last consumed to skip redundant readbacks.
+     * 
+     * @return uint64_t Monotonic content generation (starts at 1 after construction).
+     */
+    uint64_t getGeneration() const { return m_generation; }
+
+    /**
+     * @brief Gets batching statistics of the most recent drawLine() call.
+     */
+    const StrokeStats& getLastStrokeStats() const { return m_lastStrokeStats; }
+
+    /**
+     * @brief Gets timing statistics of the most recent floodFill() call.
+     */
+    const FillStats& getLastFillStats() const { return m_lastFillStats; }
+
 private:
     void initGL();
     void initShader();
 
+    /**
+     * @brief Drops in-flight readbacks (their contents are stale after a fill/clear).
+     */
+    void discardReadbacks();
+
+    /**
+     * @brief Tessellates one stroke segment into m_strokeVertices and marks it dirty.
+     * @return int Number of dabs appended.
+     */
+    int appendSegment(glm::vec2 start, glm::vec2 end, float brushSize);
+
+    /**
+     * @brief Uploads m_strokeVertices and draws them in one call.
+     */
+    void submitStroke(glm::vec3 color, int dabs);
+
+    /**
+     * @brief Area-filters the canvas into the readback FBO over the given region.
+     * @param rect Region in readback coordinates (top-left origin).
+     */
+    void downsample(const cv::Rect& rect);
+
+    bool isDownsampling() const { return m_readWidth != m_width || m_readHeight != m_height; }
+
+    /**
+     * @struct PendingReadback
+     * @brief One slot of the double-buffered PBO readback ring.
+     */
+    struct PendingReadback {
+        unsigned int pbo = 0;
+        size_t capacity = 0;     ///< Allocated PBO size in bytes
+        GLsync fence = nullptr;  ///< Non-null while the readback is in flight
+        cv::Rect rect;           ///< Region read, in top-left image coordinates
+        uint64_t generation = 0; ///< Canvas generation at request time
+    };
+
     int m_width;
     int m_height;
     unsigned int m_fbo;
@@ -79,4 +263,46 @@ private:
     unsigned int m_lineVAO;
     unsigned int m_lineVBO;
     unsigned int m_shaderProgram;
+    int m_resolutionLoc = -1;
+    int m_colorLoc = -1;
+
+    // Stroke batching
+    std::vector<glm::vec2> m_strokeVertices; ///< Reused CPU-side batch for drawLine
+    size_t m_lineVBOCapacity = 0;            ///< Current size of m_lineVBO in bytes
+    StrokeStats m_lastStrokeStats;
+
+    // Asynchronous readback
+    cv::Mat m_shadow;                            ///< CPU copy of the canvas (BGR, top-down)
+    uint64_t m_shadowGeneration = 0;             ///< Generation reflected by m_shadow
+    cv::Rect m_dirtyRect;                        ///< Region drawn since the last request
+    std::array<PendingReadback, 2> m_readbacks;
+    int m_nextReadback = 0;
+    size_t m_lastReadbackBytes = 0;
+    PendingReadback m_snapshot;                  ///< Full-resolution read for requestSnapshot()
+
+    // GPU downsample to readback resolution
+    int m_readWidth = 0;
+    int m_readHeight = 0;
+    unsigned int m_downFbo = 0;
+    Texture2D m_downTexture;
+    unsigned int m_downsampleProgram = 0;
+    int m_downsampleRatioLoc = -1;
+    unsigned int m_emptyVAO = 0;
+
+    // Flood fill
+    cv::Mat m_fillImage;                   ///< Full-res CPU copy in GL row order (bottom-up)
+    uint64_t m_fillImageGeneration = 0;    ///< Generation m_fillImage matches
+    cv::Mat m_fillMask;                    ///< Visited pixels of the current fill
+    struct FillSpan {
+        int y;
+        int left;
+        int right;
+        int dy;
+    };
+    std::vector<FillSpan> m_fillStack;     ///< Explicit span stack (reused)
+    FillStats m_lastFillStats;
+
+    cv::Mat m_uploadScratch;               ///< Flipped image for loadFromMat
+
+    uint64_t m_generation = 0; ///< Bumped whenever the canvas pixels change
 };
@@ -0,0 +1,224 @@
+#include "frame_exporter.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace Graphics {
+
+    FrameExporter::FrameExporter() {}
+
+    FrameExporter::~FrameExporter() {
+        cancel();
+    }
+
+    bool FrameExporter::start(const ExportSettings& settings) {
+        cancel();
+        m_Error.clear();
+
+        if (settings.width <= 0 || settings.height <= 0 || settings.frameCount <= 0) {
+            std::cerr << "FrameExporter: Invalid export settings!" << std::endl;
+            m_Error = "Invalid export settings";
+            return false;
+        }
+        if (!m_Encoder.open(settings.path, settings.width, settings.height, settings.fps, settings.format)) {
+            m_Error = "Could not open " + settings.path;
+            return false;
+        }
+        m_Settings = settings;
+
+        // Offscreen color target at the export resolution
+        glGenTextures(1, &m_ColorTexture);
+        glBindTexture(GL_TEXTURE_2D, m_ColorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, settings.width, settings.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &m_FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorTexture, 0);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) {
+            std::cerr << "FrameExporter: Offscreen framebuffer is not complete!" << std::endl;
+            releaseTarget();
+            m_Encoder.close();
+            return false;
+        }
+
+        // Rotating readback buffers: frame N is read while N-1 and N-2 are still in flight
+        GLsizeiptr frameBytes = (GLsizeiptr)settings.width * settings.height * 4;
+        for (Readback& readback : m_Readbacks) {
+            glGenBuffers(1, &readback.pbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        m_NextReadback = 0;
+        m_OldestReadback = 0;
+        m_FramesRendered = 0;
+        m_FramesQueued = 0;
+        m_ReadbackFailed = false;
+        m_StartTime = std::chrono::steady_clock::now();
+        m_Active = true;
+
+        std::cout << "Exporting " << settings.frameCount << " frames at " << settings.width << "x" << settings.height
+                  << " to " << settings.path << std::endl;
+        return true;
+    }
+
+    void FrameExporter::cancel() {
+        if (!m_Active) return;
+        m_Active = false;
+        releaseTarget();
+        m_Encoder.abort(); // Queued frames are dropped; only the one being encoded finishes
+        std::cout << "Export cancelled after " << m_Encoder.getFramesEncoded() << " frames" << std::endl;
+    }
+
+    void FrameExporter::fail(const char* reason) {
+        m_Error = reason;
+        std::cerr << "FrameExporter: " << reason << ", cancelling export" << std::endl;
+        cancel();
+    }
+
+    void FrameExporter::releaseTarget() {
+        for (Readback& readback : m_Readbacks) {
+            if (readback.fence) glDeleteSync(readback.fence);
+            if (readback.pbo) glDeleteBuffers(1, &readback.pbo);
+            readback = Readback();
+        }
+        if (m_FBO) glDeleteFramebuffers(1, &m_FBO);
+        if (m_ColorTexture) glDeleteTextures(1, &m_ColorTexture);
+        m_FBO = 0;
+        m_ColorTexture = 0;
+    }
+
+    void FrameExporter::poll() {
+        if (!m_Active) return;
+        collect();
+
+        if (m_ReadbackFailed) {
+            fail("Could not map an export readback buffer");
+            return;
+        }
+        if (m_Encoder.hasFailed()) {
+            fail("The encoder could not write the output");
+            return;
+        }
+
+        // Finalize once the encoder has written the last frame
+        if (m_FramesQueued == m_Settings.frameCount && m_Encoder.getFramesEncoded() == (uint64_t)m_Settings.frameCount) {
+            m_Encoder.close();
+            releaseTarget();
+            m_Active = false;
+            if (m_Encoder.hasFailed()) {
+                m_Error = "The encoder could not write the output";
+                std::cerr << "FrameExporter: Export of " << m_Settings.path << " failed" << std::endl;
+                return;
+            }
+
+            std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - m_StartTime;
+            m_LastExportSeconds = elapsed.count();
+            std::cout << "Export finished: " << m_Settings.frameCount << " frames in " << m_LastExportSeconds
+                      << " s (" << m_Settings.frameCount / std::max(m_LastExportSeconds, 0.001f) << " fps)" << std::endl;
+        }
+    }
+
+    /**
+     * @brief Copies finished readbacks into the encoder queue, oldest first.
+     *
+     * Stops at the first readback the GPU hasn't finished or when the encoder
+     * queue is full; neither case waits. A readback that can't be mapped is
+     * never queued, and poll() fails the export.
+     */
+    void FrameExporter::collect() {
+        size_t rowBytes = (size_t)m_Settings.width * 4;
+        while (m_Readbacks[m_OldestReadback].pending) {
+            Readback& readback = m_Readbacks[m_OldestReadback];
+
+            GLenum status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+            cv::Mat* slot = m_Encoder.beginFrame();
+            if (!slot) break;
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+            const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowBytes * m_Settings.height, GL_MAP_READ_BIT);
+            if (!mapped) {
+                // The slot still holds a frame from an earlier lap; don't send it
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                m_ReadbackFailed = true;
+                break;
+            }
+            memcpy(slot->data, mapped, rowBytes * m_Settings.height);
+            bool intact = glUnmapBuffer(GL_PIXEL_PACK_BUFFER) == GL_TRUE; // GL_FALSE: contents were lost while mapped
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            if (!intact) {
+                m_ReadbackFailed = true;
+                break;
+            }
+            m_Encoder.commitFrame();
+
+            glDeleteSync(readback.fence);
+            readback.fence = nullptr;
+            readback.pending = false;
+            m_OldestReadback = (m_OldestReadback + 1) % kPboCount;
+            ++m_FramesQueued;
+        }
+    }
+
+    bool FrameExporter::canRenderFrame() const {
+        return m_Active && m_FramesRendered < m_Settings.frameCount && !m_Readbacks[m_NextReadback].pending;
+    }
+
+    void FrameExporter::beginFrame() {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+        glViewport(0, 0, m_Settings.width, m_Settings.height);
+    }
+
+    void FrameExporter::endFrame() {
+        Readback& readback = m_Readbacks[m_NextReadback];
+
+        // Asynchronous: returns immediately, the copy completes on the GPU
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, m_Settings.width, m_Settings.height, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback.pending = true;
+
+        m_NextReadback = (m_NextReadback + 1) % kPboCount;
+        ++m_FramesRendered;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void FrameExporter::blitToScreen(int windowWidth, int windowHeight) {
+        if (!m_Active || m_FramesRendered == 0) return;
+
+        float scale = std::min((float)windowWidth / m_Settings.width, (float)windowHeight / m_Settings.height);
+        int drawWidth = (int)(m_Settings.width * scale);
+        int drawHeight = (int)(m_Settings.height * scale);
+        int x = (windowWidth - drawWidth) / 2;
+        int y = (windowHeight - drawHeight) / 2;
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_FBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, m_Settings.width, m_Settings.height,
+                          x, y, x + drawWidth, y + drawHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    float FrameExporter::getExportFps() const {
+        if (!m_Active) return 0.0f;
+        std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - m_StartTime;
+        return elapsed.count() > 0.0f ? m_Encoder.getFramesEncoded() / elapsed.count() : 0.0f;
+    }
+
+    float FrameExporter::getProgress() const {
+        if (m_Settings.frameCount <= 0) return 0.0f;
+        return std::min(1.0f, (float)m_Encoder.getFramesEncoded() / (float)m_Settings.frameCount);
+    }
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "../io/frame_encoder.h"
+
+namespace Graphics {
+
+    /**
+     * @struct ExportSettings
+     * @brief Parameters of an offscreen export.
+     */
+    struct ExportSettings {
+        std::string path;                            ///< Video file, or directory for PNG sequences
+        EncoderFormat format = EncoderFormat::VIDEO;
+        int width = 1920;
+        int height = 1080;
+        int frameCount = 300;                        ///< Simulation steps to export
+        double fps = 30.0;                           ///< Playback rate of the written video
+    };
+
+    /**
+     * @class FrameExporter
+     * @brief Renders simulation steps offscreen and streams them to a FrameEncoder.
+     *
+     * Each exported frame is rendered into an FBO at the export resolution and
+     * read back into one of several rotating PBOs with a fence. Finished PBOs are
+     * copied into the encoder queue in order, and the encoder thread converts and
+     * writes them. Rendering, readback and encoding of consecutive frames overlap,
+     * and nothing on the render thread waits on the GPU or the encoder: when the
+     * pipeline is full, canRenderFrame() returns false and the caller moves on.
+     */
+    class FrameExporter {
+    public:
+        FrameExporter();
+        ~FrameExporter();
+
+        /**
+         * @brief Allocates the offscreen target and opens the encoder.
+         * @return true If the export could be started.
+         */
+        bool start(const ExportSettings& settings);
+
+        /**
+         * @brief Aborts the export, discarding frames not yet written.
+         *
+         * Waits only for the frame the encoder is currently writing.
+         */
+        void cancel();
+
+        bool isActive() const { return m_Active; }
+
+        /**
+         * @brief Harvests finished readbacks into the encoder and finalizes the output
+         * once every frame has been written. Call once per loop iteration.
+         */
+        void poll();
+
+        /**
+         * @brief True if another frame can be rendered without waiting.
+         */
+        bool canRenderFrame() const;
+
+        /**
+         * @brief Binds the offscreen target (viewport = export size).
+         */
+        void beginFrame();
+
+        /**
+         * @brief Queues the readback of the rendered frame and restores the default framebuffer.
+         */
+        void endFrame();
+
+        /**
+         * @brief Draws the last exported frame letterboxed into the default framebuffer.
+         */
+        void blitToScreen(int windowWidth, int windowHeight);
+
+        const ExportSettings& getSettings() const { return m_Settings; }
+        int getFramesRendered() const { return m_FramesRendered; }
+        uint64_t getFramesWritten() const { return m_Encoder.getFramesEncoded(); }
+        size_t getEncoderQueued() const { return m_Encoder.getQueued(); }
+        size_t getEncoderCapacity() const { return m_Encoder.getCapacity(); }
+        float getEncodeMs() const { return m_Encoder.getEncodeMs(); }
+
+        /**
+         * @brief Written frames per wall-clock second since the export started.
+         */
+        float getExportFps() const;
+
+        /**
+         * @brief Progress in [0, 1], by frames written.
+         */
+        float getProgress() const;
+
+        /**
+         * @brief Seconds spent on the last finished export.
+         */
+        float getLastExportSeconds() const { return m_LastExportSeconds; }
+
+        /**
+         * @brief Why the last export failed, or empty if it didn't. Cleared by start().
+         *
+         * A failed export (output not writable, encoder error, readback that couldn't
+         * be mapped) is cancelled by poll() rather than finished with missing frames.
+         */
+        const std::string& getError() const { return m_Error; }
+
+        static constexpr int kPboCount = 3;
+
+    private:
+        struct Readback {
+            GLuint pbo = 0;
+            GLsync fence = nullptr;
+            bool pending = false;
+        };
+
+        void collect();
+        void releaseTarget();
+        void fail(const char* reason);
+
+        ExportSettings m_Settings;
+        FrameEncoder m_Encoder;
+        bool m_Active = false;
+
+        GLuint m_FBO = 0;
+        GLuint m_ColorTexture = 0;
+        std::array<Readback, kPboCount> m_Readbacks;
+        int m_NextReadback = 0;    ///< PBO the next frame is read into
+        int m_OldestReadback = 0;  ///< Oldest pending PBO (frames are encoded in order)
+
+        int m_FramesRendered = 0;
+        int m_FramesQueued = 0;    ///< Frames handed to the encoder
+        std::chrono::steady_clock::time_point m_StartTime;
+        float m_LastExportSeconds = 0.0f;
+        bool m_ReadbackFailed = false;  ///< A PBO couldn't be mapped; its frame was never queued
+        std::string m_Error;
+    };
+
+}
@@ -0,0 +1,125 @@
+#include "gpu_profiler.h"
+
+namespace Graphics {
+
+    GpuProfiler::GpuProfiler() {
+        for (int s = 0; s < kStageCount; ++s) {
+            if (hasGpuTiming(static_cast<Stage>(s))) {
+                glGenQueries(kFrameLatency, m_Stages[s].queries.data());
+            }
+        }
+    }
+
+    GpuProfiler::~GpuProfiler() {
+        for (int s = 0; s < kStageCount; ++s) {
+            if (hasGpuTiming(static_cast<Stage>(s))) {
+                glDeleteQueries(kFrameLatency, m_Stages[s].queries.data());
+            }
+        }
+    }
+
+    bool GpuProfiler::hasGpuTiming(Stage stage) {
+        // Update encloses Canvas, and GL_TIME_ELAPSED queries cannot nest
+        return stage != Stage::Update;
+    }
+
+    const char* GpuProfiler::getStageName(Stage stage) {
+        switch (stage) {
+            case Stage::Update:    return "Update";
+            case Stage::Canvas:    return "Canvas";
+            case Stage::Particles: return "Particles";
+            case Stage::ImGui:     return "ImGui";
+            default:               return "Unknown";
+        }
+    }
+
+    float GpuProfiler::average(const std::array<float, kHistorySize>& history, int samples) {
+        if (samples == 0) return 0.0f;
+        // Unwritten slots are zero, so summing the whole ring adds only recorded samples
+        float sum = 0.0f;
+        for (float v : history) sum += v;
+        return sum / (float)samples;
+    }
+
+    /**
+     * @brief Commits last frame's samples and harvests finished GPU queries.
+     * 
+     * A query issued in slot N is only read when the ring wraps back to N
+     * (kFrameLatency frames later), and only if the driver reports it available.
+     * Unavailable results keep the previous sample instead of blocking.
+     */
+    void GpuProfiler::beginFrame() {
+        if (m_RequestedEnabled != m_Enabled) {
+            m_Enabled = m_RequestedEnabled;
+            // Samples from before the pause would be committed as one bogus frame
+            m_FirstFrame = true;
+            for (auto& stage : m_Stages) stage.ran = false;
+        }
+        if (!m_Enabled) return;
+
+        // Commit the previous frame's samples to the history rings
+        if (!m_FirstFrame) {
+            for (auto& stage : m_Stages) {
+                // Stages that didn't run last frame (e.g. Canvas outside canvas mode) record zero
+                stage.cpuHistory[m_HistoryCursor] = stage.cpuFrameMs;
+                stage.gpuHistory[m_HistoryCursor] = stage.ran ? stage.gpuSampleMs : 0.0f;
+                stage.ran = false;
+            }
+            m_HistoryCursor = (m_HistoryCursor + 1) % kHistorySize;
+            if (m_SampleCount < kHistorySize) ++m_SampleCount;
+            m_FrameSlot = (m_FrameSlot + 1) % kFrameLatency;
+        }
+        m_FirstFrame = false;
+
+        for (int s = 0; s < kStageCount; ++s) {
+            StageData& stage = m_Stages[s];
+            stage.cpuFrameMs = 0.0f;
+
+            if (!hasGpuTiming(static_cast<Stage>(s)) || !stage.pending[m_FrameSlot]) continue;
+
+            // Non-blocking harvest of the query issued kFrameLatency frames ago
+            GLint available = 0;
+            glGetQueryObjectiv(stage.queries[m_FrameSlot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 elapsedNs = 0;
+                glGetQueryObjectui64v(stage.queries[m_FrameSlot], GL_QUERY_RESULT, &elapsedNs);
+                stage.gpuSampleMs = (float)(elapsedNs / 1.0e6);
+                stage.pending[m_FrameSlot] = false;
+            }
+        }
+    }
+
+    void GpuProfiler::begin(Stage stage) {
+        if (!m_Enabled) return;
+
+        StageData& data = m_Stages[index(stage)];
+        data.cpuStart = Clock::now();
+        data.active = true;
+        data.ran = true;
+
+        // Slot still waiting on an older result: skip the GPU sample this frame
+        // rather than reusing a query that hasn't been read back yet
+        if (hasGpuTiming(stage) && !data.pending[m_FrameSlot]) {
+            glBeginQuery(GL_TIME_ELAPSED, data.queries[m_FrameSlot]);
+            data.queryOpen = true;
+        }
+    }
+
+    void GpuProfiler::end(Stage stage) {
+        // No m_Enabled check: a stage opened by begin() is always closed, since a
+        // GL_TIME_ELAPSED query left running breaks the next glBeginQuery
+        StageData& data = m_Stages[index(stage)];
+        if (!data.active) return;
+        data.active = false;
+
+        if (data.queryOpen) {
+            glEndQuery(GL_TIME_ELAPSED);
+            data.pending[m_FrameSlot] = true;
+            data.queryOpen = false;
+        }
+
+        std::chrono::duration<float, std::milli> elapsed = Clock::now() - data.cpuStart;
+        data.cpuFrameMs += elapsed.count();
+    }
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <chrono>
+
+namespace Graphics {
+
+    /**
+     * @class GpuProfiler
+     * @brief Per-stage GPU and CPU timing for the render pipeline.
+     * 
+     * Each GPU stage is wrapped in a GL_TIME_ELAPSED query. Queries are kept in a
+     * ring of kFrameLatency slots per stage and results are only read once
+     * GL_QUERY_RESULT_AVAILABLE reports them ready, so the CPU never waits on the GPU.
+     * CPU wall time is recorded for every stage alongside the GPU time.
+     * 
+     * Stages must not nest when they use GPU queries (GL allows a single active
+     * GL_TIME_ELAPSED query); CPU-only stages may enclose GPU stages.
+     */
+    class GpuProfiler {
+    public:
+        enum class Stage {
+            Update,     ///< App::update (CPU only, encloses Canvas)
+            Canvas,     ///< Brush strokes into the canvas FBO
+            Particles,  ///< Renderer::renderParticles
+            ImGui,      ///< GUI build + draw
+            Count
+        };
+
+        static constexpr int kStageCount = static_cast<int>(Stage::Count);
+        static constexpr int kFrameLatency = 4;   ///< Frames in flight before a query is read back
+        static constexpr int kHistorySize = 120;  ///< Samples in the rolling average window
+
+        /**
+         * @brief Creates the query objects. Requires an active OpenGL 3.3 context.
+         */
+        GpuProfiler();
+        ~GpuProfiler();
+
+        /**
+         * @brief Advances to the next frame slot and harvests any finished queries.
+         * Call once at the start of every frame, before any begin()/end().
+         */
+        void beginFrame();
+
+        /**
+         * @brief Starts timing a stage for the current frame.
+         */
+        void begin(Stage stage);
+
+        /**
+         * @brief Stops timing a stage for the current frame.
+         */
+        void end(Stage stage);
+
+        /**
+         * @brief Rolling average GPU time of a stage in milliseconds (0 for CPU-only stages).
+         */
+        float getGpuMs(Stage stage) const { return average(m_Stages[index(stage)].gpuHistory, m_SampleCount); }
+
+        /**
+         * @brief Newest GPU sample of a stage in milliseconds (0 for CPU-only stages or if it didn't run).
+         */
+        float getLatestGpuMs(Stage stage) const {
+            return m_Stages[index(stage)].gpuHistory[(m_HistoryCursor + kHistorySize - 1) % kHistorySize];
+        }
+
+        /**
+         * @brief Rolling average CPU time of a stage in milliseconds.
+         */
+        float getCpuMs(Stage stage) const { return average(m_Stages[index(stage)].cpuHistory, m_SampleCount); }
+
+        /**
+         * @brief Raw GPU history ring of a stage (for plotting).
+         */
+        const std::array<float, kHistorySize>& getGpuHistory(Stage stage) const { return m_Stages[index(stage)].gpuHistory; }
+
+        /**
+         * @brief Index of the oldest sample in the history rings.
+         */
+        int getHistoryOffset() const { return m_HistoryCursor; }
+
+        /**
+         * @brief Returns whether the stage records GPU time.
+         */
+        static bool hasGpuTiming(Stage stage);
+
+        /**
+         * @brief Human-readable stage name.
+         */
+        static const char* getStageName(Stage stage);
+
+        /**
+         * @brief Turns timing on or off from the next beginFrame().
+         *
+         * Deferred so a toggle made inside a stage (e.g. from the GUI) still closes that stage.
+         */
+        void setEnabled(bool enabled) { m_RequestedEnabled = enabled; }
+        bool isEnabled() const { return m_RequestedEnabled; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct StageData {
+            std::array<unsigned int, kFrameLatency> queries{};  ///< One query per in-flight frame
+            std::array<bool, kFrameLatency> pending{};          ///< Query issued, result not yet read
+            std::array<float, kHistorySize> gpuHistory{};
+            std::array<float, kHistorySize> cpuHistory{};
+            float gpuSampleMs = 0.0f;   ///< Latest harvested GPU sample
+            float cpuFrameMs = 0.0f;    ///< CPU time accumulated this frame
+            Clock::time_point cpuStart;
+            bool active = false;
+            bool queryOpen = false;     ///< begin() issued glBeginQuery for this stage
+            bool ran = false;           ///< Stage was timed during the current frame
+        };
+
+        static int index(Stage stage) { return static_cast<int>(stage); }
+        static float average(const std::array<float, kHistorySize>& history, int samples);
+
+        std::array<StageData, kStageCount> m_Stages;
+        int m_FrameSlot = 0;
+        int m_HistoryCursor = 0;
+        int m_SampleCount = 0;          ///< Samples in the history rings (up to kHistorySize)
+        bool m_Enabled = true;
+        bool m_RequestedEnabled = true;
+        bool m_FirstFrame = true;
+    };
+
+}
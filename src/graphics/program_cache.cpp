@@ -0,0 +1,249 @@
+#include "program_cache.h"
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace Graphics {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        constexpr uint32_t kBinaryMagic = 0x4250534C; // "LSPB"
+        constexpr uint32_t kBinaryVersion = 1;
+
+        // Precedes the driver's binary in every cache file
+        struct BinaryHeader {
+            uint32_t magic = kBinaryMagic;
+            uint32_t version = kBinaryVersion;
+            uint32_t format = 0;
+            uint32_t size = 0;
+        };
+
+        bool g_enabled = true;
+        int g_supported = -1; // -1 until first checked
+        ProgramCacheStats g_stats;
+
+        float millisecondsSince(Clock::time_point start) {
+            return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+        }
+
+        // FNV-1a, 64-bit. Each string is hashed with its terminator so that
+        // ("ab", "c") and ("a", "bc") produce different keys.
+        uint64_t hashString(uint64_t hash, const char* text) {
+            if (!text) text = "";
+            do {
+                hash ^= (unsigned char)*text;
+                hash *= 1099511628211ull;
+            } while (*text++);
+            return hash;
+        }
+
+        std::filesystem::path cacheDirectory() {
+#if defined(_WIN32)
+            if (const char* local = std::getenv("LOCALAPPDATA"); local && *local) {
+                return std::filesystem::path(local) / "LumaSort" / "shaders";
+            }
+#elif defined(__APPLE__)
+            if (const char* home = std::getenv("HOME"); home && *home) {
+                return std::filesystem::path(home) / "Library" / "Caches" / "LumaSort" / "shaders";
+            }
+#else
+            if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+                return std::filesystem::path(xdg) / "lumasort" / "shaders";
+            }
+            if (const char* home = std::getenv("HOME"); home && *home) {
+                return std::filesystem::path(home) / ".cache" / "lumasort" / "shaders";
+            }
+#endif
+            return {};
+        }
+
+        // Binaries can be saved and restored on this driver
+        bool binariesSupported() {
+            if (g_supported < 0) {
+                GLint formats = 0;
+                if (glGetProgramBinary && glProgramBinary) {
+                    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+                }
+                g_supported = formats > 0 && !cacheDirectory().empty();
+            }
+            return g_enabled && g_supported > 0;
+        }
+
+        // <name>-<device key>-<source key>.bin. Each GPU/driver keeps its own file, so
+        // hybrid-GPU machines that alternate between adapters stay warm on both.
+        std::filesystem::path cacheFile(const char* name, const char* vertexSource, const char* fragmentSource) {
+            uint64_t device = 14695981039346656037ull;
+            device = hashString(device, (const char*)glGetString(GL_VENDOR));
+            device = hashString(device, (const char*)glGetString(GL_RENDERER));
+            device = hashString(device, (const char*)glGetString(GL_VERSION));
+
+            uint64_t source = 14695981039346656037ull;
+            source = hashString(source, vertexSource);
+            source = hashString(source, fragmentSource);
+
+            char key[34];
+            std::snprintf(key, sizeof(key), "%016llx-%016llx", (unsigned long long)device, (unsigned long long)source);
+            return cacheDirectory() / (std::string(name) + "-" + key + ".bin");
+        }
+
+        bool isLinked(unsigned int program) {
+            GLint success = 0;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            return success == GL_TRUE;
+        }
+
+        unsigned int compileStage(GLenum type, const char* source, const char* name) {
+            unsigned int shader = glCreateShader(type);
+            glShaderSource(shader, 1, &source, nullptr);
+            glCompileShader(shader);
+            GLint success = 0;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+            if (!success) {
+                char infoLog[512];
+                glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+                std::cerr << "ERROR::SHADER::" << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT")
+                          << "::COMPILATION_FAILED (" << name << ")\n" << infoLog << std::endl;
+            }
+            return shader;
+        }
+
+        unsigned int compileProgram(const char* name, const char* vertexSource, const char* fragmentSource, bool retrievable) {
+            unsigned int vertexShader = compileStage(GL_VERTEX_SHADER, vertexSource, name);
+            unsigned int fragmentShader = compileStage(GL_FRAGMENT_SHADER, fragmentSource, name);
+
+            unsigned int program = glCreateProgram();
+            if (retrievable) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glAttachShader(program, vertexShader);
+            glAttachShader(program, fragmentShader);
+            glLinkProgram(program);
+
+            if (!isLinked(program)) {
+                char infoLog[512];
+                glGetProgramInfoLog(program, 512, nullptr, infoLog);
+                std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED (" << name << ")\n" << infoLog << std::endl;
+            }
+
+            glDeleteShader(vertexShader);
+            glDeleteShader(fragmentShader);
+            return program;
+        }
+
+        // Returns 0 on a miss: no file, a foreign or truncated file, or a binary the driver refuses
+        unsigned int loadBinary(const std::filesystem::path& file) {
+            std::ifstream in(file, std::ios::binary);
+            if (!in) return 0;
+
+            BinaryHeader header;
+            in.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!in || header.magic != kBinaryMagic || header.version != kBinaryVersion || header.size == 0) return 0;
+
+            std::vector<char> binary(header.size);
+            if (!in.read(binary.data(), (std::streamsize)binary.size())) return 0;
+            in.close();
+
+            unsigned int program = glCreateProgram();
+            glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+            if (!isLinked(program)) {
+                glDeleteProgram(program);
+                std::error_code ignored;
+                std::filesystem::remove(file, ignored);
+                return 0;
+            }
+            return program;
+        }
+
+        void saveBinary(unsigned int program, const std::filesystem::path& file) {
+            GLint length = 0;
+            glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+            if (length <= 0) return;
+
+            std::vector<char> binary((size_t)length);
+            GLsizei written = 0;
+            GLenum format = 0;
+            glGetProgramBinary(program, length, &written, &format, binary.data());
+            if (written <= 0) return;
+
+            std::error_code error;
+            std::filesystem::create_directories(file.parent_path(), error);
+
+            // Binaries of older sources for this program on this device are dead weight.
+            // Other devices' files share the name but not the device key, and are kept.
+            std::string prefix = file.stem().string();
+            prefix.resize(prefix.rfind('-') + 1);
+            std::vector<std::filesystem::path> stale;
+            std::filesystem::directory_iterator it(file.parent_path(), error);
+            for (; !error && it != std::filesystem::directory_iterator(); it.increment(error)) {
+                std::string other = it->path().filename().string();
+                if (other.rfind(prefix, 0) == 0 && other.size() == file.filename().string().size()) {
+                    stale.push_back(it->path());
+                }
+            }
+            for (const std::filesystem::path& path : stale) {
+                std::filesystem::remove(path, error);
+            }
+
+            // Write then rename, so a second instance never reads a half-written file
+            std::filesystem::path temp = file;
+            temp += ".tmp";
+            {
+                std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+                BinaryHeader header;
+                header.format = format;
+                header.size = (uint32_t)written;
+                out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                out.write(binary.data(), written);
+                if (!out) {
+                    std::cerr << "ProgramCache: failed to write " << temp.string() << std::endl;
+                    out.close();
+                    std::filesystem::remove(temp, error);
+                    return;
+                }
+            }
+            std::filesystem::rename(temp, file, error);
+            if (error) std::filesystem::remove(temp, error);
+        }
+
+    } // namespace
+
+    unsigned int ProgramCache::getProgram(const char* name, const char* vertexSource, const char* fragmentSource) {
+        Clock::time_point start = Clock::now();
+
+        std::filesystem::path file;
+        if (binariesSupported()) {
+            file = cacheFile(name, vertexSource, fragmentSource);
+            if (unsigned int program = loadBinary(file)) {
+                ++g_stats.loaded;
+                g_stats.loadMs += millisecondsSince(start);
+                return program;
+            }
+        }
+
+        unsigned int program = compileProgram(name, vertexSource, fragmentSource, !file.empty());
+        if (!file.empty() && isLinked(program)) saveBinary(program, file);
+
+        ++g_stats.compiled;
+        g_stats.compileMs += millisecondsSince(start);
+        return program;
+    }
+
+    void ProgramCache::setEnabled(bool enabled) {
+        g_enabled = enabled;
+    }
+
+    std::string ProgramCache::getDirectory() {
+        return cacheDirectory().string();
+    }
+
+    ProgramCacheStats ProgramCache::getStats() {
+        return g_stats;
+    }
+
+} // namespace Graphics
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+
+namespace Graphics {
+
+    /**
+     * @struct ProgramCacheStats
+     * @brief How the programs built so far were obtained, and what it cost.
+     */
+    struct ProgramCacheStats {
+        int compiled = 0;         ///< Compiled and linked from source (cache misses)
+        int loaded = 0;           ///< Loaded from a cached program binary
+        float compileMs = 0.0f;   ///< Total time spent on compiled programs
+        float loadMs = 0.0f;      ///< Total time spent on loaded programs
+    };
+
+    /**
+     * @class ProgramCache
+     * @brief Builds GL programs, caching linked binaries on disk between runs.
+     *
+     * A program's binary (glGetProgramBinary) is stored in a per-user cache directory
+     * under a device key (hash of GL_VENDOR, GL_RENDERER, GL_VERSION) and a source key,
+     * so a driver update or a shader edit simply misses and recompiles. Each device
+     * keeps its own binaries; saving only replaces older sources for the same device.
+     * Binaries the driver rejects are deleted and rebuilt from source. When the
+     * driver offers no binary formats, or no cache directory can be found, programs
+     * are compiled every time.
+     *
+     * Cache directory:
+     * - Linux: $XDG_CACHE_HOME/lumasort/shaders, or ~/.cache/lumasort/shaders
+     * - macOS: ~/Library/Caches/LumaSort/shaders
+     * - Windows: %LOCALAPPDATA%\\LumaSort\\shaders
+     *
+     * @note GL thread only (uses the current context).
+     */
+    class ProgramCache {
+    public:
+        /**
+         * @brief Returns a linked vertex/fragment program, from the cache when possible.
+         * @param name Label for error messages and the cache file name (e.g. "particle").
+         * @return Program name; compile and link errors are reported on std::cerr.
+         */
+        static unsigned int getProgram(const char* name, const char* vertexSource, const char* fragmentSource);
+
+        /**
+         * @brief Turns the on-disk cache off (every program compiles) or back on.
+         *
+         * Set before the first getProgram() to measure a cold start.
+         */
+        static void setEnabled(bool enabled);
+
+        /**
+         * @brief Cache directory for this user, or empty when none can be determined.
+         */
+        static std::string getDirectory();
+
+        static ProgramCacheStats getStats();
+    };
+
+} // namespace Graphics
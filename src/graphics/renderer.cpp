@@ -1,65 +1,29 @@
 #include "renderer.h"
+#include "program_cache.h"
+#include "shader_sources.h"
+#include "../core/cpu_profiler.h"
 #include <glad/glad.h>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 
 namespace Graphics {
 
-    // Basic file reading helper
-    std::string readFile(const char* path) {
-        std::ifstream file(path);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open shader file: " << path << std::endl;
-            return "";
-        }
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        return buffer.str();
-    }
-
     Renderer::Renderer() {
-        // Compile Shaders from assets
-        std::string vertexCode = readFile("assets/shaders/particle.vert");
-        std::string fragmentCode = readFile("assets/shaders/particle.frag");
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-
-        unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vShaderCode, NULL);
-        glCompileShader(vertexShader);
-        // Check errors
-        int success;
-        char infoLog[512];
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-            std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-
-        unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fShaderCode, NULL);
-        glCompileShader(fragmentShader);
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-            std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-
-        m_ParticleShader = glCreateProgram();
-        glAttachShader(m_ParticleShader, vertexShader);
-        glAttachShader(m_ParticleShader, fragmentShader);
-        glLinkProgram(m_ParticleShader);
+        // Shaders are embedded at build time (assets/shaders -> shader_sources.h)
+        m_ParticleShader = ProgramCache::getProgram("particle", Shaders::kParticleVert, Shaders::kParticleFrag);
         
-        glGetProgramiv(m_ParticleShader, GL_LINK_STATUS, &success);
-        if (!success) {
-             glGetProgramInfoLog(m_ParticleShader, 512, NULL, infoLog);
-             std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        }
-
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        // LOD path: same vertex stage, additive splat output, fullscreen resolve
+        m_SplatShader = ProgramCache::getProgram("splat", Shaders::kParticleVert, Shaders::kSplatFrag);
+        m_ResolveShader = ProgramCache::getProgram("resolve", Shaders::kResolveVert, Shaders::kResolveFrag);
+
+        // Cache uniform locations (looked up once, not per frame)
+        m_PointSizeLoc = glGetUniformLocation(m_ParticleShader, "uPointSize");
+        m_ScaleLoc = glGetUniformLocation(m_ParticleShader, "uScale");
+        m_SplatPointSizeLoc = glGetUniformLocation(m_SplatShader, "uPointSize");
+        m_SplatScaleLoc = glGetUniformLocation(m_SplatShader, "uScale");
+        glUseProgram(m_ResolveShader);
+        glUniform1i(glGetUniformLocation(m_ResolveShader, "uAccum"), 0);
+        glUseProgram(0);
 
         // Setup Buffers
         glGenVertexArrays(1, &m_ParticleVAO);
@@ -87,12 +51,21 @@ namespace Graphics {
 
         glBindBuffer(GL_ARRAY_BUFFER, 0); 
         glBindVertexArray(0);
+
+        // Core profile requires a bound VAO even for attribute-less draws
+        glGenVertexArrays(1, &m_ResolveVAO);
     }
 
     Renderer::~Renderer() {
         glDeleteVertexArrays(1, &m_ParticleVAO);
         glDeleteBuffers(1, &m_ParticleVBO);
         glDeleteProgram(m_ParticleShader);
+        glDeleteVertexArrays(1, &m_ResolveVAO);
+        glDeleteProgram(m_SplatShader);
+        glDeleteProgram(m_ResolveShader);
+        if (m_SplatFBO) glDeleteFramebuffers(1, &m_SplatFBO);
+        if (m_SplatTexture) glDeleteTextures(1, &m_SplatTexture);
+        if (m_BlitFBO) glDeleteFramebuffers(1, &m_BlitFBO);
     }
 
     void Renderer::clear() {
@@ -111,6 +84,10 @@ namespace Graphics {
      * to ensure content fits within the viewport while maintaining proportions.
      * This may result in black bars (letterboxing) on wider/taller viewports.
      * 
+     * When the simulation grid is denser than the viewport (more particles than pixels
+     * by at least the LOD threshold), the draw switches to splatParticles() instead of
+     * overdrawing point sprites.
+     * 
      * @param particles Vector of particles to render.
      * @param viewportWidth Current viewport width in pixels.
      * @param viewportHeight Current viewport height in pixels.
@@ -123,8 +100,6 @@ namespace Graphics {
      */
     void Renderer::renderParticles(const std::vector<Particle>& particles, int viewportWidth, int viewportHeight, int simWidth, int simHeight) {
         if (particles.empty()) return;
-
-        glUseProgram(m_ParticleShader);
         
         // Calculate scale factors for aspect-ratio-preserving rendering (letterboxing)
         // Use min of scale factors to ensure content fits within viewport
@@ -137,19 +112,34 @@ namespace Graphics {
         float ndcScaleX = (scaleFactor * simWidth) / viewportWidth;
         float ndcScaleY = (scaleFactor * simHeight) / viewportHeight;
         
-        // Point size based on uniform scale factor with overlap
-        float pointSize = scaleFactor * 1.5f;
-        pointSize = std::max(pointSize, 1.0f);  // Clamp to minimum 1.0
-        
-        // Pass uniforms to shader
-        glUniform1f(glGetUniformLocation(m_ParticleShader, "uPointSize"), pointSize);
-        glUniform2f(glGetUniformLocation(m_ParticleShader, "uScale"), ndcScaleX, ndcScaleY);
+        // Each particle covers scaleFactor^2 pixels, so its inverse is the density
+        m_ParticlesPerPixel = 1.0f / (scaleFactor * scaleFactor);
+        m_LodActive = m_LodEnabled && m_ParticlesPerPixel > m_LodThreshold;
         
         glBindVertexArray(m_ParticleVAO);
         glBindBuffer(GL_ARRAY_BUFFER, m_ParticleVBO);
 
         // Upload particle data - using GL_STREAM_DRAW for per-frame updates
-        glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(Particle), particles.data(), GL_STREAM_DRAW);
+        {
+            PROFILE_SCOPE("Upload");
+            glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(Particle), particles.data(), GL_STREAM_DRAW);
+        }
+        PROFILE_SCOPE("Draw");
+
+        if (m_LodActive) {
+            splatParticles((GLsizei)particles.size(), viewportWidth, viewportHeight, ndcScaleX, ndcScaleY);
+            return;
+        }
+
+        glUseProgram(m_ParticleShader);
+        
+        // Point size based on uniform scale factor with overlap
+        float pointSize = scaleFactor * 1.5f;
+        pointSize = std::max(pointSize, 1.0f);  // Clamp to minimum 1.0
+        
+        // Pass uniforms to shader
+        glUniform1f(m_PointSizeLoc, pointSize);
+        glUniform2f(m_ScaleLoc, ndcScaleX, ndcScaleY);
 
         glEnable(GL_PROGRAM_POINT_SIZE);
         glDrawArrays(GL_POINTS, 0, (GLsizei)particles.size());
@@ -159,4 +149,98 @@ namespace Graphics {
         glUseProgram(0);
     }
 
+    /**
+     * @brief Density-splat LOD path for grids denser than the viewport.
+     * 
+     * Pass 1 draws every particle as a single pixel into a float accumulation target
+     * at viewport resolution with additive blending: RGB sums colors, A counts hits.
+     * Pass 2 resolves with a fullscreen triangle that averages each pixel (rgb / a),
+     * so each screen pixel is written once instead of overdrawn by 1.5x point sprites.
+     * 
+     * @param count Number of particles already uploaded to m_ParticleVBO.
+     * @param viewportWidth Current viewport width in pixels.
+     * @param viewportHeight Current viewport height in pixels.
+     * @param ndcScaleX Letterbox scale on X (matches the point-sprite path).
+     * @param ndcScaleY Letterbox scale on Y (matches the point-sprite path).
+     */
+    void Renderer::splatParticles(GLsizei count, int viewportWidth, int viewportHeight, float ndcScaleX, float ndcScaleY) {
+        ensureSplatTarget(viewportWidth, viewportHeight);
+
+        // Remember the caller's framebuffer so the resolve lands where points would have
+        GLint previousFBO = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFBO);
+
+        // Pass 1: Accumulate
+        glBindFramebuffer(GL_FRAMEBUFFER, m_SplatFBO);
+        glViewport(0, 0, viewportWidth, viewportHeight);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+
+        glUseProgram(m_SplatShader);
+        glUniform1f(m_SplatPointSizeLoc, 1.0f);
+        glUniform2f(m_SplatScaleLoc, ndcScaleX, ndcScaleY);
+
+        glBindVertexArray(m_ParticleVAO);
+        glEnable(GL_PROGRAM_POINT_SIZE);
+        glDrawArrays(GL_POINTS, 0, count);
+        glDisable(GL_PROGRAM_POINT_SIZE);
+
+        glDisable(GL_BLEND);
+
+        // Pass 2: Resolve (average) into the caller's framebuffer
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+        glViewport(0, 0, viewportWidth, viewportHeight);
+
+        glUseProgram(m_ResolveShader);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_SplatTexture);
+        glBindVertexArray(m_ResolveVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+    void Renderer::blitTexture(unsigned int texture, int width, int height) {
+        GLint previousFBO = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFBO);
+
+        if (!m_BlitFBO) glGenFramebuffers(1, &m_BlitFBO);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_BlitFBO);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+
+        // Row 0 of the texture is the top of the image: flip while copying
+        glBlitFramebuffer(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFBO);
+    }
+
+    void Renderer::ensureSplatTarget(int width, int height) {
+        if (m_SplatFBO && width == m_SplatWidth && height == m_SplatHeight) return;
+
+        if (!m_SplatTexture) glGenTextures(1, &m_SplatTexture);
+        glBindTexture(GL_TEXTURE_2D, m_SplatTexture);
+        // 32-bit float so per-pixel counts stay exact for very dense grids
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        if (!m_SplatFBO) glGenFramebuffers(1, &m_SplatFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_SplatFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_SplatTexture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Renderer::ensureSplatTarget: Framebuffer is not complete!" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        m_SplatWidth = width;
+        m_SplatHeight = height;
+    }
+
 }
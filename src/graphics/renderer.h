@@ -1,6 +1,6 @@
 #pragma once
 
-
+#include <glad/glad.h>
 #include <vector>
 #include "../core/particle.h"
 
@@ -38,10 +38,72 @@ namespace Graphics {
          */
         void renderParticles(const std::vector<Particle>& particles, int viewportWidth, int viewportHeight, int simWidth, int simHeight);
 
+        /**
+         * @brief Copies a top-row-first texture 1:1 into the bound draw framebuffer.
+         *
+         * Used to present frames produced off the GL path (e.g. by SoftwareRasterizer).
+         * @param texture GL texture name.
+         * @param width Texture (and viewport) width in pixels.
+         * @param height Texture (and viewport) height in pixels.
+         */
+        void blitTexture(unsigned int texture, int width, int height);
+
+        /**
+         * @brief Enables or disables the automatic density-splat LOD path.
+         */
+        void setLodEnabled(bool enabled) { m_LodEnabled = enabled; }
+        bool isLodEnabled() const { return m_LodEnabled; }
+
+        /**
+         * @brief Sets the particles-per-pixel density at which the LOD path takes over.
+         * @param threshold Density threshold (1.0 = one particle per screen pixel).
+         *        Clamped to at least 1.0: below that the splat leaves uncovered pixels.
+         */
+        void setLodThreshold(float threshold) { m_LodThreshold = threshold < 1.0f ? 1.0f : threshold; }
+        float getLodThreshold() const { return m_LodThreshold; }
+
+        /**
+         * @brief Returns whether the last renderParticles() call used the LOD path.
+         */
+        bool isLodActive() const { return m_LodActive; }
+
+        /**
+         * @brief Returns the particle density measured by the last renderParticles() call.
+         */
+        float getParticlesPerPixel() const { return m_ParticlesPerPixel; }
+
     private:
+        /**
+         * @brief Splats particles into an accumulation FBO and resolves the average per pixel.
+         */
+        void splatParticles(GLsizei count, int viewportWidth, int viewportHeight, float ndcScaleX, float ndcScaleY);
+
+        /**
+         * @brief (Re)allocates the float accumulation target to match the viewport.
+         */
+        void ensureSplatTarget(int width, int height);
+
         unsigned int m_ParticleVAO = 0;
         unsigned int m_ParticleVBO = 0;
         unsigned int m_ParticleShader = 0;
+        int m_PointSizeLoc = -1;
+        int m_ScaleLoc = -1;
+
+        // Density-splat LOD
+        unsigned int m_SplatShader = 0;
+        unsigned int m_ResolveShader = 0;
+        unsigned int m_ResolveVAO = 0;
+        unsigned int m_SplatFBO = 0;
+        unsigned int m_SplatTexture = 0;
+        int m_SplatWidth = 0;
+        int m_SplatHeight = 0;
+        int m_SplatPointSizeLoc = -1;
+        int m_SplatScaleLoc = -1;
+        unsigned int m_BlitFBO = 0;
+        bool m_LodEnabled = true;
+        bool m_LodActive = false;
+        float m_LodThreshold = 1.0f;
+        float m_ParticlesPerPixel = 0.0f;
     };
 
 }
@@ -0,0 +1,241 @@
+#include "software_rasterizer.h"
+#include "../core/cpu_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LUMASORT_RASTER_SSE2 1
+#endif
+
+namespace Graphics {
+
+    namespace {
+
+        // Renderer::clear() color (0.1, 0.1, 0.1, 1.0) as BGRA
+        constexpr uint32_t kClearColor = 0xFF1A1A1Au;
+
+        uint32_t packColor(const glm::vec4& color) {
+            auto channel = [](float c) { return (uint32_t)(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f); };
+            return channel(color.b) | (channel(color.g) << 8) | (channel(color.r) << 16) | (channel(color.a) << 24);
+        }
+
+        /**
+         * @brief Fills count pixels of a row, four at a time when SSE2 is available.
+         */
+        inline void fillSpan(uint32_t* row, int count, uint32_t color) {
+            int x = 0;
+#ifdef LUMASORT_RASTER_SSE2
+            __m128i value = _mm_set1_epi32((int)color);
+            for (; x + 4 <= count; x += 4) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), value);
+            }
+#endif
+            for (; x < count; ++x) {
+                row[x] = color;
+            }
+        }
+
+    }
+
+    SoftwareRasterizer::SoftwareRasterizer(int threadCount) {
+        if (threadCount <= 0) {
+            threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (int i = 1; i < threadCount; ++i) {
+            m_Workers.emplace_back(&SoftwareRasterizer::workerLoop, this);
+        }
+    }
+
+    SoftwareRasterizer::~SoftwareRasterizer() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Quit = true;
+        }
+        m_WakeCondition.notify_all();
+        for (std::thread& worker : m_Workers) {
+            worker.join();
+        }
+    }
+
+    void SoftwareRasterizer::renderParticles(const std::vector<Particle>& particles, int viewportWidth, int viewportHeight, int simWidth, int simHeight) {
+        PROFILE_SCOPE("Software Raster");
+        auto frameStart = std::chrono::steady_clock::now();
+
+        if (m_Framebuffer.cols != viewportWidth || m_Framebuffer.rows != viewportHeight) {
+            m_Framebuffer.create(viewportHeight, viewportWidth, CV_8UC4);
+        }
+        m_TilesX = (viewportWidth + kTileSize - 1) / kTileSize;
+        m_TilesY = (viewportHeight + kTileSize - 1) / kTileSize;
+        int tileCount = m_TilesX * m_TilesY;
+
+        // Same letterbox and point size as Renderer::renderParticles()
+        float scaleFactor = std::min((float)viewportWidth / (float)simWidth, (float)viewportHeight / (float)simHeight);
+        m_NdcScaleX = (scaleFactor * simWidth) / viewportWidth;
+        m_NdcScaleY = (scaleFactor * simHeight) / viewportHeight;
+        m_HalfPointSize = std::max(scaleFactor * 1.5f, 1.0f) * 0.5f;
+
+        m_Particles = particles.data();
+        m_ParticleCount = particles.size();
+        m_Splats.resize(particles.size());
+        m_ChunkCount = (int)((particles.size() + kChunkSize - 1) / kChunkSize);
+
+        // Bins keep their capacity across frames; only the lists are emptied
+        size_t binCount = (size_t)m_ChunkCount * tileCount;
+        if (m_Bins.size() < binCount) {
+            m_Bins.resize(binCount);
+        }
+        for (size_t i = 0; i < binCount; ++i) {
+            m_Bins[i].clear();
+        }
+
+        runParallel(Phase::Bin, m_ChunkCount);
+        auto binEnd = std::chrono::steady_clock::now();
+        runParallel(Phase::Fill, tileCount);
+        auto fillEnd = std::chrono::steady_clock::now();
+
+        m_Stats.binMs = std::chrono::duration<float, std::milli>(binEnd - frameStart).count();
+        m_Stats.fillMs = std::chrono::duration<float, std::milli>(fillEnd - binEnd).count();
+        m_Stats.totalMs = std::chrono::duration<float, std::milli>(fillEnd - frameStart).count();
+        m_Stats.tileCount = tileCount;
+        m_Stats.binnedSplats = 0;
+        for (size_t i = 0; i < binCount; ++i) {
+            m_Stats.binnedSplats += m_Bins[i].size();
+        }
+        m_Particles = nullptr;
+    }
+
+    void SoftwareRasterizer::runParallel(Phase phase, int itemCount) {
+        if (itemCount <= 0) return;
+        m_Phase = phase;
+        m_ItemCount = itemCount;
+        m_NextItem.store(0, std::memory_order_relaxed);
+
+        if (!m_Workers.empty() && itemCount > 1) {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Busy = (int)m_Workers.size();
+                ++m_Generation;
+            }
+            m_WakeCondition.notify_all();
+            drainItems(phase);
+
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_DoneCondition.wait(lock, [this] { return m_Busy == 0; });
+        } else {
+            drainItems(phase);
+        }
+    }
+
+    void SoftwareRasterizer::drainItems(Phase phase) {
+        PROFILE_SCOPE(phase == Phase::Bin ? "Raster Bin" : "Raster Fill");
+        for (int item = m_NextItem.fetch_add(1); item < m_ItemCount; item = m_NextItem.fetch_add(1)) {
+            if (phase == Phase::Bin) {
+                binChunk(item);
+            } else {
+                fillTile(item);
+            }
+        }
+    }
+
+    void SoftwareRasterizer::workerLoop() {
+        CpuProfiler::setThreadName("Raster Worker");
+        uint64_t seenGeneration = 0;
+        while (true) {
+            Phase phase;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_WakeCondition.wait(lock, [&] { return m_Quit || m_Generation != seenGeneration; });
+                if (m_Quit) return;
+                seenGeneration = m_Generation;
+                phase = m_Phase;
+            }
+
+            drainItems(phase);
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (--m_Busy == 0) {
+                m_DoneCondition.notify_one();
+            }
+        }
+    }
+
+    void SoftwareRasterizer::binChunk(int chunk) {
+        size_t begin = (size_t)chunk * kChunkSize;
+        size_t end = std::min(begin + kChunkSize, m_ParticleCount);
+        int width = m_Framebuffer.cols;
+        int height = m_Framebuffer.rows;
+        int tileCount = m_TilesX * m_TilesY;
+        std::vector<uint32_t>* bins = &m_Bins[(size_t)chunk * tileCount];
+
+        for (size_t i = begin; i < end; ++i) {
+            const Particle& p = m_Particles[i];
+            Splat& splat = m_Splats[i];
+
+            // particle.vert: ndc = (pos * 2 - 1) * uScale with Y flipped. GL drops points
+            // whose center is clipped, so do the same.
+            float ndcX = (p.pos.x * 2.0f - 1.0f) * m_NdcScaleX;
+            float ndcY = (p.pos.y * 2.0f - 1.0f) * m_NdcScaleY;
+            if (!(std::abs(ndcX) <= 1.0f && std::abs(ndcY) <= 1.0f)) {
+                splat.x0 = splat.x1 = 0;
+                continue;
+            }
+
+            // Top-down pixel coordinates of the center; cover pixel centers in [c - half, c + half)
+            float cx = (1.0f + ndcX) * 0.5f * width;
+            float cy = (1.0f + ndcY) * 0.5f * height;
+            int x0 = std::max(0, (int)std::ceil(cx - m_HalfPointSize - 0.5f));
+            int x1 = std::min(width, (int)std::ceil(cx + m_HalfPointSize - 0.5f));
+            int y0 = std::max(0, (int)std::ceil(cy - m_HalfPointSize - 0.5f));
+            int y1 = std::min(height, (int)std::ceil(cy + m_HalfPointSize - 0.5f));
+            if (x0 >= x1 || y0 >= y1) {
+                splat.x0 = splat.x1 = 0;
+                continue;
+            }
+
+            splat.x0 = (uint16_t)x0;
+            splat.y0 = (uint16_t)y0;
+            splat.x1 = (uint16_t)x1;
+            splat.y1 = (uint16_t)y1;
+            splat.color = packColor(p.color);
+
+            int tx0 = x0 / kTileSize;
+            int tx1 = (x1 - 1) / kTileSize;
+            int ty0 = y0 / kTileSize;
+            int ty1 = (y1 - 1) / kTileSize;
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    bins[ty * m_TilesX + tx].push_back((uint32_t)i);
+                }
+            }
+        }
+    }
+
+    void SoftwareRasterizer::fillTile(int tile) {
+        int tileX0 = (tile % m_TilesX) * kTileSize;
+        int tileY0 = (tile / m_TilesX) * kTileSize;
+        int tileX1 = std::min(tileX0 + kTileSize, m_Framebuffer.cols);
+        int tileY1 = std::min(tileY0 + kTileSize, m_Framebuffer.rows);
+        int tileCount = m_TilesX * m_TilesY;
+
+        for (int y = tileY0; y < tileY1; ++y) {
+            fillSpan(m_Framebuffer.ptr<uint32_t>(y) + tileX0, tileX1 - tileX0, kClearColor);
+        }
+
+        // Chunks in order, indices within a chunk in order: global particle order
+        for (int chunk = 0; chunk < m_ChunkCount; ++chunk) {
+            for (uint32_t index : m_Bins[(size_t)chunk * tileCount + tile]) {
+                const Splat& splat = m_Splats[index];
+                int x0 = std::max<int>(splat.x0, tileX0);
+                int x1 = std::min<int>(splat.x1, tileX1);
+                int y0 = std::max<int>(splat.y0, tileY0);
+                int y1 = std::min<int>(splat.y1, tileY1);
+                for (int y = y0; y < y1; ++y) {
+                    fillSpan(m_Framebuffer.ptr<uint32_t>(y) + x0, x1 - x0, splat.color);
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../core/particle.h"
+
+namespace Graphics {
+
+    /**
+     * @struct SoftwareRasterStats
+     * @brief Timings and work counts of the last SoftwareRasterizer::renderParticles() call.
+     */
+    struct SoftwareRasterStats {
+        float binMs = 0.0f;      ///< Transform + binning into tiles
+        float fillMs = 0.0f;     ///< Tile clear + point fill
+        float totalMs = 0.0f;
+        size_t binnedSplats = 0; ///< Splat/tile pairs (a point straddling tiles counts once per tile)
+        int tileCount = 0;
+    };
+
+    /**
+     * @class SoftwareRasterizer
+     * @brief CPU backend for drawing particles into a cv::Mat, for machines without a GPU.
+     *
+     * Produces the same image as Renderer::renderParticles() on its point-sprite
+     * path: the same letterbox, square points of max(1, 1.5 * scale) pixels covering
+     * the pixel centers inside them, later particles drawn over earlier ones, and the
+     * Renderer::clear() background.
+     *
+     * A frame runs in two parallel phases on a persistent worker pool:
+     * 1. Bin: particles are split into contiguous chunks. Each chunk computes the
+     *    screen rectangle and packed color of its particles and appends their
+     *    indices to per-chunk lists for every tile they touch.
+     * 2. Fill: each tile is cleared and filled by one thread, walking the chunk
+     *    lists in order, so draw order matches the GL path without any locking.
+     * Row spans are written with 128-bit stores where SSE2 is available.
+     */
+    class SoftwareRasterizer {
+    public:
+        /**
+         * @param threadCount Threads used per frame, including the caller (0 = all hardware threads).
+         */
+        explicit SoftwareRasterizer(int threadCount = 0);
+        ~SoftwareRasterizer();
+
+        SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+        SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+        /**
+         * @brief Draws particles into the framebuffer, resizing it to the viewport if needed.
+         * @param particles Particles to draw.
+         * @param viewportWidth Framebuffer width in pixels.
+         * @param viewportHeight Framebuffer height in pixels.
+         * @param simWidth Simulation grid width (number of particles horizontally).
+         * @param simHeight Simulation grid height (number of particles vertically).
+         */
+        void renderParticles(const std::vector<Particle>& particles, int viewportWidth, int viewportHeight, int simWidth, int simHeight);
+
+        /**
+         * @brief Result of the last renderParticles() call: CV_8UC4 BGRA, top row first.
+         */
+        const cv::Mat& getFramebuffer() const { return m_Framebuffer; }
+
+        int getThreadCount() const { return (int)m_Workers.size() + 1; }
+        const SoftwareRasterStats& getStats() const { return m_Stats; }
+
+        static constexpr int kTileSize = 64;
+        static constexpr size_t kChunkSize = 16384; ///< Particles per binning work item
+
+    private:
+        /**
+         * @brief Screen rectangle of one point, clipped to the framebuffer, with end bounds exclusive.
+         */
+        struct Splat {
+            uint16_t x0, y0, x1, y1;
+            uint32_t color; ///< BGRA, as laid out in the framebuffer
+        };
+
+        enum class Phase { Bin, Fill };
+
+        /**
+         * @brief Runs itemCount work items of a phase on the pool and the calling thread; returns when all are done.
+         */
+        void runParallel(Phase phase, int itemCount);
+        void drainItems(Phase phase);
+        void workerLoop();
+
+        void binChunk(int chunk);
+        void fillTile(int tile);
+
+        std::vector<std::thread> m_Workers;
+        std::mutex m_Mutex;
+        std::condition_variable m_WakeCondition;
+        std::condition_variable m_DoneCondition;
+        uint64_t m_Generation = 0;  ///< Bumped to start a phase
+        int m_Busy = 0;             ///< Workers still running the current phase
+        bool m_Quit = false;
+        Phase m_Phase = Phase::Bin;
+        int m_ItemCount = 0;
+        std::atomic<int> m_NextItem{0};
+
+        // Per-frame inputs
+        const Particle* m_Particles = nullptr;
+        size_t m_ParticleCount = 0;
+        float m_NdcScaleX = 1.0f;
+        float m_NdcScaleY = 1.0f;
+        float m_HalfPointSize = 0.5f;
+
+        cv::Mat m_Framebuffer;
+        int m_TilesX = 0;
+        int m_TilesY = 0;
+        std::vector<Splat> m_Splats;                    ///< One per particle
+        std::vector<std::vector<uint32_t>> m_Bins;      ///< [chunk * tileCount + tile] -> particle indices
+        int m_ChunkCount = 0;
+
+        SoftwareRasterStats m_Stats;
+    };
+
+}
@@ -0,0 +1,299 @@
+#include "stroke_history.h"
+#include "canvas.h"
+#include "../core/cpu_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+StrokeHistory::StrokeHistory(Canvas& canvas, size_t budgetBytes)
+    : m_canvas(canvas), m_budget(budgetBytes)
+{
+    // Base state: the blank canvas
+    Keyframe base;
+    base.id = ++m_nextKeyframeId;
+    m_keyframes.push_back(std::move(base));
+}
+
+StrokeHistory::~StrokeHistory() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        m_jobs.clear();
+    }
+    m_wake.notify_one();
+    if (m_encoder.joinable()) {
+        m_encoder.join();
+    }
+}
+
+void StrokeHistory::update() {
+    // The GPU finished the keyframe snapshot: encode it off the UI thread
+    if (m_snapshotKeyframe) {
+        cv::Mat image;
+        if (m_canvas.collectSnapshot(image)) {
+            uint64_t id = m_snapshotKeyframe;
+            m_snapshotKeyframe = 0;
+
+            // Skip keyframes dropped with a redo tail while the read was in flight
+            if (findKeyframe(id)) {
+                EncodeJob job;
+                job.keyframeId = id;
+                job.image = std::move(image);
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_encoder.joinable()) {
+                        m_encoder = std::thread(&StrokeHistory::runEncoder, this);
+                    }
+                    m_jobs.push_back(std::move(job));
+                }
+                m_wake.notify_one();
+            }
+        }
+    }
+
+    bool installed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (EncodeJob& job : m_encoded) {
+            Keyframe* keyframe = findKeyframe(job.keyframeId);
+            if (!keyframe) continue;
+
+            if (!job.ok) {
+                // Unusable; undo falls back to the keyframe before it
+                std::cerr << "StrokeHistory: Failed to encode keyframe!" << std::endl;
+                m_keyframes.erase(m_keyframes.begin() + (keyframe - m_keyframes.data()));
+                continue;
+            }
+            keyframe->png = std::move(job.png);
+            keyframe->ready = true;
+            m_keyframeBytes += keyframe->png.size();
+            installed = true;
+        }
+        m_encoded.clear();
+    }
+
+    // Encoded sizes are only known now
+    if (installed) trimToBudget();
+}
+
+size_t StrokeHistory::getPendingKeyframeCount() const {
+    return (size_t)std::count_if(m_keyframes.begin(), m_keyframes.end(),
+                                 [](const Keyframe& keyframe) { return !keyframe.ready; });
+}
+
+StrokeHistory::Keyframe* StrokeHistory::findKeyframe(uint64_t id) {
+    for (Keyframe& keyframe : m_keyframes) {
+        if (keyframe.id == id) return &keyframe;
+    }
+    return nullptr;
+}
+
+void StrokeHistory::runEncoder() {
+    CpuProfiler::setThreadName("Keyframe Encoder");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_quit || !m_jobs.empty(); });
+        if (m_quit) return;
+
+        EncodeJob job = std::move(m_jobs.front());
+        m_jobs.erase(m_jobs.begin());
+        lock.unlock();
+        {
+            PROFILE_SCOPE("Keyframe Encode");
+            // Fast PNG compression: drawings are mostly flat color and compress very well
+            static const std::vector<int> params = { cv::IMWRITE_PNG_COMPRESSION, 1 };
+            job.ok = cv::imencode(".png", job.image, job.png, params);
+            job.png.shrink_to_fit();
+            job.image.release();
+        }
+        lock.lock();
+        m_encoded.push_back(std::move(job));
+    }
+}
+
+void StrokeHistory::beginStroke(glm::vec3 color, float size) {
+    m_pending = CanvasCommand();
+    m_pending.type = CanvasCommand::Type::Stroke;
+    m_pending.color = color;
+    m_pending.size = size;
+    m_recording = true;
+}
+
+void StrokeHistory::extendStroke(glm::vec2 point) {
+    if (!m_recording) return;
+
+    // A stationary cursor re-stamps the same dab, which changes nothing
+    if (!m_pending.points.empty() && m_pending.points.back() == point) return;
+    m_pending.points.push_back(point);
+}
+
+void StrokeHistory::endStroke() {
+    if (!m_recording) return;
+    m_recording = false;
+
+    if (m_pending.points.empty()) return;
+    m_pending.points.shrink_to_fit();
+    push(std::move(m_pending));
+    m_pending = CanvasCommand();
+}
+
+void StrokeHistory::recordFill(glm::vec2 seed, glm::vec3 color, int tolerance) {
+    CanvasCommand command;
+    command.type = CanvasCommand::Type::Fill;
+    command.color = color;
+    command.tolerance = tolerance;
+    command.points.push_back(seed);
+    push(std::move(command));
+}
+
+void StrokeHistory::recordClear() {
+    CanvasCommand command;
+    command.type = CanvasCommand::Type::Clear;
+    push(std::move(command));
+}
+
+/**
+ * @brief Appends a command at the cursor, discarding the redo tail.
+ */
+void StrokeHistory::push(CanvasCommand command) {
+    // Drop undone commands and the keyframes that depend on them
+    for (size_t i = m_cursor; i < m_commands.size(); ++i) {
+        m_commandBytes -= commandBytes(m_commands[i]);
+    }
+    m_commands.resize(m_cursor);
+    while (m_keyframes.size() > 1 && m_keyframes.back().commandIndex > m_cursor) {
+        m_keyframeBytes -= m_keyframes.back().png.size();
+        m_keyframes.pop_back();
+    }
+
+    bool isClear = command.type == CanvasCommand::Type::Clear;
+    m_commandBytes += commandBytes(command);
+    m_commands.push_back(std::move(command));
+    ++m_cursor;
+
+    // A clear leaves a blank canvas, which makes a free keyframe
+    if (isClear || m_cursor - m_keyframes.back().commandIndex >= kKeyframeInterval) {
+        captureKeyframe(isClear);
+    }
+
+    trimToBudget();
+}
+
+/**
+ * @brief Adds a keyframe for the current cursor.
+ *
+ * Non-blank keyframes start pending: the canvas read is queued on the GPU now (so
+ * it captures exactly this state) and update() encodes and installs it later.
+ * With a snapshot already in flight the keyframe is skipped; the next push retries.
+ */
+void StrokeHistory::captureKeyframe(bool blank) {
+    if (!blank && m_snapshotKeyframe) return;
+
+    Keyframe keyframe;
+    keyframe.id = ++m_nextKeyframeId;
+    keyframe.commandIndex = m_cursor;
+
+    if (!blank) {
+        m_canvas.requestSnapshot();
+        keyframe.ready = false;
+        m_snapshotKeyframe = keyframe.id;
+    }
+    m_keyframes.push_back(std::move(keyframe));
+}
+
+bool StrokeHistory::undo() {
+    if (!canUndo()) return false;
+    auto startTime = std::chrono::steady_clock::now();
+
+    size_t target = m_cursor - 1;
+
+    // Nearest keyframe at or before the target state
+    auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), target,
+        [](size_t index, const Keyframe& keyframe) { return index < keyframe.commandIndex; });
+    // Pending keyframes can't be restored yet; the base keyframe always can
+    while (!(it - 1)->ready) --it;
+    const Keyframe& keyframe = *(it - 1);
+
+    restore(keyframe);
+    for (size_t i = keyframe.commandIndex; i < target; ++i) {
+        apply(m_commands[i]);
+    }
+    m_cursor = target;
+
+    m_lastReplayCount = (int)(target - keyframe.commandIndex);
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    m_lastUndoMs = elapsed.count();
+    return true;
+}
+
+bool StrokeHistory::redo() {
+    if (!canRedo()) return false;
+    apply(m_commands[m_cursor]);
+    ++m_cursor;
+    return true;
+}
+
+void StrokeHistory::setBudget(size_t bytes) {
+    m_budget = bytes;
+    trimToBudget();
+}
+
+void StrokeHistory::apply(const CanvasCommand& command) {
+    switch (command.type) {
+        case CanvasCommand::Type::Stroke:
+            m_canvas.drawPolyline(command.points, command.color, command.size);
+            break;
+        case CanvasCommand::Type::Fill:
+            m_canvas.floodFill(command.points[0], command.color, command.tolerance);
+            break;
+        case CanvasCommand::Type::Clear:
+            m_canvas.clear();
+            break;
+    }
+}
+
+void StrokeHistory::restore(const Keyframe& keyframe) {
+    if (keyframe.png.empty()) {
+        m_canvas.clear();
+        return;
+    }
+
+    cv::Mat image = cv::imdecode(keyframe.png, cv::IMREAD_COLOR);
+    if (image.empty()) {
+        std::cerr << "StrokeHistory: Failed to decode keyframe!" << std::endl;
+        return;
+    }
+    m_canvas.loadFromMat(image);
+}
+
+/**
+ * @brief Drops the oldest history until the log fits the budget.
+ *
+ * History can only be dropped a whole keyframe interval at a time, never past
+ * the cursor and never onto a pending keyframe (the base must be restorable),
+ * so the usage may stay above the budget until more commands are pushed.
+ */
+void StrokeHistory::trimToBudget() {
+    while (getMemoryUsage() > m_budget && m_keyframes.size() > 1 && m_keyframes[1].ready &&
+           m_keyframes[1].commandIndex <= m_cursor) {
+        size_t dropped = m_keyframes[1].commandIndex;
+
+        for (size_t i = 0; i < dropped; ++i) {
+            m_commandBytes -= commandBytes(m_commands[i]);
+        }
+        m_commands.erase(m_commands.begin(), m_commands.begin() + dropped);
+
+        m_keyframeBytes -= m_keyframes[0].png.size();
+        m_keyframes.erase(m_keyframes.begin());
+        for (Keyframe& keyframe : m_keyframes) {
+            keyframe.commandIndex -= dropped;
+        }
+        m_cursor -= dropped;
+    }
+}
+
+size_t StrokeHistory::commandBytes(const CanvasCommand& command) {
+    return sizeof(CanvasCommand) + command.points.capacity() * sizeof(glm::vec2);
+}
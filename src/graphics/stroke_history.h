@@ -0,0 +1,198 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Canvas;
+
+/**
+ * @struct CanvasCommand
+ * @brief One recorded canvas edit, small enough to keep thousands in memory.
+ */
+struct CanvasCommand {
+    enum class Type { Stroke, Fill, Clear };
+
+    Type type = Type::Stroke;
+    glm::vec3 color = glm::vec3(1.0f);  ///< RGB color (0-1 range); eraser strokes are white
+    float size = 0.0f;                  ///< Brush size in canvas pixels (strokes only)
+    int tolerance = 0;                  ///< Per-channel tolerance (fills only)
+    std::vector<glm::vec2> points;      ///< Stroke polyline, or the fill seed
+};
+
+/**
+ * @class StrokeHistory
+ * @brief Undo/redo for a Canvas via a command log and compressed keyframes.
+ *
+ * Every edit is stored as a CanvasCommand. Every few commands the canvas is
+ * snapshotted into a PNG-compressed keyframe. Undo restores the nearest keyframe
+ * before the target and replays the remaining commands through the batched
+ * stroke renderer; redo applies the next command directly. When the log exceeds
+ * its memory budget, the oldest keyframe and the commands before the next one
+ * are dropped.
+ *
+ * Keyframes never stall a stroke: the snapshot is an asynchronous canvas read
+ * (Canvas::requestSnapshot()) and the PNG encode runs on a worker thread. Until
+ * update() installs it, a keyframe is pending and undo falls back to the one
+ * before it.
+ */
+class StrokeHistory {
+public:
+    /**
+     * @brief Constructs a history for a canvas that is currently blank.
+     *
+     * @param canvas The canvas edits are applied to. Must outlive the history.
+     * @param budgetBytes Memory budget for commands and keyframes.
+     */
+    explicit StrokeHistory(Canvas& canvas, size_t budgetBytes = 64 * 1024 * 1024);
+    ~StrokeHistory();
+
+    StrokeHistory(const StrokeHistory&) = delete;
+    StrokeHistory& operator=(const StrokeHistory&) = delete;
+
+    /**
+     * @brief Hands finished keyframe snapshots to the encoder and installs encoded keyframes.
+     *
+     * Call once per frame from the GL thread. Never blocks.
+     */
+    void update();
+
+    /**
+     * @brief Starts recording a stroke (the caller draws it live).
+     */
+    void beginStroke(glm::vec3 color, float size);
+
+    /**
+     * @brief Appends a point to the stroke being recorded.
+     */
+    void extendStroke(glm::vec2 point);
+
+    /**
+     * @brief Finishes the current stroke and commits it to the log.
+     */
+    void endStroke();
+
+    /**
+     * @brief Records a flood fill that has already been applied to the canvas.
+     */
+    void recordFill(glm::vec2 seed, glm::vec3 color, int tolerance);
+
+    /**
+     * @brief Records a canvas clear that has already been applied.
+     */
+    void recordClear();
+
+    /**
+     * @brief Reverts the last applied command.
+     * @return true If there was something to undo.
+     */
+    bool undo();
+
+    /**
+     * @brief Re-applies the last undone command.
+     * @return true If there was something to redo.
+     */
+    bool redo();
+
+    bool canUndo() const { return m_cursor > 0; }
+    bool canRedo() const { return m_cursor < m_commands.size(); }
+    bool isRecordingStroke() const { return m_recording; }
+
+    /**
+     * @brief Sets the memory budget and trims the log to fit.
+     */
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return m_budget; }
+
+    /**
+     * @brief Bytes used by the command log and keyframes.
+     */
+    size_t getMemoryUsage() const { return m_commandBytes + m_keyframeBytes; }
+    size_t getKeyframeBytes() const { return m_keyframeBytes; }
+
+    size_t getCommandCount() const { return m_commands.size(); }
+    size_t getKeyframeCount() const { return m_keyframes.size(); }
+    size_t getPendingKeyframeCount() const;
+    size_t getCursor() const { return m_cursor; }
+
+    /**
+     * @brief Duration of the last undo (keyframe restore + replay) in milliseconds.
+     */
+    float getLastUndoMs() const { return m_lastUndoMs; }
+
+    /**
+     * @brief Commands replayed by the last undo.
+     */
+    int getLastReplayCount() const { return m_lastReplayCount; }
+
+    /**
+     * @brief Commands between keyframes.
+     */
+    static constexpr size_t kKeyframeInterval = 16;
+
+private:
+    /**
+     * @struct Keyframe
+     * @brief Canvas state before commands[commandIndex], PNG-compressed.
+     *
+     * An empty image means a blank (white) canvas, which is free to store.
+     */
+    struct Keyframe {
+        uint64_t id = 0;
+        size_t commandIndex = 0;
+        std::vector<unsigned char> png;
+        bool ready = true;  ///< False while its snapshot is being read back or encoded
+    };
+
+    /**
+     * @struct EncodeJob
+     * @brief A keyframe snapshot waiting for, or returned from, the encoder thread.
+     */
+    struct EncodeJob {
+        uint64_t keyframeId = 0;
+        cv::Mat image;
+        std::vector<unsigned char> png;
+        bool ok = false;
+    };
+
+    void push(CanvasCommand command);
+    Keyframe* findKeyframe(uint64_t id);
+    void runEncoder();
+    void apply(const CanvasCommand& command);
+    void restore(const Keyframe& keyframe);
+    void captureKeyframe(bool blank);
+    void trimToBudget();
+    static size_t commandBytes(const CanvasCommand& command);
+
+    Canvas& m_canvas;
+
+    std::vector<CanvasCommand> m_commands;
+    std::vector<Keyframe> m_keyframes;  ///< Sorted by commandIndex; m_keyframes[0] is the base state
+    size_t m_cursor = 0;                ///< Number of commands currently applied
+
+    CanvasCommand m_pending;            ///< Stroke being recorded
+    bool m_recording = false;
+
+    uint64_t m_nextKeyframeId = 0;
+    uint64_t m_snapshotKeyframe = 0;    ///< Keyframe whose canvas snapshot is in flight (0 = none)
+
+    // Encoder thread (started with the first keyframe snapshot)
+    std::thread m_encoder;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit = false;
+    std::vector<EncodeJob> m_jobs;      ///< Snapshots waiting to be encoded
+    std::vector<EncodeJob> m_encoded;   ///< Finished encodes, installed by update()
+
+    size_t m_budget;
+    size_t m_commandBytes = 0;
+    size_t m_keyframeBytes = 0;
+
+    float m_lastUndoMs = 0.0f;
+    int m_lastReplayCount = 0;
+};
@@ -62,7 +62,7 @@ void Texture2D::uploadFromOpenCV(const cv::Mat& mat) {
 
     GLenum format = GL_RGB;
     if (uploadMat.channels() == 4) {
-        format = GL_RGBA;
+        format = GL_BGRA; // OpenCV's 4-channel order
         m_internalFormat = GL_RGBA8;
     } else if (uploadMat.channels() == 3) {
         format = GL_BGR; // OpenCV uses BGR by default
@@ -0,0 +1,297 @@
+#include "batch_runner.h"
+#include "../core/simulation.h"
+#include "../graphics/software_rasterizer.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace Headless {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double msSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        bool isImagePath(const std::string& path) {
+            std::string ext = std::filesystem::path(path).extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+            return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tif" || ext == ".tiff";
+        }
+
+        bool parseSize(const std::string& text, int& width, int& height) {
+            return std::sscanf(text.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+        }
+
+        /**
+         * @brief Applies "--flag value" pairs to a job. Flags not describing a job are left to the caller.
+         */
+        bool parseJobArgs(const std::vector<std::string>& args, BatchJob& job, int* parallel, std::string* jobsFile) {
+            for (size_t i = 0; i < args.size(); ++i) {
+                const std::string& flag = args[i];
+                if (flag == "--headless") continue;
+                if (i + 1 >= args.size()) {
+                    std::cerr << "Headless: Missing value for " << flag << std::endl;
+                    return false;
+                }
+                const std::string& value = args[++i];
+
+                bool ok = true;
+                if (flag == "--source") job.source = value;
+                else if (flag == "--target") job.target = value;
+                else if (flag == "--output") job.output = value;
+                else if (flag == "--size") ok = parseSize(value, job.simWidth, job.simHeight);
+                else if (flag == "--render") ok = parseSize(value, job.renderWidth, job.renderHeight);
+                else if (flag == "--frames") ok = (job.frames = std::atoi(value.c_str())) > 0;
+                else if (flag == "--speed") job.physics.particleSpeed = (float)std::atof(value.c_str());
+                else if (flag == "--flow") job.physics.flowStrength = (float)std::atof(value.c_str());
+                else if (flag == "--noise") job.physics.noiseScale = (float)std::atof(value.c_str());
+                else if (flag == "--parallel" && parallel) ok = (*parallel = std::atoi(value.c_str())) > 0;
+                else if (flag == "--jobs" && jobsFile) *jobsFile = value;
+                else {
+                    std::cerr << "Headless: Unknown option " << flag << std::endl;
+                    return false;
+                }
+                if (!ok) {
+                    std::cerr << "Headless: Invalid value for " << flag << ": " << value << std::endl;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool validateJob(const BatchJob& job) {
+            if (job.source.empty() || job.target.empty() || job.output.empty()) {
+                std::cerr << "Headless: A job needs --source, --target and --output" << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        void printUsage() {
+            std::cout << "Usage:\n"
+                      << "  LumaSort --headless --source S --target T --output O [options]\n"
+                      << "  LumaSort --headless --jobs FILE [--parallel N]\n\n"
+                      << "  --output O     Image file for the final frame, or a directory for every frame\n"
+                      << "  --size WxH     Simulation grid (default: source size, capped at 800)\n"
+                      << "  --render WxH   Output resolution (default 1280x720)\n"
+                      << "  --frames N     Physics steps (default 300)\n"
+                      << "  --speed F, --flow F, --noise F   Physics parameters\n"
+                      << "  --parallel N   Jobs run at once (default: hardware threads)\n"
+                      << "  A jobs file holds one job per line, using the options above." << std::endl;
+        }
+
+    }
+
+    BatchResult runJob(const BatchJob& job, int rasterThreads) {
+        BatchResult result;
+        Clock::time_point jobStart = Clock::now();
+
+        // Load
+        Clock::time_point start = Clock::now();
+        cv::Mat source = cv::imread(job.source);
+        cv::Mat target = cv::imread(job.target);
+        result.loadMs = msSince(start);
+        if (source.empty() || target.empty()) {
+            result.error = "failed to load " + (source.empty() ? job.source : job.target);
+            return result;
+        }
+
+        // Same sizing as App::loadSourceImage()
+        int simWidth = job.simWidth;
+        int simHeight = job.simHeight;
+        if (simWidth <= 0 || simHeight <= 0) {
+            fitImageGrid(source.cols, source.rows, 800, simWidth, simHeight);
+        }
+        result.simWidth = simWidth;
+        result.simHeight = simHeight;
+
+        Simulation simulation;
+        simulation.setParams(job.physics);
+        simulation.reset(simWidth, simHeight);
+        simulation.setColors(source);
+
+        // Sort
+        start = Clock::now();
+        bool sorted = simulation.sortTo(source, target);
+        result.sortMs = msSince(start);
+        if (!sorted) {
+            result.error = "sorting produced no mapping";
+            return result;
+        }
+
+        bool writeSequence = !isImagePath(job.output);
+        if (writeSequence) {
+            std::error_code ec;
+            std::filesystem::create_directories(job.output, ec);
+            if (ec) {
+                result.error = "cannot create " + job.output + ": " + ec.message();
+                return result;
+            }
+        }
+
+        // Simulate (and write every frame for sequences)
+        Graphics::SoftwareRasterizer rasterizer(rasterThreads);
+        cv::Mat image;
+        const std::vector<Particle>& particles = simulation.getParticles();
+        char name[32];
+        for (int frame = 0; frame < job.frames; ++frame) {
+            start = Clock::now();
+            simulation.step();
+            result.simulateMs += msSince(start);
+
+            if (!writeSequence) continue;
+
+            start = Clock::now();
+            rasterizer.renderParticles(particles, job.renderWidth, job.renderHeight, simWidth, simHeight);
+            result.rasterMs += msSince(start);
+
+            start = Clock::now();
+            cv::cvtColor(rasterizer.getFramebuffer(), image, cv::COLOR_BGRA2BGR);
+            std::snprintf(name, sizeof(name), "frame_%05d.png", frame);
+            if (!cv::imwrite((std::filesystem::path(job.output) / name).string(), image)) {
+                result.error = "failed to write " + std::string(name);
+                return result;
+            }
+            result.writeMs += msSince(start);
+            ++result.framesWritten;
+        }
+
+        if (!writeSequence) {
+            start = Clock::now();
+            rasterizer.renderParticles(particles, job.renderWidth, job.renderHeight, simWidth, simHeight);
+            result.rasterMs += msSince(start);
+
+            start = Clock::now();
+            cv::cvtColor(rasterizer.getFramebuffer(), image, cv::COLOR_BGRA2BGR);
+            if (!cv::imwrite(job.output, image)) {
+                result.error = "failed to write " + job.output;
+                return result;
+            }
+            result.writeMs += msSince(start);
+            result.framesWritten = 1;
+        }
+
+        result.totalMs = msSince(jobStart);
+        result.ok = true;
+        return result;
+    }
+
+    int runBatch(int argc, char** argv) {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        if (std::find(args.begin(), args.end(), "--help") != args.end()) {
+            printUsage();
+            return 0;
+        }
+
+        BatchJob defaults;
+        int parallel = (int)std::max(1u, std::thread::hardware_concurrency());
+        std::string jobsFile;
+        if (!parseJobArgs(args, defaults, &parallel, &jobsFile)) {
+            printUsage();
+            return 2;
+        }
+
+        std::vector<BatchJob> jobs;
+        if (jobsFile.empty()) {
+            if (!validateJob(defaults)) {
+                printUsage();
+                return 2;
+            }
+            jobs.push_back(defaults);
+        } else {
+            // Options on the command line are defaults; each line overrides them
+            std::ifstream file(jobsFile);
+            if (!file.is_open()) {
+                std::cerr << "Headless: Cannot open jobs file " << jobsFile << std::endl;
+                return 2;
+            }
+            std::string line;
+            int lineNumber = 0;
+            while (std::getline(file, line)) {
+                ++lineNumber;
+                std::istringstream tokens(line);
+                std::vector<std::string> lineArgs;
+                for (std::string token; tokens >> token;) {
+                    if (token[0] == '#') break;
+                    lineArgs.push_back(token);
+                }
+                if (lineArgs.empty()) continue;
+
+                BatchJob job = defaults;
+                if (!parseJobArgs(lineArgs, job, nullptr, nullptr) || !validateJob(job)) {
+                    std::cerr << "Headless: Invalid job on line " << lineNumber << " of " << jobsFile << std::endl;
+                    return 2;
+                }
+                jobs.push_back(job);
+            }
+        }
+        if (jobs.empty()) {
+            std::cerr << "Headless: No jobs to run" << std::endl;
+            return 2;
+        }
+
+        int workerCount = std::min(parallel, (int)jobs.size());
+
+        // Jobs are the unit of parallelism; OpenCV's own pool would only oversubscribe
+        if (workerCount > 1) cv::setNumThreads(1);
+
+        std::vector<BatchResult> results(jobs.size());
+        std::atomic<size_t> nextJob{0};
+        std::mutex printMutex;
+        Clock::time_point batchStart = Clock::now();
+
+        auto worker = [&]() {
+            for (size_t i = nextJob.fetch_add(1); i < jobs.size(); i = nextJob.fetch_add(1)) {
+                // Parallel jobs already fill the machine; a lone job rasterizes on every core
+                results[i] = runJob(jobs[i], workerCount > 1 ? 1 : 0);
+                const BatchResult& r = results[i];
+
+                std::lock_guard<std::mutex> lock(printMutex);
+                if (!r.ok) {
+                    std::cerr << "[" << i + 1 << "/" << jobs.size() << "] " << jobs[i].source << " -> "
+                              << jobs[i].target << " FAILED: " << r.error << std::endl;
+                    continue;
+                }
+                std::cout << "[" << i + 1 << "/" << jobs.size() << "] " << jobs[i].source << " -> " << jobs[i].target
+                          << " (" << r.simWidth << "x" << r.simHeight << ", " << jobs[i].frames << " frames): "
+                          << "load " << r.loadMs << " ms, sort " << r.sortMs << " ms, simulate " << r.simulateMs
+                          << " ms, raster " << r.rasterMs << " ms, write " << r.writeMs << " ms, total "
+                          << r.totalMs << " ms" << std::endl;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 1; i < workerCount; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : workers) {
+            thread.join();
+        }
+
+        double wallMs = msSince(batchStart);
+        size_t succeeded = 0;
+        double cpuMs = 0.0;
+        for (const BatchResult& r : results) {
+            if (r.ok) ++succeeded;
+            cpuMs += r.totalMs;
+        }
+        std::cout << succeeded << "/" << jobs.size() << " jobs succeeded in " << wallMs << " ms on "
+                  << workerCount << " thread(s) (" << cpuMs << " ms of job time, "
+                  << jobs.size() * 1000.0 / std::max(wallMs, 0.001) << " jobs/s)" << std::endl;
+
+        return succeeded == jobs.size() ? 0 : 1;
+    }
+
+}
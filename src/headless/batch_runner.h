@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../core/physics.h"
+
+namespace Headless {
+
+    /**
+     * @struct BatchJob
+     * @brief One source/target transform to run without a window.
+     */
+    struct BatchJob {
+        std::string source;       ///< Source image path
+        std::string target;       ///< Target image path
+        std::string output;       ///< Final image file (.png/.jpg/...) or a directory for every frame
+        int simWidth = 0;         ///< Simulation grid (0 = derive from the source, capped at 800)
+        int simHeight = 0;
+        int renderWidth = 1280;   ///< Size of the written images
+        int renderHeight = 720;
+        int frames = 300;         ///< Physics steps to run
+        PhysicsParams physics;
+    };
+
+    /**
+     * @struct BatchResult
+     * @brief Outcome and stage timings of a BatchJob, in milliseconds.
+     */
+    struct BatchResult {
+        bool ok = false;
+        std::string error;
+        int simWidth = 0;
+        int simHeight = 0;
+        double loadMs = 0.0;
+        double sortMs = 0.0;
+        double simulateMs = 0.0;
+        double rasterMs = 0.0;
+        double writeMs = 0.0;
+        double totalMs = 0.0;
+        int framesWritten = 0;
+    };
+
+    /**
+     * @brief Runs a job to completion on the calling thread. No GL or window is used.
+     * @param rasterThreads Threads for the software rasterizer (0 = all hardware threads).
+     */
+    BatchResult runJob(const BatchJob& job, int rasterThreads = 0);
+
+    /**
+     * @brief Entry point for `LumaSort --headless ...`.
+     *
+     * Usage:
+     *   LumaSort --headless --source S --target T --output O [options]
+     *   LumaSort --headless --jobs FILE [--parallel N]
+     *
+     * Options: --size WxH, --render WxH, --frames N, --speed F, --flow F, --noise F,
+     * --parallel N. A jobs file has one job per line, written with the same
+     * options as the single-job form (blank lines and '#' comments are skipped).
+     *
+     * @return Process exit code (0 if every job succeeded).
+     */
+    int runBatch(int argc, char** argv);
+
+}
@@ -0,0 +1,12 @@
+/**
+ * LumaSort Headless Runner - Entry Point
+ *
+ * Same batch runner as `LumaSort --headless`, built against lumasort_core only,
+ * so it runs on servers without a display, GL driver or GUI libraries.
+ */
+
+#include "batch_runner.h"
+
+int main(int argc, char** argv) {
+    return Headless::runBatch(argc, argv);
+}
@@ -0,0 +1,144 @@
+#include "frame_encoder.h"
+#include "../core/cpu_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+FrameEncoder::~FrameEncoder() {
+    close();
+}
+
+bool FrameEncoder::open(const std::string& path, int width, int height, double fps, EncoderFormat format) {
+    close();
+
+    m_path = path;
+    m_format = format;
+    m_failed = false;
+
+    if (format == EncoderFormat::VIDEO) {
+        // MJPG for .avi (universally available), MPEG-4 Part 2 otherwise
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        int fourcc = extension == ".avi" ? cv::VideoWriter::fourcc('M', 'J', 'P', 'G')
+                                         : cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+        if (!m_writer.open(path, fourcc, fps, cv::Size(width, height), true)) {
+            std::cerr << "FrameEncoder: Could not open video writer for " << path << std::endl;
+            m_failed = true;
+            return false;
+        }
+    } else {
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        if (!std::filesystem::is_directory(path)) {
+            std::cerr << "FrameEncoder: Could not create directory " << path << std::endl;
+            m_failed = true;
+            return false;
+        }
+    }
+
+    // Preallocate the queue so the render loop only ever copies into existing buffers
+    m_queue.forEachSlot([&](cv::Mat& slot) {
+        slot.create(height, width, CV_8UC4);
+    });
+
+    m_closing = false;
+    m_discard = false;
+    m_framesEncoded = 0;
+    m_encodeMs = 0.0f;
+    m_thread = std::thread(&FrameEncoder::encodeLoop, this);
+    return true;
+}
+
+void FrameEncoder::close() {
+    m_closing.store(true, std::memory_order_release);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_writer.isOpened()) {
+        m_writer.release();
+        // VideoWriter::write() reports nothing, so a backend that failed to write
+        // (disk full, muxer error) only shows as a missing or empty file
+        if (!m_discard.load(std::memory_order_relaxed) && m_framesEncoded.load(std::memory_order_relaxed) > 0) {
+            std::error_code error;
+            uintmax_t size = std::filesystem::file_size(m_path, error);
+            if ((error || size == 0) && !m_failed.exchange(true)) {
+                std::cerr << "FrameEncoder: Nothing was written to " << m_path << std::endl;
+            }
+        }
+    }
+}
+
+void FrameEncoder::abort() {
+    m_discard.store(true, std::memory_order_release);
+    close();
+}
+
+cv::Mat* FrameEncoder::beginFrame() {
+    if (!isOpen()) return nullptr;
+    return m_queue.beginWrite();
+}
+
+void FrameEncoder::commitFrame() {
+    m_queue.commitWrite();
+}
+
+void FrameEncoder::encodeLoop() {
+    CpuProfiler::setThreadName("Encoder");
+    cv::Mat flipped, bgr;
+    std::vector<int> pngParams = { cv::IMWRITE_PNG_COMPRESSION, 1 };
+    char fileName[32];
+
+    while (true) {
+        if (m_discard.load(std::memory_order_acquire)) {
+            while (m_queue.beginRead()) m_queue.endRead();
+            break;
+        }
+
+        cv::Mat* frame = m_queue.beginRead();
+        if (!frame) {
+            // Drain everything that was queued before closing
+            if (m_closing.load(std::memory_order_acquire)) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        PROFILE_SCOPE("Encode");
+        auto start = std::chrono::steady_clock::now();
+
+        // GL rows are bottom-up and BGRA
+        cv::flip(*frame, flipped, 0);
+        m_queue.endRead(); // Slot is free as soon as it has been copied out
+        cv::cvtColor(flipped, bgr, cv::COLOR_BGRA2BGR);
+
+        uint64_t index = m_framesEncoded.load(std::memory_order_relaxed);
+        if (m_format == EncoderFormat::VIDEO) {
+            bool written = m_writer.isOpened();
+            if (written) {
+                try {
+                    m_writer.write(bgr);
+                } catch (const cv::Exception& exception) {
+                    std::cerr << "FrameEncoder: " << exception.what() << std::endl;
+                    written = false;
+                }
+            }
+            if (!written && !m_failed.exchange(true)) {
+                std::cerr << "FrameEncoder: Failed to write frame " << index << " to " << m_path << std::endl;
+            }
+        } else {
+            snprintf(fileName, sizeof(fileName), "frame_%05llu.png", (unsigned long long)index);
+            if (!cv::imwrite((std::filesystem::path(m_path) / fileName).string(), bgr, pngParams)) {
+                if (!m_failed.exchange(true)) {
+                    std::cerr << "FrameEncoder: Failed to write " << fileName << std::endl;
+                }
+            }
+        }
+        m_framesEncoded.store(index + 1, std::memory_order_relaxed);
+
+        std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        float encodeMs = m_encodeMs.load(std::memory_order_relaxed);
+        m_encodeMs.store(encodeMs == 0.0f ? elapsed.count() : encodeMs * 0.9f + elapsed.count() * 0.1f,
+                         std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include "../core/spsc_ring.h"
+
+/**
+ * @enum EncoderFormat
+ * @brief Output container of a FrameEncoder.
+ */
+enum class EncoderFormat {
+    VIDEO,        ///< Single video file through cv::VideoWriter (.mp4 / .avi)
+    PNG_SEQUENCE  ///< Numbered PNG files in a directory
+};
+
+/**
+ * @class FrameEncoder
+ * @brief Encodes frames on a background thread fed by a bounded queue.
+ *
+ * Frames are queued exactly as OpenGL reads them back (BGRA, bottom-up rows);
+ * the flip and color conversion happen on the encoder thread, off the render
+ * loop. The producer fills queue slots in place and never blocks: when the
+ * queue is full, beginFrame() returns nullptr and the caller retries later.
+ */
+class FrameEncoder {
+public:
+    FrameEncoder() = default;
+    ~FrameEncoder();
+
+    FrameEncoder(const FrameEncoder&) = delete;
+    FrameEncoder& operator=(const FrameEncoder&) = delete;
+
+    /**
+     * @brief Opens the output and starts the encoder thread.
+     *
+     * @param path Video file path, or the directory for a PNG sequence.
+     * @param width Frame width in pixels.
+     * @param height Frame height in pixels.
+     * @param fps Frame rate written to the video container.
+     * @param format Output format.
+     * @return true If the output could be opened.
+     */
+    bool open(const std::string& path, int width, int height, double fps, EncoderFormat format);
+
+    /**
+     * @brief Waits for queued frames to be written, then closes the output.
+     */
+    void close();
+
+    /**
+     * @brief Drops queued frames, then closes the output.
+     *
+     * Blocks only for the frame being encoded, if any.
+     */
+    void abort();
+
+    bool isOpen() const { return m_thread.joinable(); }
+
+    /**
+     * @brief Returns the next free slot (height x width, CV_8UC4, bottom-up), or nullptr if the queue is full.
+     */
+    cv::Mat* beginFrame();
+
+    /**
+     * @brief Queues the slot returned by beginFrame() for encoding.
+     */
+    void commitFrame();
+
+    uint64_t getFramesEncoded() const { return m_framesEncoded.load(std::memory_order_relaxed); }
+    size_t getQueued() const { return m_queue.size(); }
+    size_t getCapacity() const { return m_queue.capacity(); }
+
+    /**
+     * @brief Smoothed time to convert and write one frame, in milliseconds.
+     */
+    float getEncodeMs() const { return m_encodeMs.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief True if the output could not be opened or written (disk full, unwritable directory, ...).
+     *
+     * Reset by open(). Video files are also checked by close(), since the writer itself reports no errors.
+     */
+    bool hasFailed() const { return m_failed.load(std::memory_order_relaxed); }
+
+    static constexpr size_t kQueueSize = 8;
+
+private:
+    void encodeLoop();
+
+    std::string m_path;
+    EncoderFormat m_format = EncoderFormat::VIDEO;
+    cv::VideoWriter m_writer;
+
+    SpscRing<cv::Mat> m_queue{ kQueueSize };
+    std::thread m_thread;
+    std::atomic<bool> m_closing{ false };
+    std::atomic<bool> m_discard{ false };   ///< Set by abort(): drop the queue instead of draining it
+    std::atomic<bool> m_failed{ false };
+    std::atomic<uint64_t> m_framesEncoded{ 0 };
+    std::atomic<float> m_encodeMs{ 0.0f };
+};
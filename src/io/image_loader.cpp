@@ -0,0 +1,227 @@
+#include "image_loader.h"
+#include "process_memory.h"
+#include "../core/cpu_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+ImageLoader::~ImageLoader() {
+    stop();
+}
+
+void ImageLoader::request(ImageSlot slot, const std::string& path, int maxDimension) {
+    int index = (int)slot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_thread.joinable()) {
+            m_quit = false;
+            m_thread = std::thread(&ImageLoader::run, this);
+        }
+        Request& pending = m_requests[index];
+        pending.pending = true;
+        pending.path = path;
+        pending.maxDimension = maxDimension;
+        pending.id = ++m_nextId;
+        m_latestId[index] = pending.id;
+    }
+    m_wake.notify_one();
+}
+
+bool ImageLoader::poll(LoadedImage& result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_finished.empty()) return false;
+    result = std::move(m_finished.front());
+    m_finished.erase(m_finished.begin());
+    return true;
+}
+
+bool ImageLoader::isLoading(ImageSlot slot) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_requests[(int)slot].pending || m_busy[(int)slot];
+}
+
+ImageLoadStats ImageLoader::getLastStats(ImageSlot slot) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastStats[(int)slot];
+}
+
+uint64_t ImageLoader::getStatsGeneration(ImageSlot slot) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statsGeneration[(int)slot];
+}
+
+void ImageLoader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        for (Request& pending : m_requests) {
+            pending.pending = false;
+        }
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_finished.clear();
+}
+
+void ImageLoader::run() {
+    CpuProfiler::setThreadName("Image Loader");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] {
+            return m_quit || m_requests[0].pending || m_requests[1].pending;
+        });
+        if (m_quit) return;
+
+        int index = m_requests[(int)ImageSlot::SOURCE].pending ? 0 : 1;
+        Request request = m_requests[index];
+        m_requests[index].pending = false;
+        m_busy[index] = true;
+
+        lock.unlock();
+        LoadedImage result = decode(request.path, request.maxDimension);
+        result.slot = (ImageSlot)index;
+        lock.lock();
+
+        m_busy[index] = false;
+        // A newer request for this slot arrived while decoding: its result wins
+        if (request.id != m_latestId[index]) continue;
+
+        m_lastStats[index] = result.stats;
+        ++m_statsGeneration[index];
+        if (result.stats.ok) {
+            m_finished.push_back(std::move(result));
+        } else {
+            std::cerr << "ImageLoader: Failed to load " << request.path << std::endl;
+        }
+    }
+}
+
+LoadedImage ImageLoader::decode(const std::string& path, int maxDimension) {
+    PROFILE_SCOPE("Image Decode");
+    using Clock = std::chrono::steady_clock;
+    LoadedImage result;
+    ImageLoadStats& stats = result.stats;
+    stats.path = path;
+    Clock::time_point start = Clock::now();
+    size_t peakBefore = getPeakRssBytes();
+    auto finishMemoryStats = [&]() {
+        stats.peakRssBytes = getPeakRssBytes();
+        stats.peakRssGrowth = stats.peakRssBytes > peakBefore ? stats.peakRssBytes - peakBefore : 0;
+    };
+
+    // Large uncompressed files: stream stripes straight into the downscaled image.
+    // Anything the stripe reader rejects (e.g. compressed TIFF) falls back to cv::imread.
+    if (canStreamImage(path) && readAreaDownsampled(path, maxDimension, result.image, &stats.streaming)) {
+        Clock::time_point end = Clock::now();
+        stats.ok = true;
+        stats.streamed = true;
+        stats.originalWidth = stats.streaming.sourceWidth;
+        stats.originalHeight = stats.streaming.sourceHeight;
+        stats.width = result.image.cols;
+        stats.height = result.image.rows;
+        stats.decodeMs = std::chrono::duration<float, std::milli>(end - start).count();
+        stats.totalMs = stats.decodeMs;
+        finishMemoryStats();
+        return result;
+    }
+
+    // Largest JPEG reduction that still leaves the longest side >= maxDimension
+    int flags = cv::IMREAD_COLOR;
+    int width = 0;
+    int height = 0;
+    bool isJpeg = probeJpegSize(path, width, height);
+    Clock::time_point probed = Clock::now();
+    if (isJpeg && maxDimension > 0) {
+        int longest = std::max(width, height);
+        for (int reduction : { 8, 4, 2 }) {
+            if ((longest + reduction - 1) / reduction >= maxDimension) {
+                stats.reduction = reduction;
+                break;
+            }
+        }
+        if (stats.reduction == 2) flags = cv::IMREAD_REDUCED_COLOR_2;
+        else if (stats.reduction == 4) flags = cv::IMREAD_REDUCED_COLOR_4;
+        else if (stats.reduction == 8) flags = cv::IMREAD_REDUCED_COLOR_8;
+    }
+
+    cv::Mat decoded = cv::imread(path, flags);
+    Clock::time_point decodedAt = Clock::now();
+    if (decoded.empty()) {
+        stats.totalMs = std::chrono::duration<float, std::milli>(decodedAt - start).count();
+        return result;
+    }
+
+    if (isJpeg) {
+        // EXIF orientation may have rotated the decoded image by 90 degrees
+        if ((decoded.cols > decoded.rows) != (width > height)) std::swap(width, height);
+        stats.originalWidth = width;
+        stats.originalHeight = height;
+    } else {
+        stats.originalWidth = decoded.cols;
+        stats.originalHeight = decoded.rows;
+    }
+
+    int longest = std::max(decoded.cols, decoded.rows);
+    if (maxDimension > 0 && longest > maxDimension) {
+        float scale = (float)maxDimension / (float)longest;
+        cv::Size size(std::max(1, (int)(decoded.cols * scale + 0.5f)), std::max(1, (int)(decoded.rows * scale + 0.5f)));
+        cv::resize(decoded, result.image, size, 0, 0, cv::INTER_AREA);
+    } else {
+        result.image = decoded;
+    }
+    Clock::time_point end = Clock::now();
+
+    stats.ok = true;
+    stats.width = result.image.cols;
+    stats.height = result.image.rows;
+    stats.probeMs = std::chrono::duration<float, std::milli>(probed - start).count();
+    stats.decodeMs = std::chrono::duration<float, std::milli>(decodedAt - probed).count();
+    stats.resizeMs = std::chrono::duration<float, std::milli>(end - decodedAt).count();
+    stats.totalMs = std::chrono::duration<float, std::milli>(end - start).count();
+    finishMemoryStats();
+    return result;
+}
+
+/**
+ * Walks the marker segments up to the first SOFn marker. Only segment headers
+ * are read; large APPn blocks (EXIF thumbnails) are skipped with seekg().
+ */
+bool probeJpegSize(const std::string& path, int& width, int& height) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    unsigned char header[2];
+    if (!file.read((char*)header, 2) || header[0] != 0xFF || header[1] != 0xD8) return false;
+
+    while (file) {
+        int byte = file.get();
+        if (byte != 0xFF) return false;
+        int marker;
+        do {
+            marker = file.get(); // Any number of 0xFF fill bytes may precede a marker
+        } while (marker == 0xFF);
+        if (marker == EOF || marker == 0xD9 || marker == 0xDA) return false;
+
+        // Standalone markers carry no length
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue;
+
+        unsigned char lengthBytes[2];
+        if (!file.read((char*)lengthBytes, 2)) return false;
+        int length = (lengthBytes[0] << 8) | lengthBytes[1];
+        if (length < 2) return false;
+
+        bool isFrameHeader = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (isFrameHeader) {
+            unsigned char frame[5]; // precision, height (2), width (2)
+            if (!file.read((char*)frame, 5)) return false;
+            height = (frame[1] << 8) | frame[2];
+            width = (frame[3] << 8) | frame[4];
+            return width > 0 && height > 0;
+        }
+        file.seekg(length - 2, std::ios::cur);
+    }
+    return false;
+}
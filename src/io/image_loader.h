@@ -0,0 +1,142 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "stripe_image_reader.h"
+
+/**
+ * @enum ImageSlot
+ * @brief Which image a load request is for. A newer request replaces an older one for the same slot.
+ */
+enum class ImageSlot { SOURCE = 0, TARGET = 1 };
+
+/**
+ * @struct ImageLoadStats
+ * @brief Decode telemetry of one finished load.
+ */
+struct ImageLoadStats {
+    std::string path;
+    bool ok = false;
+    int originalWidth = 0;   ///< Size stored in the file
+    int originalHeight = 0;
+    int width = 0;           ///< Size of the image handed to the app
+    int height = 0;
+    int reduction = 1;       ///< Decode-time downscale (1, 2, 4 or 8)
+    float probeMs = 0.0f;    ///< Reading the JPEG header
+    float decodeMs = 0.0f;   ///< cv::imread (file read + decode)
+    float resizeMs = 0.0f;   ///< Area downscale to the requested size
+    float totalMs = 0.0f;
+    bool streamed = false;   ///< Read in stripes by StripeImageReader instead of cv::imread
+    StreamedLoadStats streaming; ///< Stripe telemetry when streamed
+    size_t peakRssBytes = 0;  ///< Process RSS high-water mark after the load
+    size_t peakRssGrowth = 0; ///< How much this load raised it
+};
+
+/**
+ * @struct LoadedImage
+ * @brief A finished load, ready to be swapped in on the main thread.
+ */
+struct LoadedImage {
+    ImageSlot slot = ImageSlot::SOURCE;
+    cv::Mat image;           ///< BGR, longest side at most the requested maximum
+    ImageLoadStats stats;
+};
+
+/**
+ * @class ImageLoader
+ * @brief Decodes still images on a background thread at the resolution the app needs.
+ *
+ * JPEGs are decoded with IMREAD_REDUCED_COLOR_2/4/8 when the reduced image is
+ * still at least as large as requested, so the decoder skips most of the
+ * IDCT work and the full-size image is never allocated. Whatever remains above
+ * the requested size is area-downscaled, so only the needed resolution is kept.
+ *
+ * Uncompressed PPM/PGM and TIFF files (typically print-sized targets) are
+ * streamed in stripes through readAreaDownsampled() instead, so memory stays
+ * proportional to the stripe, not the image.
+ */
+class ImageLoader {
+public:
+    ImageLoader() = default;
+    ~ImageLoader();
+
+    ImageLoader(const ImageLoader&) = delete;
+    ImageLoader& operator=(const ImageLoader&) = delete;
+
+    /**
+     * @brief Queues an image for loading. Never blocks on the decode.
+     *
+     * @param slot Slot the result is for; supersedes any pending or running load of the same slot.
+     * @param path Image file.
+     * @param maxDimension Longest side the caller needs (0 = full resolution).
+     */
+    void request(ImageSlot slot, const std::string& path, int maxDimension);
+
+    /**
+     * @brief Takes a finished load, if there is one. Call from the main thread.
+     * @return true If @p result was filled.
+     */
+    bool poll(LoadedImage& result);
+
+    /**
+     * @brief True while a load for the slot is queued or decoding.
+     */
+    bool isLoading(ImageSlot slot) const;
+
+    /**
+     * @brief Telemetry of the last finished load of a slot.
+     */
+    ImageLoadStats getLastStats(ImageSlot slot) const;
+
+    /**
+     * @brief Bumped whenever getLastStats() changes, so callers can refresh a cached copy only then.
+     */
+    uint64_t getStatsGeneration(ImageSlot slot) const;
+
+    /**
+     * @brief Stops the loader thread, discarding queued loads.
+     */
+    void stop();
+
+    /**
+     * @brief Decodes an image on the calling thread, the same way background loads do.
+     *
+     * For callers that already run on a worker thread (e.g. the playlist prefetcher).
+     */
+    static LoadedImage decode(const std::string& path, int maxDimension);
+
+private:
+    struct Request {
+        bool pending = false;
+        std::string path;
+        int maxDimension = 0;
+        uint64_t id = 0;
+    };
+
+    void run();
+
+    static constexpr int kSlotCount = 2;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit = false;
+    Request m_requests[kSlotCount];
+    uint64_t m_latestId[kSlotCount] = {};   ///< Newest request per slot; older results are dropped
+    bool m_busy[kSlotCount] = {};           ///< Slot currently decoding
+    uint64_t m_nextId = 0;
+    std::vector<LoadedImage> m_finished;
+    ImageLoadStats m_lastStats[kSlotCount];
+    uint64_t m_statsGeneration[kSlotCount] = {};
+};
+
+/**
+ * @brief Reads the frame size from a JPEG header without decoding.
+ * @return true If @p path is a JPEG and its size was found.
+ */
+bool probeJpegSize(const std::string& path, int& width, int& height);
@@ -0,0 +1,288 @@
+#include "metrics_exporter.h"
+#include "process_memory.h"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int kPollMs = 100; ///< Longest the worker sleeps before checking for stop()
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+void closeSocket(SocketHandle socket) { closesocket(socket); }
+#else
+using SocketHandle = int;
+void closeSocket(SocketHandle socket) { close(socket); }
+#endif
+
+/**
+ * @brief Opens a listening TCP socket on 127.0.0.1:port, or returns -1.
+ */
+intptr_t listenLocalhost(int port) {
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return -1;
+#endif
+    SocketHandle server = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+#ifdef _WIN32
+    if (server == INVALID_SOCKET) {
+        WSACleanup();
+        return -1;
+    }
+#else
+    if (server < 0) return -1;
+#endif
+    int reuse = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(server, (sockaddr*)&address, sizeof(address)) != 0 || listen(server, 4) != 0) {
+        closeSocket(server);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return -1;
+    }
+    return (intptr_t)server;
+}
+
+void writeSummaryLine(std::ostringstream& out, const std::string& name, const char* quantile, double value) {
+    out << name << "{quantile=\"" << quantile << "\"} " << value << "\n";
+}
+
+} // namespace
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start(const MetricsSettings& settings) {
+    stop();
+    if (settings.filePath.empty() && settings.httpPort <= 0) return false;
+
+    m_settings = settings;
+    m_settings.intervalSeconds = std::max(0.5f, m_settings.intervalSeconds);
+    m_startTime = std::chrono::steady_clock::now();
+    m_previous.clear();
+
+    if (m_settings.httpPort > 0) {
+        m_listenSocket = listenLocalhost(m_settings.httpPort);
+        if (m_listenSocket == -1) {
+            std::cerr << "Metrics: Cannot listen on 127.0.0.1:" << m_settings.httpPort << std::endl;
+            return false;
+        }
+        std::cout << "Metrics: Serving http://127.0.0.1:" << m_settings.httpPort << "/metrics" << std::endl;
+    }
+    if (!m_settings.filePath.empty()) {
+        std::cout << "Metrics: Writing " << m_settings.filePath << " every " << m_settings.intervalSeconds
+                  << " s" << std::endl;
+    }
+
+    // First snapshot right away so the endpoint never serves an empty page
+    publish();
+    m_quit = false;
+    m_thread = std::thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (m_thread.joinable()) {
+        m_quit = true;
+        m_thread.join();
+        publish();
+    }
+    if (m_listenSocket != -1) {
+        closeSocket((SocketHandle)m_listenSocket);
+        m_listenSocket = -1;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+}
+
+std::string MetricsExporter::getText() const {
+    std::lock_guard<std::mutex> lock(m_textMutex);
+    return m_text;
+}
+
+void MetricsExporter::run() {
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(m_settings.intervalSeconds));
+    Clock::time_point nextPublish = Clock::now() + interval;
+
+    while (!m_quit) {
+        if (Clock::now() >= nextPublish) {
+            publish();
+            // Skip missed periods instead of publishing in a burst
+            nextPublish = std::max(nextPublish + interval, Clock::now());
+        }
+
+        if (m_listenSocket == -1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+            continue;
+        }
+
+        SocketHandle server = (SocketHandle)m_listenSocket;
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(server, &readable);
+        timeval timeout{ 0, kPollMs * 1000 };
+        if (select((int)server + 1, &readable, nullptr, nullptr, &timeout) > 0) {
+            SocketHandle client = accept(server, nullptr, nullptr);
+#ifdef _WIN32
+            if (client != INVALID_SOCKET) serveClient((intptr_t)client);
+#else
+            if (client >= 0) serveClient((intptr_t)client);
+#endif
+        }
+    }
+}
+
+void MetricsExporter::serveClient(intptr_t handle) {
+    SocketHandle client = (SocketHandle)handle;
+
+    // Don't let a stalled client hold up the snapshots
+#ifdef _WIN32
+    DWORD timeoutMs = 1000;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeoutMs, sizeof(timeoutMs));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeoutMs, sizeof(timeoutMs));
+#else
+    timeval timeout{ 1, 0 };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#endif
+
+    // Only the request line matters; read until the end of the headers
+    std::string request;
+    char buffer[1024];
+    while (request.size() < 8192 && request.find("\r\n\r\n") == std::string::npos) {
+        int received = (int)recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) break;
+        request.append(buffer, (size_t)received);
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    if (request.compare(0, 4, "GET ") != 0) {
+        status = "405 Method Not Allowed";
+    } else if (request.compare(4, 9, "/metrics ") == 0 || request.compare(4, 2, "/ ") == 0) {
+        body = getText();
+    } else {
+        status = "404 Not Found";
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string bytes = response.str();
+    size_t sent = 0;
+    while (sent < bytes.size()) {
+        int written = (int)send(client, bytes.data() + sent, (int)(bytes.size() - sent), 0);
+        if (written <= 0) break;
+        sent += (size_t)written;
+    }
+    closeSocket(client);
+}
+
+void MetricsExporter::publish() {
+    // Process-level gauges are sampled here rather than on the render thread
+    static Gauge& uptime = Metrics::gauge("lumasort_uptime_seconds", "Seconds since metrics collection started");
+    static Gauge& rss = Metrics::gauge("lumasort_resident_memory_bytes", "Resident set size of the process");
+    static Gauge& peakRss = Metrics::gauge("lumasort_peak_resident_memory_bytes", "High-water mark of the resident set size");
+    uptime.set(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count());
+    rss.set((double)getCurrentRssBytes());
+    peakRss.set((double)getPeakRssBytes());
+
+    std::string text = render();
+    if (!m_settings.filePath.empty()) {
+        appendToFile(text);
+    }
+    std::lock_guard<std::mutex> lock(m_textMutex);
+    m_text = std::move(text);
+}
+
+std::string MetricsExporter::render() {
+    std::ostringstream out;
+    out.precision(9);
+    for (const MetricInfo& metric : Metrics::list()) {
+        out << "# HELP " << metric.name << " " << metric.help << "\n";
+        switch (metric.type) {
+            case MetricType::Counter:
+                out << "# TYPE " << metric.name << " counter\n";
+                out << metric.name << " " << (metric.counter ? metric.counter->value() : 0) << "\n";
+                break;
+            case MetricType::Gauge:
+                out << "# TYPE " << metric.name << " gauge\n";
+                out << metric.name << " " << (metric.gauge ? metric.gauge->value() : 0.0) << "\n";
+                break;
+            case MetricType::Histogram: {
+                out << "# TYPE " << metric.name << " summary\n";
+                if (!metric.histogram) break;
+                LatencyHistogram::Snapshot total = metric.histogram->snapshot();
+                auto previous = m_previous.find(metric.name);
+                LatencyHistogram::Snapshot window =
+                    previous == m_previous.end() ? total : total.since(previous->second);
+                writeSummaryLine(out, metric.name, "0.5", window.quantile(0.5));
+                writeSummaryLine(out, metric.name, "0.9", window.quantile(0.9));
+                writeSummaryLine(out, metric.name, "0.99", window.quantile(0.99));
+                writeSummaryLine(out, metric.name, "0.999", window.quantile(0.999));
+                writeSummaryLine(out, metric.name, "1", window.max());
+                out << metric.name << "_sum " << total.sum << "\n";
+                out << metric.name << "_count " << total.count << "\n";
+                m_previous[metric.name] = std::move(total);
+                break;
+            }
+        }
+    }
+    return out.str();
+}
+
+void MetricsExporter::appendToFile(const std::string& text) {
+    namespace fs = std::filesystem;
+    const std::string& path = m_settings.filePath;
+
+    std::error_code ec;
+    uintmax_t size = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+    if (!ec && size > 0 && size + text.size() > m_settings.maxFileBytes) {
+        // path -> path.1 -> path.2 ... ; the oldest falls off the end
+        int keep = std::max(1, m_settings.keepFiles);
+        fs::remove(path + "." + std::to_string(keep), ec);
+        for (int i = keep - 1; i >= 1; --i) {
+            std::string from = path + "." + std::to_string(i);
+            if (fs::exists(from, ec)) fs::rename(from, path + "." + std::to_string(i + 1), ec);
+        }
+        fs::rename(path, path + ".1", ec);
+        if (ec) {
+            std::cerr << "Metrics: Cannot rotate " << path << ": " << ec.message() << std::endl;
+        }
+    }
+
+    std::ofstream file(path, std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "Metrics: Cannot write " << path << std::endl;
+        return;
+    }
+    file << "# snapshot " << (long long)std::time(nullptr) << "\n" << text << "\n";
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "../core/metrics.h"
+
+/**
+ * @struct MetricsSettings
+ * @brief Where and how often MetricsExporter publishes the registry.
+ */
+struct MetricsSettings {
+    std::string filePath;                  ///< Snapshot log (empty = none)
+    int httpPort = 0;                      ///< Localhost port serving /metrics (0 = none)
+    float intervalSeconds = 10.0f;         ///< Snapshot period; also the quantile window
+    size_t maxFileBytes = 8u << 20;        ///< Rotate the log once it would grow past this
+    int keepFiles = 3;                     ///< Rotated logs kept (path.1 is the newest)
+};
+
+/**
+ * @class MetricsExporter
+ * @brief Publishes the Metrics registry from a background thread.
+ *
+ * Every interval it refreshes the process gauges (uptime, resident memory),
+ * renders all metrics in the Prometheus text format and
+ * - appends the snapshot, stamped with the time, to a size-rotated log file;
+ * - keeps it for the optional HTTP endpoint, bound to 127.0.0.1 only.
+ *
+ * Histograms are rendered as summaries whose quantiles cover the last interval
+ * (their _sum and _count are cumulative), so a slow drift such as frame time
+ * creep shows up in successive snapshots instead of vanishing into days of history.
+ */
+class MetricsExporter {
+public:
+    MetricsExporter() = default;
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Starts publishing. Restarts if already running.
+     *
+     * @return false If neither output is configured or the HTTP port could not be bound.
+     */
+    bool start(const MetricsSettings& settings);
+
+    /**
+     * @brief Writes a final snapshot and stops the thread.
+     */
+    void stop();
+
+    bool isRunning() const { return m_thread.joinable(); }
+    const MetricsSettings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief The latest rendered snapshot.
+     */
+    std::string getText() const;
+
+private:
+    void run();
+
+    /**
+     * @brief Renders the registry and appends it to the log file.
+     */
+    void publish();
+
+    std::string render();
+    void appendToFile(const std::string& text);
+    void serveClient(intptr_t client);
+
+    MetricsSettings m_settings;
+    std::thread m_thread;
+    std::atomic<bool> m_quit{ false };
+    intptr_t m_listenSocket = -1;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    std::map<std::string, LatencyHistogram::Snapshot> m_previous; ///< Histogram state at the last snapshot (worker only)
+
+    mutable std::mutex m_textMutex;
+    std::string m_text;
+};
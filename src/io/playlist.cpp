@@ -0,0 +1,251 @@
+#include "playlist.h"
+#include "image_loader.h"
+#include "../core/cpu_profiler.h"
+#include "../core/metrics.h"
+#include "../core/physics.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return std::string();
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+float msBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<float, std::milli>(to - from).count();
+}
+
+} // namespace
+
+bool loadPlaylist(const std::string& path, std::vector<PlaylistEntry>& entries) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Playlist: Cannot open " << path << std::endl;
+        return false;
+    }
+
+    std::vector<PlaylistEntry> parsed;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '|')) {
+            fields.push_back(trim(field));
+        }
+
+        PlaylistEntry entry;
+        char* end = nullptr;
+        entry.dwellSeconds = fields.empty() ? 0.0f : std::strtof(fields[0].c_str(), &end);
+        if (fields.size() < 2 || fields.size() > 3 || end == fields[0].c_str() || entry.dwellSeconds <= 0.0f ||
+            fields[1].empty()) {
+            std::cerr << "Playlist: " << path << ":" << lineNumber
+                      << ": expected 'dwell_seconds | target [| source]'" << std::endl;
+            return false;
+        }
+        entry.target = fields[1];
+        if (fields.size() == 3) entry.source = fields[2];
+        parsed.push_back(entry);
+    }
+
+    if (parsed.empty()) {
+        std::cerr << "Playlist: " << path << " has no entries" << std::endl;
+        return false;
+    }
+    entries = std::move(parsed);
+    return true;
+}
+
+bool savePlaylist(const std::string& path, const std::vector<PlaylistEntry>& entries) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Playlist: Cannot write " << path << std::endl;
+        return false;
+    }
+    file << "# dwell_seconds | target [| source]\n";
+    for (const PlaylistEntry& entry : entries) {
+        file << entry.dwellSeconds << " | " << entry.target;
+        if (!entry.source.empty()) file << " | " << entry.source;
+        file << "\n";
+    }
+    return (bool)file;
+}
+
+TransitionPrefetcher::~TransitionPrefetcher() {
+    stop();
+}
+
+void TransitionPrefetcher::start(const std::vector<PlaylistEntry>& entries, const cv::Mat& initialSource,
+                                 int gridWidth, int gridHeight, int maxGridDimension, bool loop) {
+    stop();
+
+    m_entries = entries;
+    m_initialSource = initialSource.clone();
+    m_gridWidth = gridWidth;
+    m_gridHeight = gridHeight;
+    m_maxGridDimension = maxGridDimension;
+    m_loop = loop;
+    m_settled.release();
+
+    m_quit = false;
+    m_hasReady = false;
+    m_finished = false;
+    m_error.clear();
+    m_thread = std::thread(&TransitionPrefetcher::run, this);
+}
+
+void TransitionPrefetcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_hasReady = false;
+    m_ready = PreparedTransition();
+}
+
+bool TransitionPrefetcher::take(PreparedTransition& transition) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasReady) return false;
+        transition = std::move(m_ready);
+        m_ready = PreparedTransition();
+        m_hasReady = false;
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+bool TransitionPrefetcher::isReady() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasReady;
+}
+
+bool TransitionPrefetcher::isFinished() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_finished && !m_hasReady;
+}
+
+std::string TransitionPrefetcher::getError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+void TransitionPrefetcher::run() {
+    CpuProfiler::setThreadName("Playlist Prefetch");
+    size_t index = 0;
+    while (true) {
+        if (index >= m_entries.size()) {
+            if (!m_loop || m_entries.empty()) break;
+            index = 0;
+        }
+
+        PreparedTransition transition;
+        std::string error;
+        bool ok = prepare(index, transition, error);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!ok) {
+            m_error = error;
+            m_finished = true;
+            std::cerr << "Playlist: " << error << std::endl;
+            return;
+        }
+        // Hold at most one transition ready; the next prepare starts once it is taken
+        m_wake.wait(lock, [this] { return m_quit || !m_hasReady; });
+        if (m_quit) return;
+        m_ready = std::move(transition);
+        m_hasReady = true;
+        ++index;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finished = true;
+}
+
+bool TransitionPrefetcher::prepare(size_t index, PreparedTransition& transition, std::string& error) {
+    PROFILE_SCOPE("Prepare Transition");
+    using Clock = std::chrono::steady_clock;
+    const PlaylistEntry& entry = m_entries[index];
+    Clock::time_point start = Clock::now();
+
+    // Source: the entry's own image, else the previous settled state (or the app's frame for the first entry)
+    cv::Mat source;
+    if (!entry.source.empty()) {
+        LoadedImage loaded = ImageLoader::decode(entry.source, m_maxGridDimension);
+        if (!loaded.stats.ok) {
+            error = "failed to load source " + entry.source;
+            return false;
+        }
+        // The grid follows the playlist's first own source; later sources are fit into it
+        if (m_settled.empty() && index == 0) {
+            fitImageGrid(loaded.image.cols, loaded.image.rows, m_maxGridDimension, m_gridWidth, m_gridHeight);
+        }
+        source = loaded.image;
+    } else if (!m_settled.empty()) {
+        source = m_settled;
+    } else {
+        source = m_initialSource;
+    }
+    if (source.empty() || m_gridWidth <= 0 || m_gridHeight <= 0) {
+        error = "no source for the first entry";
+        return false;
+    }
+    if (source.cols != m_gridWidth || source.rows != m_gridHeight) {
+        // Same resampling update() applies to particle colors
+        cv::Mat resized;
+        cv::resize(source, resized, cv::Size(m_gridWidth, m_gridHeight));
+        source = resized;
+    }
+
+    LoadedImage target = ImageLoader::decode(entry.target, std::max(m_gridWidth, m_gridHeight));
+    if (!target.stats.ok) {
+        error = "failed to load target " + entry.target;
+        return false;
+    }
+    Clock::time_point decoded = Clock::now();
+
+    transition.mapping = m_sorter.sortImage(source, target.image, m_gridWidth, m_gridHeight);
+    Clock::time_point sorted = Clock::now();
+    if (transition.mapping.size() != (size_t)m_gridWidth * m_gridHeight) {
+        error = "sort failed for " + entry.target;
+        return false;
+    }
+
+    // Settled state: every source color at the pixel it was mapped to. The
+    // mapping is a permutation of the grid, so every pixel is written once.
+    cv::Mat settled(m_gridHeight, m_gridWidth, CV_8UC3);
+    for (size_t i = 0; i < transition.mapping.size(); ++i) {
+        const glm::vec2& to = transition.mapping[i];
+        settled.at<cv::Vec3b>((int)to.y, (int)to.x) = source.at<cv::Vec3b>((int)(i / m_gridWidth), (int)(i % m_gridWidth));
+    }
+    m_settled = settled;
+
+    transition.entry = index;
+    transition.gridWidth = m_gridWidth;
+    transition.gridHeight = m_gridHeight;
+    transition.source = source;
+    transition.target = target.image;
+    transition.readyAt = Clock::now();
+    transition.decodeMs = msBetween(start, decoded);
+    transition.sortMs = msBetween(decoded, sorted);
+    static LatencyHistogram& sortTime = Metrics::histogram("lumasort_sort_seconds", "Duration of particle-to-target sorts", 1e-6);
+    sortTime.record(transition.sortMs / 1000.0);
+    transition.totalMs = msBetween(start, transition.readyAt);
+    return true;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <glm/glm.hpp>
+#include "../core/sorter.h"
+
+/**
+ * @struct PlaylistEntry
+ * @brief One transition of a playlist.
+ */
+struct PlaylistEntry {
+    std::string target;         ///< Image the particles assemble into
+    std::string source;         ///< Fresh source image; empty = continue from the previous settled state
+    float dwellSeconds = 10.0f; ///< Time from the start of this transition to the next one
+};
+
+/**
+ * @brief Reads a playlist file.
+ *
+ * One entry per line: `dwell_seconds | target_path [| source_path]`. Blank lines
+ * and lines starting with '#' are ignored.
+ *
+ * @return true If the file was read and held at least one entry.
+ */
+bool loadPlaylist(const std::string& path, std::vector<PlaylistEntry>& entries);
+
+/**
+ * @brief Writes a playlist file in the format read by loadPlaylist().
+ */
+bool savePlaylist(const std::string& path, const std::vector<PlaylistEntry>& entries);
+
+/**
+ * @struct PreparedTransition
+ * @brief Everything a transition needs, computed ahead of time: applying it is a copy.
+ */
+struct PreparedTransition {
+    size_t entry = 0;                 ///< Index into the playlist
+    int gridWidth = 0;                ///< Simulation grid the mapping was sorted for
+    int gridHeight = 0;
+    cv::Mat source;                   ///< Particle colors (grid-size BGR)
+    cv::Mat target;                   ///< Target image as decoded (for the preview)
+    std::vector<glm::vec2> mapping;   ///< As Sorter::sortImage(): particle index -> target pixel
+    float decodeMs = 0.0f;            ///< Decoding and resizing source/target
+    float sortMs = 0.0f;
+    float totalMs = 0.0f;
+    std::chrono::steady_clock::time_point readyAt; ///< When the worker finished it
+};
+
+/**
+ * @class TransitionPrefetcher
+ * @brief Prepares the transitions of a playlist on a background thread, one ahead of playback.
+ *
+ * For each entry the worker decodes the images, resizes them to the simulation
+ * grid and sorts them, so the main thread only copies the finished mapping into
+ * the particles when the dwell time is up. Transitions are chained: an entry
+ * without a source of its own starts from the previous entry's settled state,
+ * i.e. the previous source colors rearranged by the previous mapping. That image
+ * is known exactly as soon as the mapping is, so the next sort never waits for
+ * the animation to settle.
+ *
+ * One prepared transition is held ready at a time; the worker then prepares the
+ * following one and waits for take() to free the slot.
+ */
+class TransitionPrefetcher {
+public:
+    TransitionPrefetcher() = default;
+    ~TransitionPrefetcher();
+
+    TransitionPrefetcher(const TransitionPrefetcher&) = delete;
+    TransitionPrefetcher& operator=(const TransitionPrefetcher&) = delete;
+
+    /**
+     * @brief Starts preparing a playlist from its first entry. Restarts if already running.
+     *
+     * @param entries Playlist to play.
+     * @param initialSource Source of the first entry if it has none (any size, BGR).
+     * @param gridWidth Grid used with @p initialSource.
+     * @param gridHeight
+     * @param maxGridDimension Grid cap when the first entry has its own source (see fitImageGrid()).
+     * @param loop Start over after the last entry instead of finishing.
+     */
+    void start(const std::vector<PlaylistEntry>& entries, const cv::Mat& initialSource,
+               int gridWidth, int gridHeight, int maxGridDimension, bool loop);
+
+    /**
+     * @brief Stops the worker and drops anything prepared.
+     */
+    void stop();
+
+    /**
+     * @brief Takes the next prepared transition, if it is ready. Never blocks.
+     * @return true If @p transition was filled.
+     */
+    bool take(PreparedTransition& transition);
+
+    /**
+     * @brief True while the next transition is prepared and waiting.
+     */
+    bool isReady() const;
+
+    /**
+     * @brief True once the worker has nothing more to prepare (end of a non-looping playlist, or an error).
+     */
+    bool isFinished() const;
+
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /**
+     * @brief Why the worker stopped early, or empty.
+     */
+    std::string getError() const;
+
+private:
+    void run();
+
+    /**
+     * @brief Decodes and sorts one entry, chaining from m_settled. Worker thread only.
+     */
+    bool prepare(size_t index, PreparedTransition& transition, std::string& error);
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit = false;
+    bool m_hasReady = false;
+    bool m_finished = false;
+    PreparedTransition m_ready;
+    std::string m_error;
+
+    // Set by start(), read by the worker
+    std::vector<PlaylistEntry> m_entries;
+    cv::Mat m_initialSource;
+    int m_gridWidth = 0;
+    int m_gridHeight = 0;
+    int m_maxGridDimension = 0;
+    bool m_loop = false;
+
+    // Worker-only state
+    Sorter m_sorter;
+    cv::Mat m_settled; ///< Settled state of the last prepared transition (grid-size BGR)
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Resident set size of this process, in bytes (0 if unavailable).
+ */
+size_t getCurrentRssBytes();
+
+/**
+ * @brief High-water mark of the resident set size of this process, in bytes (0 if unavailable).
+ */
+size_t getPeakRssBytes();
@@ -0,0 +1,555 @@
+#include "stripe_image_reader.h"
+#include "process_memory.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    /**
+     * @brief Minimal TIFF/BigTIFF directory reader: the first IFD's tags and their values.
+     */
+    class TiffDirectory {
+    public:
+        bool read(std::ifstream& file) {
+            unsigned char header[16];
+            if (!file.read((char*)header, 8)) return false;
+            if (header[0] == 'I' && header[1] == 'I') m_bigEndian = false;
+            else if (header[0] == 'M' && header[1] == 'M') m_bigEndian = true;
+            else return false;
+
+            uint64_t version = decode(header + 2, 2);
+            uint64_t ifdOffset = 0;
+            if (version == 42) {
+                ifdOffset = decode(header + 4, 4);
+            } else if (version == 43) {
+                m_big = true;
+                if (!file.read((char*)header + 8, 8)) return false;
+                ifdOffset = decode(header + 8, 8);
+            } else {
+                return false;
+            }
+
+            file.seekg((std::streamoff)ifdOffset);
+            unsigned char countBytes[8];
+            if (!file.read((char*)countBytes, m_big ? 8 : 2)) return false;
+            uint64_t entryCount = decode(countBytes, m_big ? 8 : 2);
+
+            size_t entrySize = m_big ? 20 : 12;
+            std::vector<unsigned char> entries(entrySize * entryCount);
+            if (!file.read((char*)entries.data(), entries.size())) return false;
+
+            for (uint64_t i = 0; i < entryCount; ++i) {
+                const unsigned char* entry = entries.data() + i * entrySize;
+                Entry parsed;
+                parsed.type = (int)decode(entry + 2, 2);
+                parsed.count = decode(entry + 4, m_big ? 8 : 4);
+                std::memcpy(parsed.inlineValue, entry + (m_big ? 12 : 8), m_big ? 8 : 4);
+                m_entries[(int)decode(entry, 2)] = parsed;
+            }
+            m_file = &file;
+            return true;
+        }
+
+        bool has(int tag) const { return m_entries.count(tag) != 0; }
+        bool isBigEndian() const { return m_bigEndian; }
+
+        uint64_t value(int tag, uint64_t fallback) const {
+            std::vector<uint64_t> values = array(tag);
+            return values.empty() ? fallback : values[0];
+        }
+
+        std::vector<uint64_t> array(int tag) const {
+            std::vector<uint64_t> values;
+            auto it = m_entries.find(tag);
+            if (it == m_entries.end()) return values;
+
+            const Entry& entry = it->second;
+            size_t size = typeSize(entry.type);
+            if (size == 0 || entry.count > (1u << 28)) return values;
+
+            // Values that fit the entry are stored inline, others at an offset
+            std::vector<unsigned char> bytes(size * entry.count);
+            size_t inlineBytes = m_big ? 8 : 4;
+            if (bytes.size() <= inlineBytes) {
+                std::memcpy(bytes.data(), entry.inlineValue, bytes.size());
+            } else {
+                m_file->clear();
+                m_file->seekg((std::streamoff)decode(entry.inlineValue, inlineBytes));
+                if (!m_file->read((char*)bytes.data(), bytes.size())) return values;
+            }
+
+            values.resize(entry.count);
+            for (uint64_t i = 0; i < entry.count; ++i) {
+                values[i] = decode(bytes.data() + i * size, size);
+            }
+            return values;
+        }
+
+    private:
+        struct Entry {
+            int type = 0;
+            uint64_t count = 0;
+            unsigned char inlineValue[8] = {};
+        };
+
+        static size_t typeSize(int type) {
+            switch (type) {
+                case 1: return 1;            // BYTE
+                case 3: return 2;            // SHORT
+                case 4: case 13: return 4;   // LONG, IFD
+                case 16: case 18: return 8;  // LONG8, IFD8
+                default: return 0;
+            }
+        }
+
+        uint64_t decode(const unsigned char* bytes, size_t size) const {
+            uint64_t value = 0;
+            for (size_t i = 0; i < size; ++i) {
+                size_t index = m_bigEndian ? i : size - 1 - i;
+                value = (value << 8) | bytes[index];
+            }
+            return value;
+        }
+
+        std::map<int, Entry> m_entries;
+        std::ifstream* m_file = nullptr;
+        bool m_bigEndian = false;
+        bool m_big = false;
+    };
+
+    /**
+     * @brief Reads the next PNM header token, skipping whitespace and comments.
+     */
+    bool readPnmToken(std::ifstream& file, std::string& token) {
+        token.clear();
+        int c = file.get();
+        while (c != EOF) {
+            if (c == '#') {
+                while (c != EOF && c != '\n') c = file.get();
+            } else if (!std::isspace(c)) {
+                break;
+            }
+            c = file.get();
+        }
+        while (c != EOF && !std::isspace(c)) {
+            token.push_back((char)c);
+            c = file.get();
+        }
+        // The single whitespace after the last header field is consumed here
+        return !token.empty();
+    }
+
+}
+
+StripeImageReader::~StripeImageReader() {
+    close();
+}
+
+bool StripeImageReader::open(const std::string& path) {
+    close();
+    m_path = path;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    char magic[2] = {};
+    file.read(magic, 2);
+    file.close();
+
+    bool parsed = false;
+    if (magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6')) {
+        parsed = openPnm();
+    } else if ((magic[0] == 'I' && magic[1] == 'I') || (magic[0] == 'M' && magic[1] == 'M')) {
+        parsed = openTiff();
+    }
+    if (!parsed) {
+        close();
+        return false;
+    }
+
+    if (m_maxValue != 255 || m_invert) {
+        m_lut.resize(256);
+        for (int v = 0; v < 256; ++v) {
+            int scaled = std::min(255, (v * 255 + m_maxValue / 2) / m_maxValue);
+            m_lut[v] = (uint8_t)(m_invert ? 255 - scaled : scaled);
+        }
+    }
+
+#ifdef _WIN32
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    m_granularity = system.dwAllocationGranularity;
+    m_fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    LARGE_INTEGER size;
+    if (m_fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_fileHandle, &size)) {
+        m_fileHandle = nullptr;
+        close();
+        return false;
+    }
+    m_fileSize = (uint64_t)size.QuadPart;
+    m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mappingHandle) {
+        close();
+        return false;
+    }
+#else
+    m_granularity = (uint64_t)sysconf(_SC_PAGESIZE);
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (m_fd < 0 || fstat(m_fd, &info) != 0) {
+        close();
+        return false;
+    }
+    m_fileSize = (uint64_t)info.st_size;
+#endif
+    return true;
+}
+
+bool StripeImageReader::openPnm() {
+    std::ifstream file(m_path, std::ios::binary);
+    std::string magic, width, height, maxValue;
+    if (!readPnmToken(file, magic) || !readPnmToken(file, width) || !readPnmToken(file, height) ||
+        !readPnmToken(file, maxValue)) {
+        return false;
+    }
+
+    m_samples = magic == "P6" ? 3 : 1;
+    m_width = std::atoi(width.c_str());
+    m_height = std::atoi(height.c_str());
+    m_maxValue = std::atoi(maxValue.c_str());
+    if (m_width <= 0 || m_height <= 0 || m_maxValue <= 0 || m_maxValue > 65535) return false;
+
+    m_bytesPerSample = m_maxValue > 255 ? 2 : 1;
+    m_bigEndian = true;
+    m_dataOffset = (uint64_t)file.tellg();
+    m_chunkRows = 1;
+    return true;
+}
+
+bool StripeImageReader::openTiff() {
+    std::ifstream file(m_path, std::ios::binary);
+    TiffDirectory directory;
+    if (!directory.read(file)) return false;
+
+    enum Tag {
+        ImageWidth = 256, ImageLength = 257, BitsPerSample = 258, Compression = 259,
+        Photometric = 262, StripOffsets = 273, SamplesPerPixel = 277, RowsPerStrip = 278,
+        StripByteCounts = 279, PlanarConfig = 284, TileWidth = 322, TileLength = 323,
+        TileOffsets = 324, TileByteCounts = 325, SampleFormat = 339
+    };
+
+    int width = (int)directory.value(ImageWidth, 0);
+    int height = (int)directory.value(ImageLength, 0);
+    int bits = (int)directory.value(BitsPerSample, 1);
+    int samples = (int)directory.value(SamplesPerPixel, 1);
+    int photometric = (int)directory.value(Photometric, 1);
+
+    // Only layouts that can be addressed directly in the file are streamed
+    if (directory.value(Compression, 1) != 1 || directory.value(PlanarConfig, 1) != 1 ||
+        directory.value(SampleFormat, 1) != 1) {
+        std::cerr << "StripeImageReader: " << m_path << " is compressed or planar; not streamable" << std::endl;
+        return false;
+    }
+    if (width <= 0 || height <= 0 || (bits != 8 && bits != 16) || photometric > 2 ||
+        !(samples == 1 || samples == 3 || samples == 4) || (photometric == 2) != (samples >= 3)) {
+        std::cerr << "StripeImageReader: Unsupported TIFF pixel layout in " << m_path << std::endl;
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_samples = samples;
+    m_bytesPerSample = bits / 8;
+    m_maxValue = bits == 8 ? 255 : 65535;
+    m_bigEndian = directory.isBigEndian();
+    m_invert = photometric == 0;
+
+    std::vector<uint64_t> offsets, counts;
+    m_tiled = directory.has(TileOffsets);
+    if (m_tiled) {
+        m_tileWidth = (int)directory.value(TileWidth, 0);
+        m_chunkRows = (int)directory.value(TileLength, 0);
+        if (m_tileWidth <= 0 || m_chunkRows <= 0) return false;
+        m_tilesAcross = (m_width + m_tileWidth - 1) / m_tileWidth;
+        offsets = directory.array(TileOffsets);
+        counts = directory.array(TileByteCounts);
+        size_t tilesDown = (m_height + m_chunkRows - 1) / m_chunkRows;
+        if (offsets.size() < (size_t)m_tilesAcross * tilesDown) return false;
+    } else {
+        m_chunkRows = (int)std::min<uint64_t>(directory.value(RowsPerStrip, m_height), (uint64_t)m_height);
+        if (m_chunkRows <= 0) return false;
+        offsets = directory.array(StripOffsets);
+        counts = directory.array(StripByteCounts);
+        if (offsets.size() < (size_t)((m_height + m_chunkRows - 1) / m_chunkRows)) return false;
+    }
+    if (counts.size() != offsets.size()) return false;
+
+    m_chunks.resize(offsets.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        m_chunks[i].offset = offsets[i];
+        m_chunks[i].bytes = counts[i];
+    }
+    return true;
+}
+
+void StripeImageReader::close() {
+    unmapWindow();
+#ifdef _WIN32
+    if (m_mappingHandle) CloseHandle(m_mappingHandle);
+    if (m_fileHandle) CloseHandle(m_fileHandle);
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+#endif
+    m_width = m_height = 0;
+    m_tiled = false;
+    m_invert = false;
+    m_maxValue = 255;
+    m_chunks.clear();
+    m_lut.clear();
+}
+
+const uint8_t* StripeImageReader::mapWindow(uint64_t offset, uint64_t length) {
+    unmapWindow();
+    if (length == 0 || offset + length > m_fileSize) return nullptr;
+
+    uint64_t aligned = offset - offset % m_granularity;
+    size_t bytes = (size_t)(length + (offset - aligned));
+#ifdef _WIN32
+    void* view = MapViewOfFile(m_mappingHandle, FILE_MAP_READ, (DWORD)(aligned >> 32), (DWORD)(aligned & 0xFFFFFFFFu), bytes);
+    if (!view) return nullptr;
+#else
+    void* view = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, m_fd, (off_t)aligned);
+    if (view == MAP_FAILED) return nullptr;
+    madvise(view, bytes, MADV_SEQUENTIAL);
+#endif
+    m_view = view;
+    m_viewBytes = bytes;
+    return (const uint8_t*)view + (offset - aligned);
+}
+
+void StripeImageReader::unmapWindow() {
+    if (!m_view) return;
+    // Unmapping drops the window's pages from the resident set
+#ifdef _WIN32
+    UnmapViewOfFile(m_view);
+#else
+    munmap(m_view, m_viewBytes);
+#endif
+    m_view = nullptr;
+    m_viewBytes = 0;
+}
+
+void StripeImageReader::convertPixels(const uint8_t* src, int count, cv::Vec3b* dst) const {
+    int stride = m_samples * m_bytesPerSample;
+    auto sample = [&](const uint8_t* pixel, int index) -> uint8_t {
+        if (m_bytesPerSample == 1) {
+            return m_lut.empty() ? pixel[index] : m_lut[pixel[index]];
+        }
+        const uint8_t* bytes = pixel + index * 2;
+        uint32_t value = m_bigEndian ? (bytes[0] << 8) | bytes[1] : (bytes[1] << 8) | bytes[0];
+        uint32_t scaled = std::min<uint32_t>(255, (value * 255 + m_maxValue / 2) / m_maxValue);
+        return (uint8_t)(m_invert ? 255 - scaled : scaled);
+    };
+
+    for (int x = 0; x < count; ++x, src += stride) {
+        if (m_samples < 3) {
+            uint8_t gray = sample(src, 0);
+            dst[x] = cv::Vec3b(gray, gray, gray);
+        } else {
+            dst[x] = cv::Vec3b(sample(src, 2), sample(src, 1), sample(src, 0));
+        }
+    }
+}
+
+size_t StripeImageReader::readRows(int y, int count, cv::Mat& stripe) {
+    if (!isOpen() || y < 0 || count <= 0 || y + count > m_height) return 0;
+    stripe.create(count, m_width, CV_8UC3);
+
+    uint64_t pixelBytes = (uint64_t)m_samples * m_bytesPerSample;
+    uint64_t rowBytes = pixelBytes * m_width;
+    size_t largestWindow = 0;
+    int end = y + count;
+
+    if (m_chunks.empty()) {
+        // PNM: rows are contiguous
+        const uint8_t* data = mapWindow(m_dataOffset + (uint64_t)y * rowBytes, (uint64_t)count * rowBytes);
+        if (!data) return 0;
+        for (int row = 0; row < count; ++row) {
+            convertPixels(data + row * rowBytes, m_width, stripe.ptr<cv::Vec3b>(row));
+        }
+        largestWindow = m_viewBytes;
+        unmapWindow();
+        return std::max<size_t>(largestWindow, 1);
+    }
+
+    for (int chunkRow = y / m_chunkRows; chunkRow * m_chunkRows < end; ++chunkRow) {
+        int chunkY0 = chunkRow * m_chunkRows;
+        int r0 = std::max(y, chunkY0);
+        int r1 = std::min(end, chunkY0 + m_chunkRows);
+
+        if (!m_tiled) {
+            const Chunk& strip = m_chunks[chunkRow];
+            uint64_t offset = (uint64_t)(r0 - chunkY0) * rowBytes;
+            if (offset + (uint64_t)(r1 - r0) * rowBytes > strip.bytes) return 0;
+            const uint8_t* data = mapWindow(strip.offset + offset, (uint64_t)(r1 - r0) * rowBytes);
+            if (!data) return 0;
+            for (int row = r0; row < r1; ++row) {
+                convertPixels(data + (row - r0) * rowBytes, m_width, stripe.ptr<cv::Vec3b>(row - y));
+            }
+            largestWindow = std::max(largestWindow, m_viewBytes);
+            continue;
+        }
+
+        // Tiles: full-size tiles even at the right/bottom edges, cropped here
+        uint64_t tileRowBytes = pixelBytes * m_tileWidth;
+        for (int column = 0; column < m_tilesAcross; ++column) {
+            const Chunk& tile = m_chunks[(size_t)chunkRow * m_tilesAcross + column];
+            uint64_t offset = (uint64_t)(r0 - chunkY0) * tileRowBytes;
+            if (offset + (uint64_t)(r1 - r0) * tileRowBytes > tile.bytes) return 0;
+            const uint8_t* data = mapWindow(tile.offset + offset, (uint64_t)(r1 - r0) * tileRowBytes);
+            if (!data) return 0;
+
+            int x0 = column * m_tileWidth;
+            int pixels = std::min(m_tileWidth, m_width - x0);
+            for (int row = r0; row < r1; ++row) {
+                convertPixels(data + (row - r0) * tileRowBytes, pixels, stripe.ptr<cv::Vec3b>(row - y) + x0);
+            }
+            largestWindow = std::max(largestWindow, m_viewBytes);
+        }
+    }
+    unmapWindow();
+    return std::max<size_t>(largestWindow, 1);
+}
+
+bool canStreamImage(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[2] = {};
+    if (!file.read(magic, 2)) return false;
+    return (magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6')) ||
+           (magic[0] == 'I' && magic[1] == 'I') || (magic[0] == 'M' && magic[1] == 'M');
+}
+
+bool readAreaDownsampled(const std::string& path, int maxDimension, cv::Mat& out,
+                         StreamedLoadStats* stats, size_t stripeBudgetBytes) {
+    StripeImageReader reader;
+    if (!reader.open(path)) return false;
+    size_t peakBefore = getPeakRssBytes();
+
+    int width = reader.getWidth();
+    int height = reader.getHeight();
+    int outWidth = width;
+    int outHeight = height;
+    int longest = std::max(width, height);
+    if (maxDimension > 0 && longest > maxDimension) {
+        double scale = (double)maxDimension / longest;
+        outWidth = std::max(1, (int)std::lround(width * scale));
+        outHeight = std::max(1, (int)std::lround(height * scale));
+    }
+
+    // Stripe height from the budget, in whole file chunks when they fit
+    size_t rowBytes = (size_t)width * 3;
+    int stripeRows = (int)std::clamp<size_t>(stripeBudgetBytes / rowBytes, 1, (size_t)height);
+    int nativeRows = reader.getNativeRows();
+    if (stripeRows > nativeRows) {
+        stripeRows -= stripeRows % nativeRows;
+    }
+
+    StreamedLoadStats local;
+    local.sourceWidth = width;
+    local.sourceHeight = height;
+    local.stripeRows = stripeRows;
+    size_t largestWindow = 0;
+
+    if (outWidth == width && outHeight == height) {
+        // Small enough already: stripes go straight into the output
+        out.create(height, width, CV_8UC3);
+        for (int y = 0; y < height; y += stripeRows) {
+            int rows = std::min(stripeRows, height - y);
+            cv::Mat stripe = out.rowRange(y, y + rows);
+            size_t window = reader.readRows(y, rows, stripe);
+            if (!window) return false;
+            largestWindow = std::max(largestWindow, window);
+            ++local.stripes;
+        }
+        local.bufferBytes = largestWindow;
+    } else {
+        // Each source pixel covers 1/scale of an output pixel per axis and straddles at most two
+        double pixelWidth = (double)outWidth / width;
+        double pixelHeight = (double)outHeight / height;
+        std::vector<int> columnIndex(width);
+        std::vector<float> columnWeight(width);
+        for (int x = 0; x < width; ++x) {
+            double left = x * pixelWidth;
+            int index = std::min((int)left, outWidth - 1);
+            columnIndex[x] = index;
+            columnWeight[x] = (float)(std::min(left + pixelWidth, (double)(index + 1)) - left);
+        }
+
+        cv::Mat accumulator(outHeight, outWidth, CV_32FC3, cv::Scalar(0, 0, 0));
+        std::vector<float> rowSum((size_t)outWidth * 3);
+        cv::Mat stripe;
+
+        for (int y = 0; y < height; y += stripeRows) {
+            int rows = std::min(stripeRows, height - y);
+            size_t window = reader.readRows(y, rows, stripe);
+            if (!window) return false;
+            largestWindow = std::max(largestWindow, window);
+            ++local.stripes;
+
+            for (int row = 0; row < rows; ++row) {
+                // Horizontal pass into one output-width row
+                std::fill(rowSum.begin(), rowSum.end(), 0.0f);
+                const cv::Vec3b* pixels = stripe.ptr<cv::Vec3b>(row);
+                for (int x = 0; x < width; ++x) {
+                    float* first = &rowSum[(size_t)columnIndex[x] * 3];
+                    float weight = columnWeight[x];
+                    float rest = (float)pixelWidth - weight;
+                    for (int c = 0; c < 3; ++c) first[c] += pixels[x][c] * weight;
+                    if (rest > 0.0f && columnIndex[x] + 1 < outWidth) {
+                        for (int c = 0; c < 3; ++c) first[3 + c] += pixels[x][c] * rest;
+                    }
+                }
+
+                // Vertical pass: split the row between the output rows it covers
+                double top = (y + row) * pixelHeight;
+                int outRow = std::min((int)top, outHeight - 1);
+                float weight = (float)(std::min(top + pixelHeight, (double)(outRow + 1)) - top);
+                float rest = (float)pixelHeight - weight;
+                float* target = accumulator.ptr<float>(outRow);
+                for (size_t i = 0; i < rowSum.size(); ++i) target[i] += rowSum[i] * weight;
+                if (rest > 0.0f && outRow + 1 < outHeight) {
+                    float* next = accumulator.ptr<float>(outRow + 1);
+                    for (size_t i = 0; i < rowSum.size(); ++i) next[i] += rowSum[i] * rest;
+                }
+            }
+        }
+
+        // Weights per output pixel sum to 1, so the accumulator already holds the average
+        accumulator.convertTo(out, CV_8UC3);
+        local.bufferBytes = largestWindow + stripe.total() * stripe.elemSize() +
+                            accumulator.total() * accumulator.elemSize() + rowSum.size() * sizeof(float);
+    }
+
+    local.peakRssBytes = getPeakRssBytes();
+    local.peakRssGrowth = local.peakRssBytes > peakBefore ? local.peakRssBytes - peakBefore : 0;
+    if (stats) *stats = local;
+    return true;
+}
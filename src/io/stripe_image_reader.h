@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @struct StreamedLoadStats
+ * @brief Telemetry of a readAreaDownsampled() call.
+ */
+struct StreamedLoadStats {
+    int sourceWidth = 0;       ///< Size stored in the file
+    int sourceHeight = 0;
+    int stripeRows = 0;        ///< Rows per stripe
+    int stripes = 0;           ///< Stripes read
+    size_t bufferBytes = 0;    ///< Largest mapped window + stripe + accumulator held at once
+    size_t peakRssBytes = 0;   ///< Process RSS high-water mark after the load
+    size_t peakRssGrowth = 0;  ///< How much the load raised that high-water mark
+};
+
+/**
+ * @class StripeImageReader
+ * @brief Reads very large uncompressed images a band of rows at a time.
+ *
+ * Supports binary PPM/PGM (P6/P5, 8 or 16 bit) and uncompressed, chunky
+ * TIFF/BigTIFF (gray, RGB or RGBA; 8 or 16 bit; stripped or tiled). Pixel data
+ * is never read through a buffer of the whole file: each strip, tile or row
+ * range is memory-mapped only while it is converted, so resident memory is
+ * bounded by the stripe size rather than the image size.
+ */
+class StripeImageReader {
+public:
+    StripeImageReader() = default;
+    ~StripeImageReader();
+
+    StripeImageReader(const StripeImageReader&) = delete;
+    StripeImageReader& operator=(const StripeImageReader&) = delete;
+
+    /**
+     * @brief Parses the header. Fails for formats this reader can't stream (e.g. compressed TIFF).
+     */
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_width > 0; }
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    /**
+     * @brief Rows stored together in the file (TIFF strip or tile height; 1 for PNM).
+     *
+     * Stripes that are a multiple of this map each chunk once.
+     */
+    int getNativeRows() const { return m_chunkRows; }
+
+    /**
+     * @brief Converts rows [y, y + count) to 8-bit BGR.
+     * @param stripe Receives a count x width CV_8UC3 image (reallocated only if the size changes).
+     * @return Largest mapped window in bytes, or 0 on failure.
+     */
+    size_t readRows(int y, int count, cv::Mat& stripe);
+
+private:
+    struct Chunk {
+        uint64_t offset = 0;
+        uint64_t bytes = 0;
+    };
+
+    bool openPnm();
+    bool openTiff();
+
+    /**
+     * @brief Maps a read-only window of the file. Only one window is mapped at a time.
+     */
+    const uint8_t* mapWindow(uint64_t offset, uint64_t length);
+    void unmapWindow();
+
+    /**
+     * @brief Converts `count` pixels of packed samples to BGR.
+     */
+    void convertPixels(const uint8_t* src, int count, cv::Vec3b* dst) const;
+
+    std::string m_path;
+    int m_width = 0;
+    int m_height = 0;
+    int m_samples = 0;           ///< Samples per pixel (1, 3 or 4)
+    int m_bytesPerSample = 1;
+    bool m_bigEndian = true;     ///< Byte order of 16-bit samples
+    bool m_invert = false;       ///< TIFF WhiteIsZero
+    int m_maxValue = 255;
+    std::vector<uint8_t> m_lut;  ///< 8-bit sample -> 0..255, for maxValue != 255 or inverted
+
+    // Layout: PNM is one chunk per row; TIFF is per strip or tile
+    bool m_tiled = false;
+    int m_chunkRows = 1;         ///< Rows per chunk (strip / tile height)
+    int m_tileWidth = 0;
+    int m_tilesAcross = 0;
+    uint64_t m_dataOffset = 0;   ///< PNM pixel data start
+    std::vector<Chunk> m_chunks; ///< TIFF strips, or tiles in row-major order
+
+    // Mapped window
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    uint64_t m_fileSize = 0;
+    uint64_t m_granularity = 4096;
+    void* m_view = nullptr;
+    size_t m_viewBytes = 0;
+};
+
+/**
+ * @brief True if the file is a format StripeImageReader handles.
+ */
+bool canStreamImage(const std::string& path);
+
+/**
+ * @brief Streams an image into an area-averaged copy whose longest side is at most maxDimension.
+ *
+ * Rows are read in stripes of about stripeBudgetBytes and folded into a
+ * floating-point accumulator at the output size, with exact fractional
+ * pixel coverage on both axes (the same result as cv::resize with INTER_AREA).
+ *
+ * @param path Image file (see StripeImageReader).
+ * @param maxDimension Longest side of the output (0 = keep the full size).
+ * @param out Receives the BGR result.
+ * @param stats Optional telemetry.
+ * @param stripeBudgetBytes Target size of one decoded stripe.
+ * @return true On success.
+ */
+bool readAreaDownsampled(const std::string& path, int maxDimension, cv::Mat& out,
+                         StreamedLoadStats* stats = nullptr, size_t stripeBudgetBytes = 16u << 20);
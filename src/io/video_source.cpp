@@ -0,0 +1,302 @@
+#include "video_source.h"
+#include "../core/cpu_profiler.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+VideoSource::~VideoSource() {
+    close();
+}
+
+bool VideoSource::open(const std::string& path) {
+    close();
+
+    // Y4M is read as raw planes; everything else goes through OpenCV's decoders
+    std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    m_isY4m = extension == ".y4m";
+
+    if (m_isY4m) {
+        if (!m_y4m.open(path)) {
+            return false;
+        }
+        m_frameCount = m_y4m.getFrameCount();
+        m_fps = m_y4m.getFps();
+        m_width = m_y4m.getWidth();
+        m_height = m_y4m.getHeight();
+    } else {
+        if (!m_capture.open(path)) {
+            return false;
+        }
+        m_frameCount = std::max(0, (int)m_capture.get(cv::CAP_PROP_FRAME_COUNT));
+        m_fps = m_capture.get(cv::CAP_PROP_FPS);
+        m_width = (int)m_capture.get(cv::CAP_PROP_FRAME_WIDTH);
+        m_height = (int)m_capture.get(cv::CAP_PROP_FRAME_HEIGHT);
+    }
+    m_path = path;
+    if (m_fps <= 0.0 || m_fps > 240.0) m_fps = 30.0; // Some containers don't report a rate
+
+    // Playback state
+    if (m_outputSize.area() == 0) m_outputSize = cv::Size(m_width, m_height);
+    m_playing = true;
+    m_currentFrame = -1;
+    m_clockValid = false;
+    m_presentOnce = false;
+    m_presented = 0;
+    m_lateSkipped = 0;
+    m_underruns = 0;
+    m_decodeMs = 0.0f;
+    m_endOfFile = false;
+
+    post(0);
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&VideoSource::decodeLoop, this);
+    return true;
+}
+
+void VideoSource::close() {
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_capture.isOpened()) {
+        m_capture.release();
+    }
+    m_y4m.close();
+    while (m_queue.beginRead()) {
+        m_queue.endRead();
+    }
+    m_currentFrame = -1;
+}
+
+void VideoSource::setOutputSize(int width, int height) {
+    cv::Size size(std::max(1, width), std::max(1, height));
+    if (size == m_outputSize) return;
+    m_outputSize = size;
+
+    if (isOpened()) {
+        // Re-decode the current frame at the new size and continue from there
+        post(std::max(0, m_currentFrame));
+        m_presentOnce = true;
+    }
+}
+
+void VideoSource::seek(int frameIndex) {
+    if (!isOpened()) return;
+    if (m_frameCount > 0) frameIndex = std::min(frameIndex, m_frameCount - 1);
+    post(std::max(0, frameIndex));
+    m_presentOnce = true;
+    m_clockValid = false;
+}
+
+void VideoSource::setYuvNative(bool yuvNative) {
+    if (yuvNative == m_yuvNative.load(std::memory_order_relaxed)) return;
+    m_yuvNative.store(yuvNative, std::memory_order_relaxed);
+
+    if (isOpened() && m_isY4m) {
+        // Re-decode the current frame through the other path
+        post(std::max(0, m_currentFrame));
+        m_presentOnce = true;
+    }
+}
+
+void VideoSource::setPlaying(bool playing) {
+    m_playing = playing;
+    m_clockValid = false;
+}
+
+/**
+ * @brief Sends a seek (and the current output size) to the decoder.
+ *
+ * Frames already queued belong to the previous epoch and are discarded by poll().
+ */
+void VideoSource::post(int seekFrame) {
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    m_request.seekFrame = seekFrame;
+    m_request.outputSize = m_outputSize;
+    m_requestEpoch.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Positions the capture so the next read() returns exactly @p frameIndex.
+ *
+ * Container seeks land on a nearby keyframe in some backends, so the reported
+ * position is checked and the remaining frames are skipped with grab() (no color
+ * conversion). An overshoot falls back to skipping from the start of the file.
+ */
+bool VideoSource::seekExact(int frameIndex) {
+    if (m_isY4m) {
+        return m_y4m.seek(frameIndex);
+    }
+
+    m_capture.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
+    if (frameIndex == 0) return true;
+
+    int position = (int)m_capture.get(cv::CAP_PROP_POS_FRAMES);
+    if (position < 0 || position > frameIndex) {
+        m_capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+        position = 0;
+    }
+    while (position < frameIndex && m_capture.grab()) {
+        ++position;
+    }
+    return position == frameIndex;
+}
+
+void VideoSource::decodeLoop() {
+    CpuProfiler::setThreadName("Video Decode");
+    uint64_t epoch = 0;
+    cv::Size outputSize;
+    int nextIndex = 0;
+
+    while (m_running.load(std::memory_order_acquire)) {
+        // Apply the latest seek/resize request
+        if (m_requestEpoch.load(std::memory_order_acquire) != epoch) {
+            Request request;
+            {
+                std::lock_guard<std::mutex> lock(m_requestMutex);
+                request = m_request;
+                epoch = m_requestEpoch.load(std::memory_order_relaxed);
+            }
+            outputSize = request.outputSize;
+            if (!seekExact(request.seekFrame)) {
+                std::cerr << "VideoSource: Could not seek to frame " << request.seekFrame << std::endl;
+            }
+            nextIndex = request.seekFrame;
+            m_endOfFile.store(false, std::memory_order_relaxed);
+        }
+
+        if (m_endOfFile.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+
+        // Queue full: playback has enough decoded ahead
+        Frame* slot = m_queue.beginWrite();
+        if (!slot) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            continue;
+        }
+
+        Clock::time_point start = Clock::now();
+        if (!decodeNext(*slot, outputSize)) {
+            if (m_looping.load(std::memory_order_relaxed) && nextIndex > 0) {
+                seekExact(0);
+                nextIndex = 0;
+            } else {
+                m_endOfFile.store(true, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        slot->index = nextIndex++;
+        slot->epoch = epoch;
+        m_queue.commitWrite();
+
+        std::chrono::duration<float, std::milli> elapsed = Clock::now() - start;
+        float decodeMs = m_decodeMs.load(std::memory_order_relaxed);
+        m_decodeMs.store(decodeMs == 0.0f ? elapsed.count() : decodeMs * 0.9f + elapsed.count() * 0.1f,
+                         std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Decodes the next frame into @p slot at @p outputSize.
+ *
+ * Frames are resized to the simulation grid here so the main loop never has to.
+ */
+bool VideoSource::decodeNext(Frame& slot, cv::Size outputSize) {
+    PROFILE_SCOPE("Video Decode");
+    if (m_isY4m) {
+        if (!m_y4m.read(m_yuvFrame)) return false;
+
+        if (m_yuvNative.load(std::memory_order_relaxed)) {
+            // Shrink the planes first; color conversion only runs at grid size
+            yuvToBgr(m_yuvFrame, outputSize, slot.image, &slot.luma);
+        } else {
+            // What a regular decoder does: full-size BGR conversion, then resize
+            yuvToBgr(m_yuvFrame, m_yuvFrame.y.size(), m_decoded);
+            cv::resize(m_decoded, slot.image, outputSize, 0, 0, cv::INTER_AREA);
+            slot.luma.release();
+        }
+        return true;
+    }
+
+    if (!m_capture.read(m_decoded) || m_decoded.empty()) return false;
+
+    if (m_decoded.size() == outputSize) {
+        m_decoded.copyTo(slot.image);
+    } else {
+        cv::resize(m_decoded, slot.image, outputSize, 0, 0, cv::INTER_AREA);
+    }
+    slot.luma.release();
+    return true;
+}
+
+bool VideoSource::poll(cv::Mat& frame, cv::Mat* luma) {
+    if (!isOpened()) return false;
+
+    // Drop frames decoded before the latest seek/resize
+    uint64_t epoch = m_requestEpoch.load(std::memory_order_relaxed);
+    Frame* next = m_queue.beginRead();
+    while (next && next->epoch != epoch) {
+        m_queue.endRead();
+        next = m_queue.beginRead();
+    }
+
+    Clock::time_point now = Clock::now();
+    std::chrono::duration<double> frameTime(1.0 / m_fps);
+    if (!m_clockValid) {
+        m_nextPresent = now;
+        m_clockValid = true;
+    }
+
+    bool due = m_playing && now >= m_nextPresent;
+    if (!due && !m_presentOnce) return false;
+    if (!next) {
+        if (m_playing && !isFinished()) ++m_underruns;
+        return false;
+    }
+
+    if (m_playing) {
+        // Resync after a stall (e.g. another input mode was active) instead of fast-forwarding
+        if (now - m_nextPresent > std::chrono::milliseconds(250)) {
+            m_nextPresent = now;
+        }
+        // Skip frames that are already overdue, keeping at least one to present
+        while (now >= m_nextPresent + frameTime && m_queue.size() > 1) {
+            m_queue.endRead();
+            next = m_queue.beginRead();
+            m_nextPresent += std::chrono::duration_cast<Clock::duration>(frameTime);
+            ++m_lateSkipped;
+        }
+        m_nextPresent += std::chrono::duration_cast<Clock::duration>(frameTime);
+    }
+
+    std::swap(frame, next->image); // Hand our previous buffer back to the queue
+    if (luma) {
+        std::swap(*luma, next->luma); // Empty for BGR frames
+    }
+    m_currentFrame = next->index;
+    m_queue.endRead();
+
+    m_presentOnce = false;
+    ++m_presented;
+    return true;
+}
+
+bool VideoSource::isFinished() const {
+    return !isLooping() && m_endOfFile.load(std::memory_order_relaxed) && m_queue.size() == 0;
+}
+
+VideoStats VideoSource::getStats() const {
+    VideoStats stats;
+    stats.decodeMs = m_decodeMs.load(std::memory_order_relaxed);
+    stats.decodeFps = stats.decodeMs > 0.0f ? 1000.0f / stats.decodeMs : 0.0f;
+    stats.queued = m_queue.size();
+    stats.capacity = m_queue.capacity();
+    stats.presented = m_presented;
+    stats.lateSkipped = m_lateSkipped;
+    stats.underruns = m_underruns;
+    return stats;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include "../core/spsc_ring.h"
+#include "y4m_reader.h"
+
+/**
+ * @struct VideoStats
+ * @brief Decoder and playback counters of a VideoSource.
+ */
+struct VideoStats {
+    float decodeFps = 0.0f;     ///< Smoothed decoder throughput (decode + resize), frames/s
+    float decodeMs = 0.0f;      ///< Smoothed decode + resize time per frame
+    size_t queued = 0;          ///< Frames decoded ahead and waiting
+    size_t capacity = 0;        ///< Decode-ahead queue capacity
+    uint64_t presented = 0;     ///< Frames handed to the main loop
+    uint64_t lateSkipped = 0;   ///< Frames skipped because playback fell behind
+    uint64_t underruns = 0;     ///< Polls where a frame was due but none was decoded yet
+};
+
+/**
+ * @class VideoSource
+ * @brief Plays a video file through a decode-ahead thread.
+ *
+ * The decoder thread reads frames with cv::VideoCapture, resizes them to the
+ * requested output size (the simulation grid) and keeps a bounded SPSC queue
+ * filled ahead of playback. poll() presents frames at the file's frame rate and
+ * never waits on the decoder. Seeks and output size changes are sent to the
+ * decoder as requests; frames decoded before a request are discarded.
+ *
+ * Y4M files are read natively as YUV planes. In that mode only the grid-sized
+ * planes are color converted, and the grid-sized luma plane is handed out
+ * alongside each frame so it can be sorted on directly.
+ */
+class VideoSource {
+public:
+    VideoSource() = default;
+    ~VideoSource();
+
+    VideoSource(const VideoSource&) = delete;
+    VideoSource& operator=(const VideoSource&) = delete;
+
+    /**
+     * @brief Opens a video file and starts decoding from the first frame.
+     *
+     * @param path Path to the video file.
+     * @return true If the file could be opened.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Stops the decoder and closes the file.
+     */
+    void close();
+
+    bool isOpened() const { return m_thread.joinable(); }
+
+    /**
+     * @brief Sets the size frames are resized to while decoding.
+     *
+     * Changing the size flushes the queue and re-decodes from the current frame.
+     */
+    void setOutputSize(int width, int height);
+
+    /**
+     * @brief Presents the next frame if it is due. Never blocks.
+     *
+     * @param frame Receives the frame (output size, BGR); left untouched otherwise.
+     * @param luma Optional: receives the output-size luma plane (CV_8UC1) of
+     *             YUV-native frames, or is released for BGR frames.
+     * @return true If a new frame was written.
+     */
+    bool poll(cv::Mat& frame, cv::Mat* luma = nullptr);
+
+    /**
+     * @brief Seeks to an exact frame index. The next presented frame is that frame.
+     */
+    void seek(int frameIndex);
+
+    void setPlaying(bool playing);
+    bool isPlaying() const { return m_playing; }
+
+    /**
+     * @brief Restart from the first frame at end of file instead of stopping.
+     */
+    void setLooping(bool looping) { m_looping.store(looping, std::memory_order_relaxed); }
+    bool isLooping() const { return m_looping.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief True if the file is decoded as YUV planes (Y4M).
+     */
+    bool isYuvSource() const { return m_isY4m; }
+
+    /**
+     * @brief For YUV sources: convert at grid size and keep luma (true), or
+     * convert to BGR at full size first like a regular decoder (false, for comparison).
+     */
+    void setYuvNative(bool yuvNative);
+    bool isYuvNative() const { return m_isY4m && m_yuvNative.load(std::memory_order_relaxed); }
+
+    int getFrameCount() const { return m_frameCount; }
+    double getFps() const { return m_fps; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    /**
+     * @brief Index of the last presented frame (-1 before the first one).
+     */
+    int getCurrentFrame() const { return m_currentFrame; }
+
+    /**
+     * @brief True once a non-looping video has presented its last frame.
+     */
+    bool isFinished() const;
+
+    VideoStats getStats() const;
+
+    /**
+     * @brief Frames decoded ahead of playback.
+     */
+    static constexpr size_t kQueueSize = 8;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+        cv::Mat image;
+        cv::Mat luma;        ///< Output-size Y plane (YUV-native frames only)
+        int index = 0;
+        uint64_t epoch = 0;  ///< Request epoch the frame was decoded under
+    };
+
+    /**
+     * @struct Request
+     * @brief Pending decoder command, applied when the epoch changes.
+     */
+    struct Request {
+        int seekFrame = 0;
+        cv::Size outputSize;
+    };
+
+    void decodeLoop();
+    bool decodeNext(Frame& slot, cv::Size outputSize);
+    void post(int seekFrame);
+    bool seekExact(int frameIndex);
+
+    std::string m_path;
+    int m_frameCount = 0;
+    double m_fps = 30.0;
+    int m_width = 0;
+    int m_height = 0;
+
+    // Decoder thread
+    cv::VideoCapture m_capture;  ///< Owned by the decoder thread while it runs
+    Y4mReader m_y4m;             ///< Used instead of m_capture for .y4m files
+    bool m_isY4m = false;
+    YuvFrame m_yuvFrame;         ///< Decoder-thread scratch planes
+    cv::Mat m_decoded;           ///< Decoder-thread scratch image
+    std::atomic<bool> m_yuvNative{ true };
+    SpscRing<Frame> m_queue{ kQueueSize };
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+    std::atomic<bool> m_looping{ true };
+    std::atomic<bool> m_endOfFile{ false };
+    std::atomic<float> m_decodeMs{ 0.0f };
+
+    // Decoder requests (seek / resize); the mutex only guards m_request
+    std::mutex m_requestMutex;
+    Request m_request;
+    std::atomic<uint64_t> m_requestEpoch{ 0 };
+
+    // Playback state (main thread only)
+    cv::Size m_outputSize;
+    bool m_playing = true;
+    int m_currentFrame = -1;
+    Clock::time_point m_nextPresent;
+    bool m_clockValid = false;
+    bool m_presentOnce = false;  ///< Show the next frame even when paused (after a seek)
+    uint64_t m_presented = 0;
+    uint64_t m_lateSkipped = 0;
+    uint64_t m_underruns = 0;
+};
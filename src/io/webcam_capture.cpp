@@ -0,0 +1,220 @@
+#include "webcam_capture.h"
+#include "../core/cpu_profiler.h"
+#include "../core/metrics.h"
+#include <iostream>
+#include <utility>
+
+WebcamCapture::~WebcamCapture() {
+    stop();
+}
+
+void WebcamCapture::start(int deviceIndex) {
+    stop();
+
+    m_captured = 0;
+    m_dropped = 0;
+    m_captureFps = 0.0f;
+    m_consumed = 0;
+    m_stale = 0;
+    m_latencyMs = 0.0f;
+    m_avgLatencyMs = 0.0f;
+    m_openAttempts = 0;
+    m_reconnects = 0;
+    m_openMs = 0.0f;
+    m_firstFrameMs = -1.0f;
+
+    m_startTime = Clock::now();
+    m_state.store(WebcamState::Opening, std::memory_order_release);
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&WebcamCapture::run, this, deviceIndex);
+}
+
+void WebcamCapture::stop() {
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_capture.isOpened()) {
+        m_capture.release();
+    }
+    m_state.store(WebcamState::Stopped, std::memory_order_release);
+
+    // Drop anything left in the ring
+    while (m_ring.beginRead()) {
+        m_ring.endRead();
+    }
+}
+
+void WebcamCapture::release() {
+    m_running.store(false, std::memory_order_release);
+}
+
+void WebcamCapture::run(int deviceIndex) {
+    CpuProfiler::setThreadName("Webcam Capture");
+    Counter& reconnectMetric = Metrics::counter("lumasort_webcam_reconnects_total", "Times a lost webcam was opened again");
+    bool lost = false;
+
+    while (m_running.load(std::memory_order_acquire)) {
+        m_state.store(WebcamState::Opening, std::memory_order_release);
+        m_retryNow.store(false, std::memory_order_relaxed);
+        int attempt = m_openAttempts.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        Clock::time_point openStart = Clock::now();
+        bool opened;
+        {
+            PROFILE_SCOPE("Open Camera");
+            opened = m_capture.open(deviceIndex);
+        }
+
+        if (!opened) {
+            if (attempt == 1) {
+                std::cerr << "WebcamCapture: Could not open camera " << deviceIndex << "; retrying every "
+                          << kRetrySeconds << " s." << std::endl;
+            }
+        } else if (!m_running.load(std::memory_order_acquire)) {
+            // Released while the open was in progress
+            m_capture.release();
+            break;
+        } else {
+            float openMs = std::chrono::duration<float, std::milli>(Clock::now() - openStart).count();
+            m_openMs.store(openMs, std::memory_order_relaxed);
+            std::cout << "WebcamCapture: Opened camera " << deviceIndex << " in " << openMs << " ms" << std::endl;
+            if (lost) {
+                m_reconnects.fetch_add(1, std::memory_order_relaxed);
+                reconnectMetric.add();
+            }
+
+            // Preallocate the pool at the camera's native size so frames are decoded in place.
+            // Skipped if frames from before a reconnect are still unread; capture then resizes as needed.
+            int width = (int)m_capture.get(cv::CAP_PROP_FRAME_WIDTH);
+            int height = (int)m_capture.get(cv::CAP_PROP_FRAME_HEIGHT);
+            if (width > 0 && height > 0) {
+                m_ring.forEachSlot([&](Slot& slot) {
+                    slot.image.create(height, width, CV_8UC3);
+                });
+            }
+
+            m_state.store(WebcamState::Streaming, std::memory_order_release);
+            lost = !captureLoop();
+            m_capture.release();
+            if (lost) {
+                std::cerr << "WebcamCapture: Camera " << deviceIndex << " stopped delivering frames; reopening." << std::endl;
+            }
+        }
+
+        if (!m_running.load(std::memory_order_acquire)) break;
+        m_state.store(WebcamState::Retrying, std::memory_order_release);
+        waitForRetry();
+    }
+
+    m_state.store(WebcamState::Stopped, std::memory_order_release);
+}
+
+void WebcamCapture::waitForRetry() {
+    const Clock::time_point due = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(kRetrySeconds));
+    while (m_running.load(std::memory_order_acquire) && Clock::now() < due &&
+           !m_retryNow.exchange(false, std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+
+bool WebcamCapture::captureLoop() {
+    Counter& capturedMetric = Metrics::counter("lumasort_webcam_frames_total", "Webcam frames decoded");
+    Counter& droppedMetric = Metrics::counter("lumasort_webcam_dropped_frames_total",
+                                              "Webcam frames discarded because the consumer was behind");
+    LatencyHistogram& firstFrameMetric = Metrics::histogram("lumasort_webcam_first_frame_seconds",
+                                                            "Time from starting the webcam to its first frame", 1e-3);
+    Clock::time_point lastFrame = Clock::now();
+    const auto lostAfter = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(kLostSeconds));
+
+    while (m_running.load(std::memory_order_acquire)) {
+        Slot* slot = m_ring.beginWrite();
+        bool ok;
+        if (slot) {
+            PROFILE_SCOPE("Capture");
+            ok = m_capture.read(slot->image) && !slot->image.empty();
+        } else {
+            // Consumer is behind: keep the camera's own queue drained without decoding
+            ok = m_capture.grab();
+            if (ok) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                droppedMetric.add();
+            }
+        }
+
+        if (!ok) {
+            // Not ready yet, or unplugged; back off instead of spinning, then give the device up
+            if (Clock::now() - lastFrame > lostAfter) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        Clock::time_point now = Clock::now();
+        if (slot) {
+            slot->captureTime = now;
+            m_ring.commitWrite();
+            m_captured.fetch_add(1, std::memory_order_relaxed);
+            capturedMetric.add();
+
+            if (m_firstFrameMs.load(std::memory_order_relaxed) < 0.0f) {
+                float firstFrameMs = std::chrono::duration<float, std::milli>(now - m_startTime).count();
+                m_firstFrameMs.store(firstFrameMs, std::memory_order_relaxed);
+                firstFrameMetric.record(firstFrameMs / 1000.0);
+                std::cout << "WebcamCapture: First frame " << firstFrameMs << " ms after start" << std::endl;
+            }
+        }
+
+        std::chrono::duration<float> interval = now - lastFrame;
+        lastFrame = now;
+        if (interval.count() > 0.0f) {
+            float fps = m_captureFps.load(std::memory_order_relaxed);
+            m_captureFps.store(fps * 0.9f + (1.0f / interval.count()) * 0.1f, std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+bool WebcamCapture::latest(cv::Mat& frame) {
+    size_t available = m_ring.size();
+    if (available == 0) return false;
+
+    // Skip straight to the newest frame
+    for (size_t i = 1; i < available; ++i) {
+        m_ring.beginRead();
+        m_ring.endRead();
+        ++m_stale;
+    }
+
+    Slot* slot = m_ring.beginRead();
+    std::swap(frame, slot->image); // Hand our previous buffer back to the pool
+    std::chrono::duration<float, std::milli> latency = Clock::now() - slot->captureTime;
+    m_ring.endRead();
+
+    m_latencyMs = latency.count();
+    static LatencyHistogram& latencyMetric = Metrics::histogram("lumasort_capture_latency_seconds",
+                                                                "Webcam capture-to-consume latency", 1e-6);
+    latencyMetric.record(m_latencyMs / 1000.0);
+    m_avgLatencyMs = (m_consumed == 0) ? m_latencyMs : m_avgLatencyMs * 0.9f + m_latencyMs * 0.1f;
+    ++m_consumed;
+    return true;
+}
+
+CaptureStats WebcamCapture::getStats() const {
+    CaptureStats stats;
+    stats.captured = m_captured.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.captureFps = m_captureFps.load(std::memory_order_relaxed);
+    stats.consumed = m_consumed;
+    stats.stale = m_stale;
+    stats.queued = m_ring.size();
+    stats.latencyMs = m_latencyMs;
+    stats.avgLatencyMs = m_avgLatencyMs;
+    stats.openAttempts = m_openAttempts.load(std::memory_order_relaxed);
+    stats.reconnects = m_reconnects.load(std::memory_order_relaxed);
+    stats.openMs = m_openMs.load(std::memory_order_relaxed);
+    stats.firstFrameMs = m_firstFrameMs.load(std::memory_order_relaxed);
+    return stats;
+}
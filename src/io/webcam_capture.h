@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include "../core/spsc_ring.h"
+
+/**
+ * @enum WebcamState
+ * @brief Where a WebcamCapture is in its open/capture/retry cycle.
+ */
+enum class WebcamState {
+    Stopped,    ///< Not started, or the capture thread has exited
+    Opening,    ///< Probing and opening the device (can take seconds)
+    Streaming,  ///< Device open; frames are being captured
+    Retrying    ///< No device, or it was unplugged; opening again shortly
+};
+
+/**
+ * @struct CaptureStats
+ * @brief Producer/consumer counters of a WebcamCapture.
+ */
+struct CaptureStats {
+    uint64_t captured = 0;   ///< Frames decoded into the ring
+    uint64_t consumed = 0;   ///< Frames handed to the main loop
+    uint64_t dropped = 0;    ///< Frames grabbed but discarded because the ring was full
+    uint64_t stale = 0;      ///< Frames superseded by a newer one before being consumed
+    size_t queued = 0;       ///< Frames waiting in the ring
+    float latencyMs = 0.0f;  ///< Capture-to-consume latency of the last frame
+    float avgLatencyMs = 0.0f; ///< Smoothed capture-to-consume latency
+    float captureFps = 0.0f; ///< Smoothed producer frame rate
+    int openAttempts = 0;    ///< Device opens tried since start()
+    int reconnects = 0;      ///< Times the device was lost and opened again
+    float openMs = 0.0f;     ///< Duration of the last successful open
+    float firstFrameMs = -1.0f; ///< From start() to the first captured frame (-1 = none yet)
+};
+
+/**
+ * @class WebcamCapture
+ * @brief Captures webcam frames on a dedicated thread.
+ *
+ * The producer thread decodes straight into a preallocated pool of frames and
+ * publishes them through a lock-free SPSC ring. The main loop calls latest() to
+ * take the newest frame without ever blocking on the camera.
+ *
+ * Opening the device also happens on that thread, because probing a camera can
+ * take seconds (or time out when none is attached). If no device opens, or the
+ * open one stops delivering frames (unplugged), the thread releases it and tries
+ * again every kRetrySeconds, so a camera plugged in later is picked up.
+ */
+class WebcamCapture {
+public:
+    WebcamCapture() = default;
+    ~WebcamCapture();
+
+    WebcamCapture(const WebcamCapture&) = delete;
+    WebcamCapture& operator=(const WebcamCapture&) = delete;
+
+    /**
+     * @brief Starts the capture thread, which opens the camera in the background.
+     *
+     * Returns immediately; watch getState() for the outcome. Only waits if a thread
+     * from an earlier release() is still finishing an open.
+     *
+     * @param deviceIndex Camera index passed to cv::VideoCapture.
+     */
+    void start(int deviceIndex);
+
+    /**
+     * @brief Stops the capture thread and releases the camera. Waits for an open in progress.
+     */
+    void stop();
+
+    /**
+     * @brief Asks the capture thread to release the camera and exit, without waiting.
+     *
+     * The state reads Stopped once it has; the next start() or stop() joins it.
+     */
+    void release();
+
+    /**
+     * @brief Skips the rest of the wait between open attempts while Retrying.
+     */
+    void retryNow() { m_retryNow.store(true, std::memory_order_relaxed); }
+
+    WebcamState getState() const { return m_state.load(std::memory_order_acquire); }
+    bool isOpened() const { return getState() == WebcamState::Streaming; }
+
+    /**
+     * @brief Takes the newest captured frame, if there is one. Never blocks.
+     *
+     * Older frames still in the ring are skipped (counted as stale). The frame
+     * buffer is swapped with the pool, so @p frame must not be shared with
+     * other Mats.
+     *
+     * @param frame Receives the frame; left untouched if nothing new arrived.
+     * @return true If a new frame was written.
+     */
+    bool latest(cv::Mat& frame);
+
+    /**
+     * @brief Returns a snapshot of the capture counters.
+     */
+    CaptureStats getStats() const;
+
+    /**
+     * @brief Frames the ring can hold (not counting the one owned by the consumer).
+     */
+    static constexpr size_t kPoolSize = 3;
+
+    /**
+     * @brief Wait between attempts to open a missing or lost camera.
+     */
+    static constexpr float kRetrySeconds = 2.0f;
+
+    /**
+     * @brief Time without a successful read after which the camera counts as lost.
+     *
+     * Also bounds the warm-up before the first frame, so it is generous.
+     */
+    static constexpr float kLostSeconds = 3.0f;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Slot {
+        cv::Mat image;
+        Clock::time_point captureTime;
+    };
+
+    /**
+     * @brief Capture thread: opens the device, captures until it is lost, retries.
+     */
+    void run(int deviceIndex);
+
+    /**
+     * @brief Reads frames until stopped or the camera is lost.
+     *
+     * @return false If the camera stopped delivering frames.
+     */
+    bool captureLoop();
+
+    /**
+     * @brief Sleeps until the next open attempt is due, retryNow() or stop.
+     */
+    void waitForRetry();
+
+    cv::VideoCapture m_capture; // Owned by the capture thread while it runs
+    SpscRing<Slot> m_ring{ kPoolSize };
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+    std::atomic<bool> m_retryNow{ false };
+    std::atomic<WebcamState> m_state{ WebcamState::Stopped };
+    Clock::time_point m_startTime; ///< When start() was called, for time to first frame
+
+    // Open/retry counters (written by the capture thread)
+    std::atomic<int> m_openAttempts{ 0 };
+    std::atomic<int> m_reconnects{ 0 };
+    std::atomic<float> m_openMs{ 0.0f };
+    std::atomic<float> m_firstFrameMs{ -1.0f };
+
+    // Producer-side counters (read by the consumer)
+    std::atomic<uint64_t> m_captured{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+    std::atomic<float> m_captureFps{ 0.0f };
+
+    // Consumer-side counters (main thread only)
+    uint64_t m_consumed = 0;
+    uint64_t m_stale = 0;
+    float m_latencyMs = 0.0f;
+    float m_avgLatencyMs = 0.0f;
+};
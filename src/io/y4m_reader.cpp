@@ -0,0 +1,165 @@
+#include "y4m_reader.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#define y4mSeek _fseeki64
+#define y4mTell _ftelli64
+#else
+#define y4mSeek fseeko
+#define y4mTell ftello
+#endif
+
+Y4mReader::~Y4mReader() {
+    close();
+}
+
+bool Y4mReader::open(const std::string& path) {
+    close();
+
+    m_file = fopen(path.c_str(), "rb");
+    if (!m_file) {
+        return false;
+    }
+
+    // Stream header: "YUV4MPEG2 W<w> H<h> F<n>:<d> C<colorspace> ...\n"
+    std::string header;
+    int c;
+    while ((c = fgetc(m_file)) != EOF && c != '\n' && header.size() < 1024) {
+        header.push_back((char)c);
+    }
+    if (header.compare(0, 9, "YUV4MPEG2") != 0) {
+        std::cerr << "Y4mReader: Not a YUV4MPEG2 file: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    std::string colorspace = "420jpeg";
+    m_fps = 30.0;
+    m_fullRange = false;
+    std::istringstream tokens(header.substr(9));
+    std::string token;
+    while (tokens >> token) {
+        switch (token[0]) {
+            case 'W': m_width = std::atoi(token.c_str() + 1); break;
+            case 'H': m_height = std::atoi(token.c_str() + 1); break;
+            case 'C': colorspace = token.substr(1); break;
+            case 'F': {
+                int num = 0, den = 0;
+                if (sscanf(token.c_str() + 1, "%d:%d", &num, &den) == 2 && num > 0 && den > 0) {
+                    m_fps = (double)num / den;
+                }
+                break;
+            }
+            case 'X':
+                if (token == "XCOLORRANGE=FULL") m_fullRange = true;
+                break;
+        }
+    }
+
+    if (m_width <= 0 || m_height <= 0) {
+        std::cerr << "Y4mReader: Missing frame size in header: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    if (colorspace.compare(0, 3, "420") == 0) {
+        m_chromaWidth = (m_width + 1) / 2;
+        m_chromaHeight = (m_height + 1) / 2;
+    } else if (colorspace == "422") {
+        m_chromaWidth = (m_width + 1) / 2;
+        m_chromaHeight = m_height;
+    } else if (colorspace == "444") {
+        m_chromaWidth = m_width;
+        m_chromaHeight = m_height;
+    } else if (colorspace == "mono") {
+        m_chromaWidth = 0;
+        m_chromaHeight = 0;
+    } else {
+        std::cerr << "Y4mReader: Unsupported colorspace C" << colorspace << ": " << path << std::endl;
+        close();
+        return false;
+    }
+
+    m_frameBytes = (size_t)m_width * m_height + 2 * (size_t)m_chromaWidth * m_chromaHeight;
+
+    // Estimate the frame count assuming bare "FRAME\n" headers
+    int64_t dataStart = y4mTell(m_file);
+    y4mSeek(m_file, 0, SEEK_END);
+    int64_t fileSize = y4mTell(m_file);
+    y4mSeek(m_file, dataStart, SEEK_SET);
+    m_frameCount = (int)((fileSize - dataStart) / (int64_t)(m_frameBytes + 6));
+
+    m_frameOffsets.assign(1, dataStart);
+    m_nextFrame = 0;
+    return true;
+}
+
+void Y4mReader::close() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_frameOffsets.clear();
+    m_nextFrame = 0;
+}
+
+/**
+ * @brief Consumes a "FRAME[ params]\n" header.
+ */
+bool Y4mReader::readFrameHeader() {
+    char tag[5];
+    if (fread(tag, 1, 5, m_file) != 5 || memcmp(tag, "FRAME", 5) != 0) {
+        return false;
+    }
+    int c;
+    while ((c = fgetc(m_file)) != EOF && c != '\n') {}
+    return c == '\n';
+}
+
+bool Y4mReader::read(YuvFrame& frame) {
+    if (!m_file || !readFrameHeader()) return false;
+
+    frame.y.create(m_height, m_width, CV_8UC1);
+    if (m_chromaWidth > 0) {
+        frame.u.create(m_chromaHeight, m_chromaWidth, CV_8UC1);
+        frame.v.create(m_chromaHeight, m_chromaWidth, CV_8UC1);
+    } else {
+        frame.u.release();
+        frame.v.release();
+    }
+    frame.fullRange = m_fullRange;
+
+    size_t lumaBytes = (size_t)m_width * m_height;
+    size_t chromaBytes = (size_t)m_chromaWidth * m_chromaHeight;
+    if (fread(frame.y.data, 1, lumaBytes, m_file) != lumaBytes) return false;
+    if (chromaBytes > 0) {
+        if (fread(frame.u.data, 1, chromaBytes, m_file) != chromaBytes) return false;
+        if (fread(frame.v.data, 1, chromaBytes, m_file) != chromaBytes) return false;
+    }
+
+    ++m_nextFrame;
+    if ((size_t)m_nextFrame == m_frameOffsets.size()) {
+        m_frameOffsets.push_back(y4mTell(m_file));
+    }
+    return true;
+}
+
+bool Y4mReader::seek(int frameIndex) {
+    if (!m_file || frameIndex < 0) return false;
+
+    // Skip unindexed frames by their headers, without reading the planes
+    while ((size_t)frameIndex >= m_frameOffsets.size()) {
+        y4mSeek(m_file, m_frameOffsets.back(), SEEK_SET);
+        if (!readFrameHeader() || y4mSeek(m_file, (int64_t)m_frameBytes, SEEK_CUR) != 0) {
+            return false;
+        }
+        m_frameOffsets.push_back(y4mTell(m_file));
+    }
+
+    y4mSeek(m_file, m_frameOffsets[frameIndex], SEEK_SET);
+    m_nextFrame = frameIndex;
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "yuv_frame.h"
+
+/**
+ * @class Y4mReader
+ * @brief Reads YUV4MPEG2 (.y4m) files plane by plane, without color conversion.
+ *
+ * Supports 4:2:0 (all siting variants), 4:2:2, 4:4:4 and mono 8-bit streams.
+ * Frame offsets are indexed as frames are read, so seeking is exact.
+ */
+class Y4mReader {
+public:
+    Y4mReader() = default;
+    ~Y4mReader();
+
+    Y4mReader(const Y4mReader&) = delete;
+    Y4mReader& operator=(const Y4mReader&) = delete;
+
+    /**
+     * @brief Opens a file and parses its stream header.
+     * @return true If the file is a supported Y4M stream.
+     */
+    bool open(const std::string& path);
+
+    void close();
+    bool isOpened() const { return m_file != nullptr; }
+
+    /**
+     * @brief Reads the next frame into @p frame, reusing its planes.
+     * @return false At end of file or on a truncated frame.
+     */
+    bool read(YuvFrame& frame);
+
+    /**
+     * @brief Positions the reader so the next read() returns @p frameIndex.
+     */
+    bool seek(int frameIndex);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    double getFps() const { return m_fps; }
+
+    /**
+     * @brief Number of frames, estimated from the file size (exact for plain "FRAME" headers).
+     */
+    int getFrameCount() const { return m_frameCount; }
+
+private:
+    bool readFrameHeader();
+
+    FILE* m_file = nullptr;
+    int m_width = 0;
+    int m_height = 0;
+    double m_fps = 30.0;
+    int m_frameCount = 0;
+    int m_chromaWidth = 0;   ///< 0 for mono
+    int m_chromaHeight = 0;
+    bool m_fullRange = false;
+    size_t m_frameBytes = 0; ///< Plane bytes per frame (excluding the FRAME header)
+
+    std::vector<int64_t> m_frameOffsets; ///< File offset of each known FRAME header
+    int m_nextFrame = 0;
+};
@@ -0,0 +1,44 @@
+#include "yuv_frame.h"
+
+void yuvLumaToSize(const YuvFrame& frame, cv::Size size, cv::Mat& luma) {
+    if (frame.y.size() == size) {
+        frame.y.copyTo(luma);
+    } else {
+        cv::resize(frame.y, luma, size, 0, 0, cv::INTER_AREA);
+    }
+}
+
+void yuvToBgr(const YuvFrame& frame, cv::Size size, cv::Mat& bgr, cv::Mat* luma) {
+    cv::Mat y, u, v;
+    yuvLumaToSize(frame, size, y);
+    if (luma) {
+        *luma = y;
+    }
+
+    bool mono = frame.u.empty() || frame.v.empty();
+    if (!mono) {
+        cv::resize(frame.u, u, size, 0, 0, cv::INTER_LINEAR);
+        cv::resize(frame.v, v, size, 0, 0, cv::INTER_LINEAR);
+    }
+
+    // OpenCV's YCrCb conversion expects full-range samples:
+    // expand 16-235 luma and 16-240 chroma (around 128) to 0-255
+    if (!frame.fullRange) {
+        const double chromaScale = 255.0 / 224.0;
+        cv::Mat expanded; // Keep the caller's luma untouched
+        y.convertTo(expanded, CV_8U, 255.0 / 219.0, -16.0 * 255.0 / 219.0);
+        y = expanded;
+        if (!mono) {
+            u.convertTo(u, CV_8U, chromaScale, 128.0 - 128.0 * chromaScale);
+            v.convertTo(v, CV_8U, chromaScale, 128.0 - 128.0 * chromaScale);
+        }
+    }
+    if (mono) {
+        u = cv::Mat(size, CV_8UC1, cv::Scalar(128));
+        v = u;
+    }
+
+    cv::Mat ycrcb;
+    cv::merge(std::vector<cv::Mat>{ y, v, u }, ycrcb);
+    cv::cvtColor(ycrcb, bgr, cv::COLOR_YCrCb2BGR);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @struct YuvFrame
+ * @brief A planar YUV image (4:2:0, 4:2:2, 4:4:4 or luma only).
+ *
+ * Planes are kept separate and at their native sizes so the luma plane can be
+ * used directly as the sort key and chroma is only touched at the sizes that
+ * are actually needed.
+ */
+struct YuvFrame {
+    cv::Mat y;                 ///< Luma plane (CV_8UC1, full size)
+    cv::Mat u;                 ///< Cb plane (CV_8UC1, subsampled); empty for mono
+    cv::Mat v;                 ///< Cr plane (CV_8UC1, subsampled); empty for mono
+    bool fullRange = false;    ///< true for JPEG-range (0-255) samples, false for 16-235
+
+    bool empty() const { return y.empty(); }
+};
+
+/**
+ * @brief Resizes the luma plane to @p size.
+ *
+ * @param frame Source frame.
+ * @param size Output size (usually the simulation grid).
+ * @param luma Receives a CV_8UC1 image.
+ */
+void yuvLumaToSize(const YuvFrame& frame, cv::Size size, cv::Mat& luma);
+
+/**
+ * @brief Converts a frame to BGR at @p size, resizing the planes first.
+ *
+ * Color conversion runs at the output size only, never at the source size.
+ *
+ * @param frame Source frame.
+ * @param size Output size (usually the simulation grid).
+ * @param bgr Receives a CV_8UC3 image.
+ * @param luma Optional: receives the resized luma plane that was used.
+ */
+void yuvToBgr(const YuvFrame& frame, cv::Size size, cv::Mat& bgr, cv::Mat* luma = nullptr);
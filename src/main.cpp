@@ -1,20 +1,60 @@
 /**
  * LumaSort Engine - Main Entry Point
- * 
+ *
  * This file bootstraps the application by creating the App instance and entering the run loop.
  * It serves as the bridge between the OS and our engine's lifecycle.
+ *
+ * With --headless, no window, GL context or webcam is created; the batch runner
+ * processes source/target jobs from the command line instead.
+ *
+ * --metrics-file PATH, --metrics-port PORT and --metrics-interval SECONDS publish
+ * runtime metrics (frame time, sort time, capture latency, memory) for long runs.
+ *
+ * --no-shader-cache compiles every GL program instead of loading cached binaries,
+ * to measure a cold start.
  */
 
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 #include "app.h"
+#include "graphics/program_cache.h"
+#include "headless/batch_runner.h"
+
+int main(int argc, char** argv) {
+    // --headless may appear anywhere; the batch runner parses the whole command line
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            return Headless::runBatch(argc, argv);
+        }
+    }
+
+    MetricsSettings metrics;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--no-shader-cache") == 0) {
+            Graphics::ProgramCache::setEnabled(false);
+        } else if (std::strcmp(argv[i], "--metrics-file") == 0 && hasValue) {
+            metrics.filePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--metrics-port") == 0 && hasValue) {
+            metrics.httpPort = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--metrics-interval") == 0 && hasValue) {
+            metrics.intervalSeconds = (float)std::atof(argv[++i]);
+        } else {
+            std::cerr << "Unknown or incomplete option: " << argv[i] << std::endl;
+        }
+    }
 
-int main() {
     // Initialize the engine with a 720p window and a descriptive title.
     // We stick to standard HD resolution as a baseline, but the window is resizable.
     App app("LumaSort Engine", 1280, 720);
-    
+    if (!metrics.filePath.empty() || metrics.httpPort > 0) {
+        app.startMetrics(metrics);
+    }
+
     // Begin the main application loop.
     // This will block until the window is closed or an exit signal is received.
     app.run();
-    
+
     return 0;
 }
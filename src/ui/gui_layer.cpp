@@ -5,6 +5,11 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <nfd.h>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 
 namespace UI {
 
@@ -32,25 +37,123 @@ namespace UI {
         ImGui::TextColored(ImVec4(0.4f, 0.8f, 1.0f, 1.0f), "Input Control");
         ImGui::Separator();
         
-        const char* items[] = { "Webcam", "Image", "Canvas" };
+        const char* items[] = { "Webcam", "Image", "Canvas", "Video" };
         int currentItem = static_cast<int>(app->m_InputMode);
-        if (ImGui::Combo("Input Mode", &currentItem, items, 3)) {
+        if (ImGui::Combo("Input Mode", &currentItem, items, 4)) {
             // Use setInputMode() to properly reset state when switching modes
             // This stops active transformations and clears particles
             app->setInputMode(static_cast<InputMode>(currentItem));
         }
 
-        if (app->m_InputMode == InputMode::IMAGE) {
+        if (app->m_InputMode == InputMode::WEBCAM) {
+            // Opening and retrying happen on the capture thread; the GUI only reports the state
+            CaptureStats capture = app->m_Webcam.getStats();
+            switch (app->m_Webcam.getState()) {
+                case WebcamState::Stopped:
+                case WebcamState::Opening:
+                    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "Webcam: Opening camera %d (attempt %d)...",
+                                       App::kWebcamDevice, std::max(1, capture.openAttempts));
+                    break;
+                case WebcamState::Retrying:
+                    ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.3f, 1.0f), "Webcam: %s, retrying every %.0f s",
+                                       capture.firstFrameMs < 0.0f ? "No camera found" : "Camera lost",
+                                       WebcamCapture::kRetrySeconds);
+                    if (ImGui::Button("Retry Now", ImVec2(-1, 0))) {
+                        app->m_Webcam.retryNow();
+                    }
+                    break;
+                case WebcamState::Streaming:
+                    ImGui::TextColored(ImVec4(0.4f, 1.0f, 0.4f, 1.0f), "Webcam: Streaming");
+                    break;
+            }
+            if (capture.openMs > 0.0f) {
+                if (capture.firstFrameMs >= 0.0f) {
+                    ImGui::Text("Opened in %.0f ms, first frame after %.0f ms", capture.openMs, capture.firstFrameMs);
+                } else {
+                    ImGui::Text("Opened in %.0f ms, waiting for the first frame", capture.openMs);
+                }
+                if (capture.reconnects > 0) {
+                    ImGui::Text("Reconnects: %d", capture.reconnects);
+                }
+            }
+
+            if (app->m_Webcam.isOpened()) {
+                // Capture runs on its own thread; show how well the main loop keeps up
+                ImGui::Text("Capture: %.1f fps, %zu queued", capture.captureFps, capture.queued);
+                ImGui::Text("Frames: %llu captured, %llu consumed",
+                            (unsigned long long)capture.captured, (unsigned long long)capture.consumed);
+                ImGui::Text("Dropped: %llu | Stale: %llu",
+                            (unsigned long long)capture.dropped, (unsigned long long)capture.stale);
+                ImGui::Text("Latency: %.1f ms (avg %.1f ms)", capture.latencyMs, capture.avgLatencyMs);
+            }
+        } else if (app->m_InputMode == InputMode::IMAGE) {
             ImGui::Spacing();
             if (ImGui::Button("Load Source Image", ImVec2(-1, 0))) {
                 nfdchar_t *outPath = nullptr;
-                nfdfilteritem_t filters[1] = { { "Image Files", "jpg,png,bmp,jpeg" } };
+                nfdfilteritem_t filters[1] = { { "Image Files", "jpg,png,bmp,jpeg,ppm,pgm,tif,tiff" } };
                 nfdresult_t result = NFD_OpenDialog(&outPath, filters, 1, nullptr);
                 if (result == NFD_OKAY) {
                     app->loadSourceImage(std::string(outPath));
                     NFD_FreePath(outPath);
                 }
             }
+            imageLoadStatus(app->m_ImageLoader, ImageSlot::SOURCE);
+        } else if (app->m_InputMode == InputMode::VIDEO) {
+            ImGui::Spacing();
+            if (ImGui::Button("Load Video", ImVec2(-1, 0))) {
+                nfdchar_t *outPath = nullptr;
+                nfdfilteritem_t filters[1] = { { "Video Files", "mp4,avi,mov,mkv,webm,y4m" } };
+                nfdresult_t result = NFD_OpenDialog(&outPath, filters, 1, nullptr);
+                if (result == NFD_OKAY) {
+                    app->loadVideo(std::string(outPath));
+                    m_SeekFrame = 0;
+                    m_Seeking = false;
+                    NFD_FreePath(outPath);
+                }
+            }
+
+            VideoSource& video = app->m_Video;
+            if (video.isOpened()) {
+                if (ImGui::Button(video.isPlaying() ? "Pause" : "Play")) {
+                    video.setPlaying(!video.isPlaying());
+                }
+                ImGui::SameLine();
+                bool looping = video.isLooping();
+                if (ImGui::Checkbox("Loop", &looping)) {
+                    video.setLooping(looping);
+                }
+
+                // Seek on release; each seek flushes the decode-ahead queue
+                if (!m_Seeking) {
+                    m_SeekFrame = std::max(0, video.getCurrentFrame());
+                }
+                int lastFrame = std::max(0, video.getFrameCount() - 1);
+                ImGui::SliderInt("Frame", &m_SeekFrame, 0, lastFrame);
+                m_Seeking = ImGui::IsItemActive();
+                if (ImGui::IsItemDeactivatedAfterEdit()) {
+                    video.seek(m_SeekFrame);
+                }
+
+                if (video.isYuvSource()) {
+                    // Compare against the regular decode path (full-size BGR conversion)
+                    bool yuvNative = video.isYuvNative();
+                    if (ImGui::Checkbox("YUV-Native Path", &yuvNative)) {
+                        video.setYuvNative(yuvNative);
+                    }
+                }
+
+                VideoStats videoStats = video.getStats();
+                ImGui::Text("Source: %dx%d @ %.2f fps", video.getWidth(), video.getHeight(), video.getFps());
+                ImGui::Text("Decode: %.1f fps (%.2f ms/frame, %s)", videoStats.decodeFps, videoStats.decodeMs,
+                            video.isYuvNative() ? "YUV planes" : "BGR");
+                ImGui::Text("Queue: %zu / %zu frames", videoStats.queued, videoStats.capacity);
+                ImGui::Text("Presented: %llu | Late: %llu | Underruns: %llu",
+                            (unsigned long long)videoStats.presented,
+                            (unsigned long long)videoStats.lateSkipped,
+                            (unsigned long long)videoStats.underruns);
+            } else {
+                ImGui::TextDisabled("No video loaded");
+            }
         } else if (app->m_InputMode == InputMode::CANVAS) {
             ImGui::Spacing();
             
@@ -64,9 +167,22 @@ namespace UI {
             if (ImGui::RadioButton("Eraser", app->m_DrawTool == App::DrawTool::ERASER)) {
                 app->m_DrawTool = App::DrawTool::ERASER;
             }
+            ImGui::SameLine();
+            if (ImGui::RadioButton("Fill", app->m_DrawTool == App::DrawTool::FILL)) {
+                app->m_DrawTool = App::DrawTool::FILL;
+            }
             
-            // Brush Size
-            ImGui::SliderFloat("Brush Size", &app->m_BrushSize, 1.0f, 20.0f);
+            if (app->m_DrawTool == App::DrawTool::FILL) {
+                // Fill Tolerance
+                ImGui::SliderInt("Fill Tolerance", &app->m_FillTolerance, 0, 255);
+                const FillStats& fillStats = app->m_Canvas->getLastFillStats();
+                ImGui::Text("Last Fill: %d px in %.2f ms (uploaded %d px%s)",
+                            fillStats.pixels, fillStats.milliseconds, fillStats.uploadedPixels,
+                            fillStats.reread ? ", blocking canvas re-read" : fillStats.fromShadow ? ", copied shadow" : "");
+            } else {
+                // Brush Size
+                ImGui::SliderFloat("Brush Size", &app->m_BrushSize, 1.0f, 20.0f);
+            }
             
             // VIBGYOR Color Palette
             ImGui::Text("Colors (VIBGYOR):");
@@ -98,6 +214,74 @@ namespace UI {
             if (ImGui::Button("Clear Canvas", ImVec2(-1, 0))) {
                 app->clearCanvas();
             }
+
+            // Undo / Redo (Ctrl+Z, Ctrl+Y or Ctrl+Shift+Z)
+            StrokeHistory& history = *app->m_History;
+            ImGui::BeginDisabled(!history.canUndo());
+            if (ImGui::Button("Undo")) {
+                app->undoCanvas();
+            }
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            ImGui::BeginDisabled(!history.canRedo());
+            if (ImGui::Button("Redo")) {
+                app->redoCanvas();
+            }
+            ImGui::EndDisabled();
+
+            ImGuiIO& io = ImGui::GetIO();
+            if (io.KeyCtrl && !io.WantTextInput) {
+                if (ImGui::IsKeyPressed(ImGuiKey_Z) && !io.KeyShift) {
+                    app->undoCanvas();
+                } else if (ImGui::IsKeyPressed(ImGuiKey_Y) || (ImGui::IsKeyPressed(ImGuiKey_Z) && io.KeyShift)) {
+                    app->redoCanvas();
+                }
+            }
+
+            ImGui::Text("History: %zu/%zu commands, %zu keyframe(s) (%zu pending)",
+                        history.getCursor(), history.getCommandCount(), history.getKeyframeCount(),
+                        history.getPendingKeyframeCount());
+            ImGui::Text("History Memory: %.2f / %.0f MB (keyframes %.2f MB)",
+                        history.getMemoryUsage() / (1024.0f * 1024.0f),
+                        history.getBudget() / (1024.0f * 1024.0f),
+                        history.getKeyframeBytes() / (1024.0f * 1024.0f));
+            int budgetMB = (int)(history.getBudget() / (1024 * 1024));
+            if (ImGui::SliderInt("History Budget (MB)", &budgetMB, 4, 512)) {
+                history.setBudget((size_t)budgetMB * 1024 * 1024);
+            }
+            ImGui::Text("Last Undo: %.2f ms (replayed %d command(s))",
+                        history.getLastUndoMs(), history.getLastReplayCount());
+
+            // Drawing resolution is independent of the simulation grid
+            const char* resolutions[] = { "Window", "1280x720", "1920x1080", "3840x2160" };
+            const int resolutionSizes[][2] = { { 0, 0 }, { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+            int currentResolution = 0;
+            for (int i = 1; i < 4; ++i) {
+                if (app->m_Canvas->getWidth() == resolutionSizes[i][0] && app->m_Canvas->getHeight() == resolutionSizes[i][1]) {
+                    currentResolution = i;
+                }
+            }
+            if (ImGui::Combo("Canvas Resolution", &currentResolution, resolutions, 4)) {
+                if (currentResolution == 0) {
+                    app->setCanvasResolution(app->m_Width, app->m_Height);
+                } else {
+                    app->setCanvasResolution(resolutionSizes[currentResolution][0], resolutionSizes[currentResolution][1]);
+                }
+            }
+
+            ImGui::SliderInt("Simulation Cap", &app->m_CanvasMaxSimRes, 0, 2048, app->m_CanvasMaxSimRes == 0 ? "Canvas" : "%d px");
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                app->setCanvasSimulationCap(app->m_CanvasMaxSimRes);
+            }
+            ImGui::Text("Readback: %dx%d", app->m_Canvas->getReadbackWidth(), app->m_Canvas->getReadbackHeight());
+
+            // Stroke batching: one draw call per segment instead of 8 per dab
+            const StrokeStats& strokeStats = app->m_Canvas->getLastStrokeStats();
+            ImGui::Text("Last Stroke: %d dabs, %d verts, %d draw call(s) (unbatched: %d)",
+                        strokeStats.dabs, strokeStats.vertices, strokeStats.drawCalls, strokeStats.dabs * 8);
+            ImGui::Text("Last Readback: %.1f KB (full canvas: %.1f KB)",
+                        app->m_Canvas->getLastReadbackBytes() / 1024.0f,
+                        app->m_Canvas->getWidth() * app->m_Canvas->getHeight() * 3 / 1024.0f);
         }
 
         ImGui::Spacing();
@@ -106,13 +290,14 @@ namespace UI {
         
         if (ImGui::Button("Load Target Image", ImVec2(-1, 0))) {
             nfdchar_t *outPath = nullptr;
-            nfdfilteritem_t filters[1] = { { "Image Files", "jpg,png,bmp,jpeg" } };
+            nfdfilteritem_t filters[1] = { { "Image Files", "jpg,png,bmp,jpeg,ppm,pgm,tif,tiff" } };
             nfdresult_t result = NFD_OpenDialog(&outPath, filters, 1, nullptr);
             if (result == NFD_OKAY) {
                 app->loadTargetImage(std::string(outPath));
                 NFD_FreePath(outPath);
             }
         }
+        imageLoadStatus(app->m_ImageLoader, ImageSlot::TARGET);
 
         // Preview Target
         if (app->m_TargetPreview && app->m_TargetPreview->getID() != 0) {
@@ -134,7 +319,204 @@ namespace UI {
             }
         } else {
             if (ImGui::Button("Stop Transform", ImVec2(-1, 40))) {
-                app->stopTransform();
+                if (app->isPlaylistActive()) {
+                    app->stopPlaylist();
+                } else {
+                    app->stopTransform();
+                }
+            }
+        }
+
+        // Playlist: chained transforms, the next one decoded and sorted in the background
+        ImGui::Spacing();
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Playlist");
+        ImGui::Separator();
+        {
+            std::vector<PlaylistEntry>& playlist = app->m_Playlist;
+            bool active = app->isPlaylistActive();
+            int removeIndex = -1;
+            for (int i = 0; i < (int)playlist.size(); ++i) {
+                PlaylistEntry& entry = playlist[i];
+                ImGui::PushID(i);
+                bool current = active && (size_t)i == app->m_PlaylistEntry;
+                // File names point into the paths: no per-frame string copies
+                const char* name = entry.target.c_str() + (entry.target.find_last_of("/\\") + 1);
+                const char* source = entry.source.empty() ? "chained" : entry.source.c_str() + (entry.source.find_last_of("/\\") + 1);
+                ImGui::TextColored(current ? ImVec4(0.4f, 1.0f, 0.4f, 1.0f) : ImVec4(1.0f, 1.0f, 1.0f, 1.0f),
+                                   "%d. %s  (from: %s)", i + 1, name, source);
+                ImGui::BeginDisabled(active);
+                ImGui::SetNextItemWidth(120.0f);
+                ImGui::DragFloat("Dwell", &entry.dwellSeconds, 0.1f, 1.0f, 120.0f, "%.1f s");
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Source...")) {
+                    nfdchar_t *outPath = nullptr;
+                    nfdfilteritem_t filters[1] = { { "Image Files", "jpg,png,bmp,jpeg,ppm,pgm,tif,tiff" } };
+                    if (NFD_OpenDialog(&outPath, filters, 1, nullptr) == NFD_OKAY) {
+                        entry.source = outPath;
+                        NFD_FreePath(outPath);
+                    }
+                }
+                if (!entry.source.empty()) {
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("Chain")) entry.source.clear();
+                }
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Remove")) removeIndex = i;
+                ImGui::EndDisabled();
+                ImGui::PopID();
+            }
+            if (removeIndex >= 0) {
+                playlist.erase(playlist.begin() + removeIndex);
+            }
+
+            ImGui::BeginDisabled(active);
+            if (ImGui::Button("Add Target...")) {
+                const nfdpathset_t *paths = nullptr;
+                nfdfilteritem_t filters[1] = { { "Image Files", "jpg,png,bmp,jpeg,ppm,pgm,tif,tiff" } };
+                if (NFD_OpenDialogMultiple(&paths, filters, 1, nullptr) == NFD_OKAY) {
+                    nfdpathsetsize_t count = 0;
+                    NFD_PathSet_GetCount(paths, &count);
+                    for (nfdpathsetsize_t i = 0; i < count; ++i) {
+                        nfdchar_t *outPath = nullptr;
+                        if (NFD_PathSet_GetPath(paths, i, &outPath) == NFD_OKAY) {
+                            PlaylistEntry entry;
+                            entry.target = outPath;
+                            playlist.push_back(entry);
+                            NFD_PathSet_FreePath(outPath);
+                        }
+                    }
+                    NFD_PathSet_Free(paths);
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Load...")) {
+                nfdchar_t *outPath = nullptr;
+                nfdfilteritem_t filters[1] = { { "Playlist", "txt" } };
+                if (NFD_OpenDialog(&outPath, filters, 1, nullptr) == NFD_OKAY) {
+                    loadPlaylist(outPath, playlist);
+                    NFD_FreePath(outPath);
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save...") && !playlist.empty()) {
+                nfdchar_t *outPath = nullptr;
+                nfdfilteritem_t filters[1] = { { "Playlist", "txt" } };
+                if (NFD_SaveDialog(&outPath, filters, 1, nullptr, "playlist.txt") == NFD_OKAY) {
+                    savePlaylist(outPath, playlist);
+                    NFD_FreePath(outPath);
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear")) playlist.clear();
+            ImGui::Checkbox("Loop", &app->m_PlaylistLoop);
+            ImGui::EndDisabled();
+
+            if (!active) {
+                ImGui::BeginDisabled(playlist.empty());
+                if (ImGui::Button("Play Playlist", ImVec2(-1, 0))) {
+                    app->startPlaylist();
+                }
+                ImGui::EndDisabled();
+            } else {
+                if (ImGui::Button("Stop Playlist", ImVec2(-1, 0))) {
+                    app->stopPlaylist();
+                }
+            }
+
+            const PlaylistStats& stats = app->m_PlaylistStats;
+            if (active && !app->m_PlaylistStarted) {
+                const char spinner[] = "|/-\\";
+                ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "Preparing first transition... %c",
+                                   spinner[(int)(ImGui::GetTime() * 8.0) & 3]);
+            } else if (active) {
+                float remaining = std::chrono::duration<float>(app->m_PlaylistDueAt - std::chrono::steady_clock::now()).count();
+                if (stats.waiting) {
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Next transition due, still preparing...");
+                } else if (app->m_Prefetcher.isReady()) {
+                    ImGui::TextColored(ImVec4(0.4f, 1.0f, 0.4f, 1.0f), "Next transition prefetched (in %.1f s)", std::max(0.0f, remaining));
+                } else {
+                    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "Prefetching next transition (in %.1f s)", std::max(0.0f, remaining));
+                }
+            }
+            if (stats.transitions > 0) {
+                if (stats.onTime + stats.late > 0) {
+                    if (stats.lastLeadMs >= 0.0f) {
+                        ImGui::TextColored(ImVec4(0.4f, 1.0f, 0.4f, 1.0f), "Last prefetch: ready %.0f ms early", stats.lastLeadMs);
+                    } else {
+                        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Last prefetch: late by %.0f ms", -stats.lastLeadMs);
+                    }
+                    ImGui::Text("On time: %zu, late: %zu", stats.onTime, stats.late);
+                }
+                ImGui::Text("Worker: decode %.1f ms, sort %.1f ms", stats.lastDecodeMs, stats.lastSortMs);
+                ImGui::Text("Switch on main thread: %.2f ms", stats.lastApplyMs);
+            }
+        }
+
+        // Offscreen export of the transform
+        ImGui::Spacing();
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Export");
+        ImGui::Separator();
+
+        Graphics::ExportSettings& exportSettings = app->m_ExportSettings;
+        Graphics::FrameExporter& exporter = *app->m_Exporter;
+        if (!app->isExporting()) {
+            const char* exportResolutions[] = { "1280x720", "1920x1080", "3840x2160" };
+            const int exportSizes[][2] = { { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+            int exportResolution = 1;
+            for (int i = 0; i < 3; ++i) {
+                if (exportSettings.width == exportSizes[i][0] && exportSettings.height == exportSizes[i][1]) {
+                    exportResolution = i;
+                }
+            }
+            if (ImGui::Combo("Export Resolution", &exportResolution, exportResolutions, 3)) {
+                exportSettings.width = exportSizes[exportResolution][0];
+                exportSettings.height = exportSizes[exportResolution][1];
+            }
+            ImGui::SliderInt("Frames", &exportSettings.frameCount, 30, 3000);
+            float exportFps = (float)exportSettings.fps;
+            if (ImGui::SliderFloat("Export FPS", &exportFps, 12.0f, 60.0f, "%.0f")) {
+                exportSettings.fps = exportFps;
+            }
+            if (ImGui::RadioButton("Video File", exportSettings.format == EncoderFormat::VIDEO)) {
+                exportSettings.format = EncoderFormat::VIDEO;
+            }
+            ImGui::SameLine();
+            if (ImGui::RadioButton("PNG Sequence", exportSettings.format == EncoderFormat::PNG_SEQUENCE)) {
+                exportSettings.format = EncoderFormat::PNG_SEQUENCE;
+            }
+
+            if (ImGui::Button("Export Transform...", ImVec2(-1, 0))) {
+                nfdchar_t *outPath = nullptr;
+                nfdresult_t result;
+                if (exportSettings.format == EncoderFormat::VIDEO) {
+                    nfdfilteritem_t filters[2] = { { "MP4 Video", "mp4" }, { "AVI Video (MJPG)", "avi" } };
+                    result = NFD_SaveDialog(&outPath, filters, 2, nullptr, "lumasort.mp4");
+                } else {
+                    result = NFD_PickFolder(&outPath, nullptr);
+                }
+                if (result == NFD_OKAY) {
+                    app->startExport(std::string(outPath));
+                    NFD_FreePath(outPath);
+                }
+            }
+            if (!exporter.getError().empty()) {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Export failed: %s", exporter.getError().c_str());
+            } else if (exporter.getLastExportSeconds() > 0.0f) {
+                ImGui::Text("Last Export: %.1f s", exporter.getLastExportSeconds());
+            }
+        } else {
+            const Graphics::ExportSettings& active = exporter.getSettings();
+            char overlay[64];
+            snprintf(overlay, sizeof(overlay), "%llu / %d frames",
+                     (unsigned long long)exporter.getFramesWritten(), active.frameCount);
+            ImGui::ProgressBar(exporter.getProgress(), ImVec2(-1, 0), overlay);
+            ImGui::Text("Export: %.1f fps (%.1fx real time)", exporter.getExportFps(),
+                        exporter.getExportFps() / (float)active.fps);
+            ImGui::Text("Rendered: %d | Encoder Queue: %zu / %zu | Encode: %.1f ms/frame",
+                        exporter.getFramesRendered(), exporter.getEncoderQueued(),
+                        exporter.getEncoderCapacity(), exporter.getEncodeMs());
+            if (ImGui::Button("Cancel Export", ImVec2(-1, 0))) {
+                app->cancelExport();
             }
         }
 
@@ -146,11 +528,311 @@ namespace UI {
         ImGui::SliderFloat("Flow Strength", &app->m_FlowStrength, 0.0f, 0.001f, "%.5f");
         ImGui::SliderFloat("Noise Scale", &app->m_NoiseScale, 1.0f, 20.0f);
         
+        ImGui::Spacing();
+        ImGui::TextColored(ImVec4(0.4f, 0.8f, 1.0f, 1.0f), "Rendering");
+        ImGui::Separator();
+
+        Graphics::Renderer& renderer = *app->m_Renderer;
+        bool lodEnabled = renderer.isLodEnabled();
+        if (ImGui::Checkbox("Density LOD", &lodEnabled)) {
+            renderer.setLodEnabled(lodEnabled);
+        }
+        float lodThreshold = renderer.getLodThreshold();
+        if (ImGui::SliderFloat("LOD Threshold", &lodThreshold, 1.0f, 8.0f, "%.2f particles/px")) {
+            renderer.setLodThreshold(lodThreshold);
+        }
+        ImGui::Text("Render Path: %s (%.2f particles/px)",
+                    renderer.isLodActive() ? "Density Splat" : "Point Sprites",
+                    renderer.getParticlesPerPixel());
+
+        ImGui::Checkbox("Software Rasterizer (CPU)", &app->m_UseSoftwareRasterizer);
+        if (app->m_SoftwareRasterizer) {
+            const Graphics::SoftwareRasterStats& raster = app->m_SoftwareRasterizer->getStats();
+            ImGui::Text("CPU Raster: %.2f ms (bin %.2f, fill %.2f) on %d threads",
+                        raster.totalMs, raster.binMs, raster.fillMs, app->m_SoftwareRasterizer->getThreadCount());
+            ImGui::Text("Tiles: %d, Binned Splats: %zu", raster.tileCount, raster.binnedSplats);
+        }
+        if (ImGui::Button("Compare GL vs CPU")) {
+            app->m_CompareRequested = true;
+        }
+        if (app->m_RasterComparison.valid) {
+            ImGui::SameLine();
+            ImGui::Text("mean err %.3f, %.2f%% px off%s",
+                        app->m_RasterComparison.meanError, app->m_RasterComparison.mismatchPercent,
+                        app->m_RasterComparison.lodActive ? " (GL used LOD)" : "");
+        }
+
+        // Dynamic resolution: grid scale chosen from the measured frame cost
+        ImGui::Spacing();
+        ImGui::TextColored(ImVec4(0.4f, 0.8f, 1.0f, 1.0f), "Dynamic Resolution");
+        ImGui::Separator();
+        {
+            ResolutionSettings settings = app->m_ResolutionController.getSettings();
+            bool changed = ImGui::Checkbox("Fit Frame Budget", &settings.enabled);
+            ImGui::BeginDisabled(!settings.enabled);
+            changed |= ImGui::SliderFloat("Budget", &settings.budgetMs, 4.0f, 50.0f, "%.1f ms");
+            changed |= ImGui::SliderFloat("Min Scale", &settings.minScale, 0.25f, 1.0f, "%.2fx");
+            float scaleFloor = app->m_ResolutionController.getScaleFloor();
+            if (scaleFloor > settings.minScale) {
+                ImGui::TextDisabled("Raised to %.2fx by this input's %dpx minimum grid", scaleFloor, App::kStreamSimulationMin);
+            }
+            changed |= ImGui::SliderFloat("Max Scale", &settings.maxScale, 1.0f, App::kMaxResolutionScale, "%.2fx");
+            ImGui::EndDisabled();
+            if (changed) {
+                app->m_ResolutionController.setSettings(settings);
+                app->applyResolutionScale();
+            }
+            ImGui::Text("Scale: %.2fx -> grid %dx%d", app->m_ResolutionScale,
+                        app->m_SimulationWidth, app->m_SimulationHeight);
+            float averageMs = app->m_ResolutionController.getAverageMs();
+            ImGui::Text("Frame cost: %.2f ms (avg %.2f ms)", app->m_FrameCostMs, averageMs);
+            if (settings.enabled && app->isPlaylistActive()) {
+                ImGui::TextDisabled("Paused while a playlist plays");
+            }
+        }
+
         ImGui::Spacing();
         ImGui::Separator();
         ImGui::Text("Particles: %zu", app->m_Particles.size());
         ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
 
+        // Source versioning: how much per-frame work was skipped
+        const UpdateStats& stats = app->m_UpdateStats;
+        ImGui::Text("Frame Copy: %s | Resample: %s",
+                    stats.frameCopied ? "yes" : "skipped",
+                    stats.frameResampled ? "yes" : "skipped");
+        ImGui::Text("Colors: %zu written, %zu skipped", stats.colorsWritten, stats.colorsSkipped);
+        ImGui::Text("Positions: %zu reset, %zu skipped", stats.positionsReset, stats.positionsSkipped);
+        ImGui::Text("Frames Reused: %llu", (unsigned long long)stats.framesReused);
+        ImGui::Text("Last Sort: %.2f ms (%s key)", app->m_LastSortMs, app->m_LastSortUsedLuma ? "luma plane" : "BGR luminance");
+
+        // Main-thread heap allocations per frame; steady state should stay at zero
+        AllocationStats& allocations = app->m_AllocationStats;
+        ImGui::Text("Allocations: %llu this frame (%llu bytes), peak %llu",
+                    (unsigned long long)allocations.lastFrame, (unsigned long long)allocations.lastFrameBytes,
+                    (unsigned long long)allocations.peak);
+        ImGui::Text("Allocating Frames: %llu / %llu", (unsigned long long)allocations.framesAllocating,
+                    (unsigned long long)allocations.frames);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##Allocations")) {
+            allocations = AllocationStats();
+        }
+
+        // Launch cost; warm means every GL program came from the binary cache
+        const StartupStats& startup = app->m_Startup;
+        if (startup.reported) {
+            ImGui::Text("Startup (%s): %.0f ms to first frame", startup.isWarm() ? "warm" : "cold", startup.firstFrameMs);
+            ImGui::Text("Window %.0f ms | Shaders %.1f ms (%d cached, %d compiled)", startup.windowMs,
+                        startup.shadersMs, startup.programsCached, startup.programsCompiled);
+        }
+
+        ImGui::End();
+
+        renderProfiler(app);
+        renderCpuProfiler();
+    }
+
+    void GuiLayer::imageLoadStatus(const ImageLoader& loader, ImageSlot slot) {
+        if (loader.isLoading(slot)) {
+            const char spinner[] = "|/-\\";
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "Loading... %c", spinner[(int)(ImGui::GetTime() * 8.0) & 3]);
+            return;
+        }
+        int index = (int)slot;
+        uint64_t generation = loader.getStatsGeneration(slot);
+        if (generation != m_LoadStatsGeneration[index]) {
+            m_LoadStats[index] = loader.getLastStats(slot);
+            m_LoadStatsGeneration[index] = generation;
+        }
+        const ImageLoadStats& stats = m_LoadStats[index];
+        if (stats.path.empty()) return;
+        if (!stats.ok) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Failed to load image");
+            return;
+        }
+        if (stats.streamed) {
+            ImGui::Text("%dx%d -> %dx%d (area-averaged)", stats.originalWidth, stats.originalHeight,
+                        stats.width, stats.height);
+            ImGui::Text("Streamed %d stripes of %d rows in %.1f ms", stats.streaming.stripes,
+                        stats.streaming.stripeRows, stats.totalMs);
+            ImGui::Text("Buffers: %.1f MB", stats.streaming.bufferBytes / (1024.0 * 1024.0));
+        } else {
+            ImGui::Text("%dx%d -> %dx%d (decoded at 1/%d)", stats.originalWidth, stats.originalHeight,
+                        stats.width, stats.height, stats.reduction);
+            ImGui::Text("Decode %.1f ms, resize %.1f ms, total %.1f ms", stats.decodeMs, stats.resizeMs, stats.totalMs);
+        }
+        ImGui::Text("Peak RSS: %.1f MB (+%.1f MB during load)", stats.peakRssBytes / (1024.0 * 1024.0),
+                    stats.peakRssGrowth / (1024.0 * 1024.0));
+    }
+
+    void GuiLayer::renderProfiler(App* app) {
+        using Graphics::GpuProfiler;
+        GpuProfiler& profiler = *app->m_Profiler;
+
+        ImGui::SetNextWindowSize(ImVec2(360, 0), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+        bool enabled = profiler.isEnabled();
+        if (ImGui::Checkbox("Enable Timing", &enabled)) {
+            profiler.setEnabled(enabled);
+        }
+        ImGui::Text("Rolling average over %d frames, GPU read back %d frames late",
+                    GpuProfiler::kHistorySize, GpuProfiler::kFrameLatency);
+        ImGui::Separator();
+
+        if (ImGui::BeginTable("Stages", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Stage");
+            ImGui::TableSetupColumn("CPU (ms)");
+            ImGui::TableSetupColumn("GPU (ms)");
+            ImGui::TableHeadersRow();
+
+            for (int i = 0; i < GpuProfiler::kStageCount; ++i) {
+                auto stage = static_cast<GpuProfiler::Stage>(i);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", GpuProfiler::getStageName(stage));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", profiler.getCpuMs(stage));
+                ImGui::TableNextColumn();
+                if (GpuProfiler::hasGpuTiming(stage)) {
+                    ImGui::Text("%.3f", profiler.getGpuMs(stage));
+                } else {
+                    ImGui::TextDisabled("-");
+                }
+            }
+            ImGui::EndTable();
+        }
+
+        // GPU history graphs
+        for (int i = 0; i < GpuProfiler::kStageCount; ++i) {
+            auto stage = static_cast<GpuProfiler::Stage>(i);
+            if (!GpuProfiler::hasGpuTiming(stage)) continue;
+            const auto& history = profiler.getGpuHistory(stage);
+            ImGui::PlotLines(GpuProfiler::getStageName(stage), history.data(), (int)history.size(),
+                             profiler.getHistoryOffset(), nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+        }
+
+        ImGui::End();
+    }
+
+    void GuiLayer::renderCpuProfiler() {
+        ImGui::SetNextWindowSize(ImVec2(560, 0), ImGuiCond_FirstUseEver);
+        ImGui::Begin("CPU Frame Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+        bool enabled = CpuProfiler::isEnabled();
+        if (ImGui::Checkbox("Record", &enabled)) {
+            CpuProfiler::setEnabled(enabled);
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("Pause", &m_CpuProfilerPaused);
+        int frameCount = (int)CpuProfiler::getFrameCount();
+        ImGui::SliderInt("Frames Ago", &m_CpuFrameOffset, 0, std::max(0, frameCount - 1));
+
+        // Snapshot the selected frame; paused keeps the last snapshot on screen
+        if (!m_CpuProfilerPaused) {
+            m_FrameEvents.clear();
+            if (CpuProfiler::getFrame((size_t)m_CpuFrameOffset, m_FrameStartNs, m_FrameEndNs)) {
+                CpuProfiler::collect(m_FrameStartNs, m_FrameEvents);
+                m_FrameEvents.erase(std::remove_if(m_FrameEvents.begin(), m_FrameEvents.end(),
+                                                   [this](const CpuProfileEvent& event) { return event.startNs >= m_FrameEndNs; }),
+                                    m_FrameEvents.end());
+            }
+        }
+
+        if (m_FrameEvents.empty()) {
+            ImGui::TextDisabled(enabled ? "No events in this frame yet" : "Recording is off");
+        } else {
+            const double frameNs = (double)std::max<int64_t>(1, m_FrameEndNs - m_FrameStartNs);
+            ImGui::Text("Frame: %.2f ms, %zu scopes", frameNs / 1.0e6, m_FrameEvents.size());
+
+            // One lane per thread, one row per nesting depth; bars are clipped to the frame
+            float width = std::max(400.0f, ImGui::GetContentRegionAvail().x);
+            float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+            CpuProfiler::getThreads(m_ProfileThreads);
+            for (const CpuProfileThread& thread : m_ProfileThreads) {
+                uint32_t rows = 0;
+                for (const CpuProfileEvent& event : m_FrameEvents) {
+                    if (event.thread == thread.id) rows = std::max(rows, event.depth + 1);
+                }
+                if (rows == 0) continue;
+
+                ImGui::TextDisabled("%s", thread.name.c_str());
+                ImVec2 origin = ImGui::GetCursorScreenPos();
+                ImVec2 laneEnd(origin.x + width, origin.y + rows * rowHeight);
+                drawList->AddRectFilled(origin, laneEnd, IM_COL32(30, 30, 30, 255));
+                drawList->PushClipRect(origin, laneEnd, true);
+                for (const CpuProfileEvent& event : m_FrameEvents) {
+                    if (event.thread != thread.id) continue;
+                    double start = (double)(std::max(event.startNs, m_FrameStartNs) - m_FrameStartNs);
+                    double end = (double)(std::min(event.endNs, m_FrameEndNs) - m_FrameStartNs);
+                    ImVec2 min(origin.x + (float)(start / frameNs) * width, origin.y + event.depth * rowHeight);
+                    ImVec2 max(std::max(min.x + 1.0f, origin.x + (float)(end / frameNs) * width), min.y + rowHeight - 1.0f);
+
+                    // Stable color per scope name
+                    uint32_t hash = 2166136261u;
+                    for (const char* c = event.name; *c; ++c) hash = (hash ^ (uint8_t)*c) * 16777619u;
+                    float r, g, b;
+                    ImGui::ColorConvertHSVtoRGB((hash % 360) / 360.0f, 0.55f, 0.75f, r, g, b);
+                    drawList->AddRectFilled(min, max, IM_COL32((int)(r * 255), (int)(g * 255), (int)(b * 255), 255));
+                    if (max.x - min.x > ImGui::CalcTextSize(event.name).x + 4.0f) {
+                        drawList->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32(0, 0, 0, 255), event.name);
+                    }
+                    if (ImGui::IsMouseHoveringRect(min, max)) {
+                        ImGui::SetTooltip("%s\n%.3f ms (depth %u)", event.name,
+                                          (event.endNs - event.startNs) / 1.0e6, event.depth);
+                    }
+                }
+                drawList->PopClipRect();
+                ImGui::Dummy(ImVec2(width, rows * rowHeight));
+            }
+
+            // Inclusive time per scope name within the frame
+            std::vector<ScopeTotal>& totals = m_ScopeTotals;
+            totals.clear();
+            for (const CpuProfileEvent& event : m_FrameEvents) {
+                auto it = std::find_if(totals.begin(), totals.end(), [&](const ScopeTotal& total) {
+                    return std::strcmp(total.name, event.name) == 0;
+                });
+                if (it == totals.end()) {
+                    totals.push_back({ event.name, 0.0, 0 });
+                    it = totals.end() - 1;
+                }
+                it->ms += (event.endNs - event.startNs) / 1.0e6;
+                ++it->calls;
+            }
+            std::sort(totals.begin(), totals.end(), [](const ScopeTotal& a, const ScopeTotal& b) { return a.ms > b.ms; });
+            if (ImGui::BeginTable("CpuScopes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("Scope");
+                ImGui::TableSetupColumn("Total (ms)");
+                ImGui::TableSetupColumn("Calls");
+                ImGui::TableHeadersRow();
+                for (size_t i = 0; i < totals.size() && i < 16; ++i) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s", totals[i].name);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", totals[i].ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%d", totals[i].calls);
+                }
+                ImGui::EndTable();
+            }
+        }
+
+        // Offline analysis in chrome://tracing or Perfetto
+        ImGui::Separator();
+        ImGui::SliderFloat("Trace Length", &m_TraceSeconds, 1.0f, 60.0f, "%.0f s");
+        if (ImGui::Button("Export Chrome Trace...", ImVec2(-1, 0))) {
+            nfdchar_t *outPath = nullptr;
+            nfdfilteritem_t filters[1] = { { "Chrome Trace", "json" } };
+            if (NFD_SaveDialog(&outPath, filters, 1, nullptr, "lumasort_trace.json") == NFD_OKAY) {
+                CpuProfiler::exportChromeTrace(outPath, m_TraceSeconds);
+                NFD_FreePath(outPath);
+            }
+        }
+        ImGui::TextDisabled("Each thread keeps its last %zu scopes", CpuProfiler::kRingSize);
+
         ImGui::End();
     }
 
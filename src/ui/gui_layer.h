@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+#include "../core/cpu_profiler.h"
+#include "../io/image_loader.h"
+
 namespace UI {
     // Forward declare App so we can pass it to render
 }
@@ -36,6 +41,50 @@ namespace UI {
          * Handles multi-viewport platform window rendering if enabled.
          */
         void end();
+
+    private:
+        /**
+         * @brief Loading indicator while a slot decodes, then the telemetry of its last load.
+         */
+        void imageLoadStatus(const ImageLoader& loader, ImageSlot slot);
+
+        /**
+         * @brief Draws the per-stage CPU/GPU timing panel.
+         */
+        void renderProfiler(App* app);
+
+        /**
+         * @brief Draws the per-frame CPU flame graph and the Chrome trace export.
+         */
+        void renderCpuProfiler();
+
+        /**
+         * @brief Inclusive time of one scope name within the displayed frame.
+         */
+        struct ScopeTotal {
+            const char* name;
+            double ms;
+            int calls;
+        };
+
+        // Last load telemetry per image slot, copied only when the loader's generation changes
+        // (the stats hold the path, so copying them every frame would allocate)
+        ImageLoadStats m_LoadStats[2];
+        uint64_t m_LoadStatsGeneration[2] = {};
+
+        // Video seek slider (reset when a new video is loaded)
+        int m_SeekFrame = 0;                        ///< Slider position while dragging
+        bool m_Seeking = false;                     ///< Slider is held; don't follow playback
+
+        // CPU profiler panel state (vectors are reused so the open panel doesn't allocate per frame)
+        bool m_CpuProfilerPaused = false;           ///< Keep showing the captured frame
+        int m_CpuFrameOffset = 0;                   ///< Frames back from the newest completed one
+        float m_TraceSeconds = 10.0f;               ///< Length of an exported trace
+        std::vector<CpuProfileEvent> m_FrameEvents; ///< Events of the displayed frame
+        std::vector<CpuProfileThread> m_ProfileThreads;
+        std::vector<ScopeTotal> m_ScopeTotals;
+        int64_t m_FrameStartNs = 0;
+        int64_t m_FrameEndNs = 0;
     };
 
 }